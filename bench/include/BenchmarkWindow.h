@@ -0,0 +1,31 @@
+#pragma once
+
+#include <Drawing/Window.h>
+
+namespace xit::Drawing
+{
+    /// <summary>
+    /// The headless window of the benchmarks. It owns the OpenGL context text measuring and rendering need,
+    /// its scene is the current one for the layout benchmarks.
+    /// </summary>
+    class BenchmarkWindow : public Window
+    {
+    private:
+        static BenchmarkWindow *instance;
+
+    protected:
+        void OnInitializeComponent() override {}
+
+    public:
+        static constexpr int Width = 1280;
+        static constexpr int Height = 720;
+
+        /// <summary>
+        /// Gets the window, nullptr if there is no OpenGL context. Benchmarks which need one skip then.
+        /// </summary>
+        __always_inline static BenchmarkWindow *Get() { return instance; }
+        __always_inline static void Set(BenchmarkWindow *value) { instance = value; }
+    };
+}
+
+using namespace xit::Drawing;
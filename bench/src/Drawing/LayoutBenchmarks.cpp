@@ -0,0 +1,164 @@
+#include <benchmark/benchmark.h>
+#include <BenchmarkWindow.h>
+#include <Drawing/Container.h>
+#include <Drawing/GridRowManager.h>
+#include <Drawing/Visual.h>
+
+#include <memory>
+#include <vector>
+
+namespace
+{
+    constexpr size_t FanOut = 10;
+    constexpr int LeafHeight = 20;
+
+    std::string JoinRows(const std::string &value, size_t count)
+    {
+        std::string rows;
+
+        for (size_t i = 0; i < count; i++)
+        {
+            if (i > 0)
+                rows += ",";
+            rows += value;
+        }
+
+        return rows;
+    }
+
+    /// <summary>
+    /// A tree of nodeCount visuals in breadth first order, every container has FanOut auto sized rows.
+    /// nodes[0] is the root, the last node is a leaf.
+    /// </summary>
+    void CreateTree(size_t nodeCount, std::vector<std::unique_ptr<Visual>> &nodes)
+    {
+        nodes.clear();
+        nodes.reserve(nodeCount);
+
+        for (size_t i = 0; i < nodeCount; i++)
+        {
+            // node i is the parent of the nodes i * FanOut + 1 to i * FanOut + FanOut
+            if (i * FanOut + 1 < nodeCount)
+            {
+                Container *container = new Container();
+                container->SetRows(JoinRows("Auto", FanOut));
+                nodes.emplace_back(container);
+            }
+            else
+            {
+                Visual *leaf = new Visual();
+                leaf->SetHeight(LeafHeight);
+                nodes.emplace_back(leaf);
+            }
+
+            if (i > 0)
+            {
+                nodes[i]->SetRow((i - 1) % FanOut);
+                static_cast<Container *>(nodes[(i - 1) / FanOut].get())->AddChild(nodes[i].get());
+            }
+        }
+    }
+}
+
+// Lays out the whole tree, the width changes every iteration so every element is measured and arranged again.
+static void BM_UpdateLayout_Full(benchmark::State &state)
+{
+    if (!BenchmarkWindow::Get())
+    {
+        state.SkipWithError("no OpenGL context");
+        return;
+    }
+
+    std::vector<std::unique_ptr<Visual>> nodes;
+    CreateTree((size_t)state.range(0), nodes);
+
+    Visual &root = *nodes[0];
+    int width = BenchmarkWindow::Width;
+    root.UpdateLayout(Rectangle(0, 0, width, BenchmarkWindow::Height));
+
+    for (auto _ : state)
+    {
+        width = width == BenchmarkWindow::Width ? BenchmarkWindow::Width - 1 : BenchmarkWindow::Width;
+        benchmark::DoNotOptimize(root.UpdateLayout(Rectangle(0, 0, width, BenchmarkWindow::Height)));
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_UpdateLayout_Full)->Arg(1000)->Arg(10000)->Arg(100000)->Unit(benchmark::kMicrosecond);
+
+// Invalidates a single leaf, the layout pass should only visit the path from the leaf to the root.
+static void BM_UpdateLayout_SingleLeaf(benchmark::State &state)
+{
+    if (!BenchmarkWindow::Get())
+    {
+        state.SkipWithError("no OpenGL context");
+        return;
+    }
+
+    std::vector<std::unique_ptr<Visual>> nodes;
+    CreateTree((size_t)state.range(0), nodes);
+
+    Visual &root = *nodes[0];
+    Visual &leaf = *nodes.back();
+    Rectangle bounds(0, 0, BenchmarkWindow::Width, BenchmarkWindow::Height);
+    root.UpdateLayout(bounds);
+
+    size_t passes = 0;
+
+    for (auto _ : state)
+    {
+        LayoutManager::ResetLayoutPassCount();
+        leaf.InvalidateMeasure();
+        benchmark::DoNotOptimize(root.UpdateLayout(bounds));
+        passes += LayoutManager::GetLayoutPassCount();
+    }
+
+    state.counters["Elements"] = benchmark::Counter((double)passes, benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_UpdateLayout_SingleLeaf)->Arg(1000)->Arg(10000)->Arg(100000)->Unit(benchmark::kMicrosecond);
+
+// Sizes N rows of the given kind with one child each, the available height changes every iteration.
+static void GridRows(benchmark::State &state, const std::string &row)
+{
+    if (!BenchmarkWindow::Get())
+    {
+        state.SkipWithError("no OpenGL context");
+        return;
+    }
+
+    size_t count = (size_t)state.range(0);
+
+    std::vector<std::unique_ptr<Visual>> visuals;
+    std::vector<Visual *> children;
+    visuals.reserve(count);
+    children.reserve(count);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        visuals.push_back(std::make_unique<Visual>());
+        visuals.back()->SetHeight(LeafHeight);
+        visuals.back()->SetRow(i);
+        children.push_back(visuals.back().get());
+    }
+
+    GridRowManager rows;
+    rows.SetChildren(&children);
+    rows.SetRows(JoinRows(row, count));
+
+    int height = (int)count * LeafHeight;
+
+    for (auto _ : state)
+    {
+        height = height == (int)count * LeafHeight ? (int)count * LeafHeight + 1 : (int)count * LeafHeight;
+        rows.SetBounds(Rectangle(0, 0, BenchmarkWindow::Width, height));
+        benchmark::DoNotOptimize(rows.GetHeight(height));
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_GridRows_Auto(benchmark::State &state) { GridRows(state, "Auto"); }
+BENCHMARK(BM_GridRows_Auto)->Arg(100)->Arg(1000)->Arg(10000)->Unit(benchmark::kMicrosecond);
+
+static void BM_GridRows_Star(benchmark::State &state) { GridRows(state, "*"); }
+BENCHMARK(BM_GridRows_Star)->Arg(100)->Arg(1000)->Arg(10000)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,34 @@
+#include <benchmark/benchmark.h>
+#include <BenchmarkWindow.h>
+#include <Drawing/ListView.h>
+
+#include <list>
+#include <string>
+
+// Fills a list view with all items, virtualizing list views only create the containers of the viewport.
+static void BM_ListView_UpdateList(benchmark::State &state)
+{
+    if (!BenchmarkWindow::Get())
+    {
+        state.SkipWithError("no OpenGL context");
+        return;
+    }
+
+    std::list<std::string> items;
+    for (int64_t i = 0; i < state.range(0); i++)
+        items.push_back("Item " + std::to_string(i));
+
+    ListView listView;
+    listView.SetIsVirtualizing(state.range(1) != 0);
+    listView.SetItems(&items);
+    listView.UpdateLayout(Rectangle(0, 0, BenchmarkWindow::Width, BenchmarkWindow::Height));
+
+    for (auto _ : state)
+    {
+        listView.UpdateList();
+        listView.UpdateLayout(Rectangle(0, 0, BenchmarkWindow::Width, BenchmarkWindow::Height));
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ListView_UpdateList)->ArgNames({"items", "virtualizing"})->Args({10000, 0})->Args({10000, 1})->Unit(benchmark::kMillisecond);
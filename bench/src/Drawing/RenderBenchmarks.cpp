@@ -0,0 +1,72 @@
+#include <benchmark/benchmark.h>
+#include <BenchmarkWindow.h>
+#include <Drawing/Brushes/SolidColorBrush.h>
+#include <Drawing/Container.h>
+#include <Drawing/Visual.h>
+#include <OpenGL/Profiler.h>
+
+#include <memory>
+#include <vector>
+
+// Renders full frames of a window with N filled visuals in a single column.
+// The synthetic clock of the headless window starts a new frame every iteration.
+static void BM_Window_RenderFrame(benchmark::State &state)
+{
+    BenchmarkWindow *window = BenchmarkWindow::Get();
+    if (!window)
+    {
+        state.SkipWithError("no OpenGL context");
+        return;
+    }
+
+    size_t count = (size_t)state.range(0);
+
+    SolidColorBrush brush(glm::vec4(0.2f, 0.4f, 0.8f, 1.0f));
+    Container content;
+    std::vector<std::unique_ptr<Visual>> visuals;
+    visuals.reserve(count);
+
+    std::string rows;
+    for (size_t i = 0; i < count; i++)
+    {
+        if (i > 0)
+            rows += ",";
+        rows += "*";
+
+        visuals.push_back(std::make_unique<Visual>());
+        visuals.back()->SetBackground(&brush);
+        visuals.back()->SetRow(i);
+        content.AddChild(visuals.back().get());
+    }
+    content.SetRows(rows);
+
+    window->SetContent(&content);
+
+    FrameClock::Clock::time_point time;
+    window->RenderFrame(time);
+
+    size_t frames = 0;
+    size_t drawCalls = 0;
+    size_t stateChanges = 0;
+
+    for (auto _ : state)
+    {
+        content.Invalidate();
+        time += window->GetFrameClock().GetInterval();
+
+        if (window->RenderFrame(time))
+        {
+            ProfileFrame frame = Profiler::GetLastFrame();
+            drawCalls += frame.Get(ProfileCounter::DrawCalls);
+            stateChanges += frame.Get(ProfileCounter::StateChanges);
+            frames++;
+        }
+    }
+
+    window->SetContent(nullptr);
+
+    state.counters["Frames"] = benchmark::Counter((double)frames, benchmark::Counter::kAvgIterations);
+    state.counters["DrawCalls"] = benchmark::Counter((double)drawCalls, benchmark::Counter::kAvgIterations);
+    state.counters["StateChanges"] = benchmark::Counter((double)stateChanges, benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_Window_RenderFrame)->Arg(10)->Arg(100)->Arg(1000)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,90 @@
+#include <benchmark/benchmark.h>
+#include <BenchmarkWindow.h>
+#include <Drawing/TextBox.h>
+#include <Drawing/UIDefaults.h>
+#include <OpenGL/Text/FontStorage.h>
+
+#include <string>
+
+namespace
+{
+    std::string CreateText(size_t length)
+    {
+        static const std::string Words = "The quick brown fox jumps over the lazy dog. ";
+
+        std::string text;
+        text.reserve(length);
+
+        while (text.size() < length)
+            text += Words[text.size() % Words.size()];
+
+        return text;
+    }
+
+    /// <summary>
+    /// Makes the mouse handling of the TextBox callable, a press places the caret at the hit character.
+    /// </summary>
+    class HitTestTextBox : public TextBox
+    {
+    public:
+        void Press(int x)
+        {
+            MouseEventArgs e(Point(x, 0));
+            OnInputPressed(e);
+            OnInputReleased(e);
+        }
+    };
+}
+
+static void BM_CharacterList_Measure(benchmark::State &state)
+{
+    if (!BenchmarkWindow::Get())
+    {
+        state.SkipWithError("no OpenGL context");
+        return;
+    }
+
+    CharacterList &font = FontStorage::FindOrCreate(UIDefaults::DefaultFont, UIDefaults::DefaultFontSize);
+    std::string text = CreateText((size_t)state.range(0));
+
+    // loads the glyphs, only measuring is timed
+    Size size;
+    font.Measure(text, size);
+
+    for (auto _ : state)
+    {
+        font.Measure(text, size);
+        benchmark::DoNotOptimize(size);
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_CharacterList_Measure)->Arg(16)->Arg(256)->Arg(4096);
+
+// Places the caret by a mouse press in the middle of a single line text.
+static void BM_TextBox_HitTest(benchmark::State &state)
+{
+    if (!BenchmarkWindow::Get())
+    {
+        state.SkipWithError("no OpenGL context");
+        return;
+    }
+
+    std::string text = CreateText((size_t)state.range(0));
+
+    Size size;
+    FontStorage::FindOrCreate(UIDefaults::DefaultFont, UIDefaults::DefaultFontSize).Measure(text, size);
+
+    HitTestTextBox textBox;
+    textBox.SetText(text);
+    textBox.UpdateLayout(Rectangle(0, 0, size.GetWidth() + BenchmarkWindow::Width, BenchmarkWindow::Height));
+
+    int x = size.GetWidth() / 2;
+
+    for (auto _ : state)
+    {
+        textBox.Press(x);
+        benchmark::DoNotOptimize(textBox.GetCaretIndex());
+    }
+}
+BENCHMARK(BM_TextBox_HitTest)->RangeMultiplier(4)->Range(64, 4096)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,28 @@
+#include <benchmark/benchmark.h>
+#include <BenchmarkWindow.h>
+
+#include <cstdio>
+
+BenchmarkWindow *BenchmarkWindow::instance = nullptr;
+
+int main(int argc, char **argv)
+{
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv))
+        return 1;
+
+    // the build hosts have no display, everything renders offscreen
+    Window::SetIsHeadless(true);
+
+    BenchmarkWindow window;
+    if (window.Initialize(WindowSettings("Benchmark", BenchmarkWindow::Width, BenchmarkWindow::Height, WindowState::Normal), "Benchmark"))
+        BenchmarkWindow::Set(&window);
+    else
+        fprintf(stderr, "No OpenGL context, the benchmarks which need one are skipped\n");
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+
+    BenchmarkWindow::Set(nullptr);
+    return 0;
+}
@@ -0,0 +1,80 @@
+/**
+ * @file DirtyRegionSet.h
+ * @brief Defines the DirtyRegionSet class for coalescing invalidated regions of a window.
+ */
+
+#pragma once
+
+#include <vector>
+#include <Drawing/Rectangle.h>
+
+namespace xit::Drawing
+{
+    /**
+     * @class DirtyRegionSet
+     * @brief Collects invalidated rectangles into a bounded number of regions.
+     *
+     * The area is split into a grid of buckets. Every added rectangle is merged
+     * into the bucket containing its center, so adding is O(1) and the set never
+     * holds more than MaxRegions rectangles, no matter how many visuals invalidate.
+     * GetRegions merges overlapping buckets before they are rendered.
+     */
+    class DirtyRegionSet
+    {
+    public:
+        static constexpr int Columns = 4;                    ///< Number of bucket columns.
+        static constexpr int Rows = 4;                       ///< Number of bucket rows.
+        static constexpr int MaxRegions = Columns * Rows;    ///< Upper limit of regions returned by GetRegions.
+
+    private:
+        Rectangle area;                   ///< The area covered by the buckets, added rectangles are clipped to it.
+        Rectangle buckets[MaxRegions];    ///< Union of all rectangles added to each bucket.
+        bool isUsed[MaxRegions];          ///< True if the bucket holds a rectangle.
+        int usedCount;                    ///< Number of used buckets.
+        std::vector<Rectangle> regions;   ///< The merged regions returned by GetRegions.
+
+        static void Merge(Rectangle &target, const Rectangle &source);
+        static bool Overlaps(const Rectangle &a, const Rectangle &b);
+
+    public:
+        DirtyRegionSet();
+
+        /**
+         * @brief Sets the area the buckets are laid over. Clears the set.
+         * @param value The area, usually the scene rectangle of the window.
+         */
+        void SetArea(const Rectangle &value);
+
+        /**
+         * @brief Gets the area the buckets are laid over.
+         */
+        __always_inline const Rectangle &GetArea() const { return area; }
+
+        /**
+         * @brief Returns true if no region has been added since the last Clear.
+         */
+        __always_inline bool IsEmpty() const { return usedCount == 0; }
+
+        /**
+         * @brief Adds a rectangle. Rectangles outside of the area are ignored.
+         * @param region The invalidated rectangle in window coordinates.
+         */
+        void Add(const Rectangle &region);
+
+        /**
+         * @brief Removes all regions.
+         */
+        void Clear();
+
+        /**
+         * @brief Merges overlapping buckets and returns the resulting regions.
+         * @return At most MaxRegions non-overlapping rectangles, valid until the next call.
+         */
+        const std::vector<Rectangle> &GetRegions();
+
+        /**
+         * @brief Gets the number of pixels covered by the regions returned by GetRegions.
+         */
+        int GetCoveredArea() const;
+    };
+}
@@ -0,0 +1,145 @@
+/**
+ * @file FrameClock.h
+ * @brief Defines the FrameClock class pacing the frames of a window to the display refresh.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+
+namespace xit::Drawing
+{
+    /**
+     * @brief When a window renders frames.
+     */
+    enum class FramePolicy
+    {
+        OnDemand,  ///< Only when something was invalidated, an idle window does not wake up.
+        Continuous ///< Every display refresh, e.g. while an animation runs.
+    };
+
+    /**
+     * @class FrameClock
+     * @brief Paces the frames of a window to the refresh of its display.
+     *
+     * Frames start on the refresh ticks of the display. With vsync the swap of a presented frame
+     * returns at a vertical blank, which moves the ticks to it. A frame whose work before the swap takes
+     * longer than one refresh interval is late and the next frame waits for the tick after it ended.
+     * The wait of the swap for the blank is not work, back to back vsynced frames take an interval each.
+     * The update and layout phases of a frame share a budget of the interval, the rest is left for rendering.
+     * All times are passed in, so the clock does not depend on a running window.
+     */
+    class FrameClock
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        static constexpr int DefaultRefreshRate = 60;
+        static constexpr int UpdateBudgetShare = 4; ///< The update phase may use 1/UpdateBudgetShare of the interval.
+        static constexpr int LayoutBudgetShare = 4; ///< The layout phase may use 1/LayoutBudgetShare of the interval.
+
+    private:
+        int refreshRate;
+        Clock::duration interval;
+        FramePolicy policy;
+        bool isVSync;
+
+        Clock::time_point vsyncTime;     ///< The last known refresh tick, the other ticks are multiples of interval apart.
+        Clock::time_point nextFrameTime;
+        Clock::time_point frameStartTime;
+        Clock::time_point updateEndTime;
+        Clock::time_point renderEndTime;
+        bool isInFrame;
+        bool isRenderEnded;
+
+        Clock::duration lastFrameDuration;
+        Clock::duration lastWorkDuration;
+        Clock::duration lastUpdateDuration;
+        Clock::duration lastLayoutDuration;
+        size_t frameCount;
+        size_t lateFrameCount;
+        bool isLastFrameLate;
+
+        Clock::time_point GetNextTick(Clock::time_point time) const;
+
+    public:
+        FrameClock();
+
+        /**
+         * @brief Sets the refresh rate of the display, e.g. 60, 120 or 144 Hz.
+         * @param value The rate in Hz, values <= 0 use DefaultRefreshRate.
+         */
+        void SetRefreshRate(int value);
+        __always_inline int GetRefreshRate() const { return refreshRate; }
+        __always_inline Clock::duration GetInterval() const { return interval; }
+
+        __always_inline FramePolicy GetPolicy() const { return policy; }
+        __always_inline void SetPolicy(FramePolicy value) { policy = value; }
+
+        /**
+         * @brief Tells the clock whether the swap of a presented frame waits for the vertical blank.
+         */
+        __always_inline void SetIsVSync(bool value) { isVSync = value; }
+        __always_inline bool GetIsVSync() const { return isVSync; }
+
+        /**
+         * @brief Gets the time the next frame may start.
+         */
+        __always_inline Clock::time_point GetNextFrameTime() const { return nextFrameTime; }
+
+        /**
+         * @brief Returns true if the next frame may start.
+         */
+        __always_inline bool IsFrameDue(Clock::time_point now) const { return now >= nextFrameTime; }
+
+        /**
+         * @brief Starts a frame with its update phase.
+         */
+        void BeginFrame(Clock::time_point now);
+
+        /**
+         * @brief Ends the update phase, the layout phase follows.
+         */
+        void EndUpdate(Clock::time_point now);
+
+        /**
+         * @brief Ends the layout phase, rendering follows.
+         */
+        void EndLayout(Clock::time_point now);
+
+        /**
+         * @brief Ends the rendering right before the swap, the time the swap waits for the blank is not work.
+         */
+        void EndRender(Clock::time_point now);
+
+        /**
+         * @brief Ends a frame and calculates when the next one may start.
+         * The frame is late if its work, up to EndRender or to now without a swap, took longer than an interval.
+         * @param now The time the frame ended, after the swap if it was presented.
+         * @param isPresented True if the buffers were swapped.
+         */
+        void EndFrame(Clock::time_point now, bool isPresented);
+
+        /**
+         * @brief Gets the time left for the update phase of the current frame, zero if it is used up.
+         */
+        Clock::duration GetRemainingUpdateBudget(Clock::time_point now) const;
+
+        /**
+         * @brief Returns true if the layout phase of the current frame used up its budget.
+         * Outside of a frame there is no budget.
+         */
+        bool IsLayoutOverBudget(Clock::time_point now) const;
+
+        __always_inline Clock::duration GetLastFrameDuration() const { return lastFrameDuration; }
+        __always_inline Clock::duration GetLastWorkDuration() const { return lastWorkDuration; }
+        __always_inline Clock::duration GetLastUpdateDuration() const { return lastUpdateDuration; }
+        __always_inline Clock::duration GetLastLayoutDuration() const { return lastLayoutDuration; }
+        __always_inline size_t GetFrameCount() const { return frameCount; }
+        __always_inline size_t GetLateFrameCount() const { return lateFrameCount; }
+        __always_inline bool GetIsLastFrameLate() const { return isLastFrameLate; }
+    };
+}
+
+using namespace xit::Drawing;
@@ -48,6 +48,9 @@ namespace xit::Drawing
         virtual Size Measure(const Size &availableSize) override;
         Size &MeasureText();
 
+        // sets the size of the text when the owner measured it already, e.g. a TextBox from its TextRun
+        void SetTextSize(const Size &value);
+
         static const void MeasureText(const std::string &fontName, int fontSize, const std::string &text, Size &target);
 
         //******************************************************************************
@@ -15,13 +15,30 @@ namespace xit::Drawing
 
     class ListView : public ScrollViewer
     {
+    public:
+        // Upper limit of image loads queued in the TextureLoader by list views
+        static constexpr size_t MaxPendingImageLoads = 16;
+        // Upper limit of items getting their image source per layout update
+        static constexpr size_t MaxImagesPerUpdate = 64;
+        // Rows realized above and below the viewport by a virtualizing list view
+        static constexpr size_t VirtualizationOverscan = 4;
+
     private:
-        std::vector<std::thread> threads;
-        std::thread updateThread;
         int headerItemCount;
+        // items whose image is not requested yet, cleared (and so cancelled) by UpdateList
+        std::vector<ListItem *> pendingImages;
         std::list<std::string> visibleItems;
         const std::list<std::string> *items;
 
+        bool isVirtualizing;
+        int itemHeight;
+        int estimatedItemHeight; // height of a realized container in pixels, 0 until one is laid out
+        // items passing the filter and their index in items, used by a virtualizing list view
+        std::vector<const std::string *> virtualItems;
+        std::vector<int> virtualItemIndices;
+        // index in items shown by each container, -1 if the container is not used
+        std::vector<int> realizedItems;
+
         bool isSelectionChanging;
         std::list<ListItem *> selectedChildren;
         std::string selectedValue;
@@ -40,12 +57,23 @@ namespace xit::Drawing
         void SingleSelect(int index);
 
         void HandleSelectionChanged(std::list<ListItem *> *items);
+        void LoadPendingImages();
+
+        int GetItemHeightInPixels() const;
+        ListItem *GetRealizedContainer(int index);
+        void UpdateVirtualList();
+        void RealizeItems(int viewportHeight);
 
     protected:
         virtual void OnSelectionChanged(const std::string &selectedValue);
 
+        virtual void OnUpdate(const Rectangle &bounds) override;
+
         virtual ListItem *GetContainerForItemOverride();
 
+        // Loads in flight which count against MaxPendingImageLoads, the ones of the TextureLoader
+        virtual size_t GetPendingImageLoadCount() const;
+
         void OnKeyDown(KeyEventArgs &e) override;
 
         bool FilterItem(const std::string &value);
@@ -72,6 +100,15 @@ namespace xit::Drawing
 
         void SetFilter(const std::vector<std::string> *value);
 
+        // Virtualizing list views only create containers for the items in the viewport (plus VirtualizationOverscan rows)
+        // and reuse them while scrolling. All items have to be of the same height. Header columns are not supported.
+        __always_inline bool GetIsVirtualizing() const { return isVirtualizing; }
+        void SetIsVirtualizing(bool value);
+
+        // Height of the items of a virtualizing list view, 0 to use the height of the first container
+        __always_inline int GetItemHeight() const { return itemHeight; }
+        void SetItemHeight(int value);
+
         Event<const std::string &> SelectionChanged;
 
         ListView();
@@ -2,10 +2,7 @@
 
 #include <string>
 #include <Event.h>
-#ifdef DEBUG_INITIALIZATION
-#include <chrono>
-#include <iostream>
-#endif
+#include <OpenGL/Profiler.h>
 
 namespace xit
 {
@@ -22,30 +19,11 @@ namespace xit
          */
         void HandleBrushGroupChanged()
         {
-#ifdef DEBUG_INITIALIZATION
-            static int callCount = 0;
-            callCount++;
-            auto start = std::chrono::steady_clock::now();
-#endif
+            PROFILE_ZONE("BrushGroupProperty::HandleBrushGroupChanged");
+
             EventArgs e;
             BrushGroupChanged(*this, e);
-#ifdef DEBUG_INITIALIZATION
-            auto afterEvent = std::chrono::steady_clock::now();
-#endif
             OnBrushGroupChanged(e);
-#ifdef DEBUG_INITIALIZATION
-            auto end = std::chrono::steady_clock::now();
-            auto totalDuration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
-            auto eventDuration = std::chrono::duration_cast<std::chrono::microseconds>(afterEvent - start);
-            auto onChangedDuration = std::chrono::duration_cast<std::chrono::microseconds>(end - afterEvent);
-
-            if (totalDuration.count() > 100 || callCount <= 5) // Log first 5 calls or any > 100μs
-            {
-                std::cout << ">>> BRUSH GROUP PROPERTY #" << callCount << ": Total="
-                          << totalDuration.count() << "μs, Event=" << eventDuration.count()
-                          << "μs, OnChanged=" << onChangedDuration.count() << "μs <<<" << std::endl;
-            }
-#endif
         }
 
     protected:
@@ -71,46 +49,11 @@ namespace xit
          */
         void SetBrushGroup(const std::string &value)
         {
-#ifdef DEBUG_INITIALIZATION
-            auto start = std::chrono::steady_clock::now();
-            std::cout << ">>> DEBUG: SetBrushGroup called with value='" << value << "', current='" << brushGroup << "' <<<" << std::endl;
-#endif
             if (brushGroup != value)
             {
-#ifdef DEBUG_INITIALIZATION
-                std::cout << ">>> DEBUG: Brush group changing from '" << brushGroup << "' to '" << value << "' <<<" << std::endl;
-                auto beforeChange = std::chrono::steady_clock::now();
-#endif
                 brushGroup = value;
-#ifdef DEBUG_INITIALIZATION
-                auto afterAssignment = std::chrono::steady_clock::now();
-                std::cout << ">>> DEBUG: About to call HandleBrushGroupChanged() <<<" << std::endl;
-#endif
                 HandleBrushGroupChanged();
-#ifdef DEBUG_INITIALIZATION
-                auto afterHandle = std::chrono::steady_clock::now();
-                std::cout << ">>> DEBUG: HandleBrushGroupChanged() completed <<<" << std::endl;
-
-                auto assignmentDuration = std::chrono::duration_cast<std::chrono::microseconds>(afterAssignment - beforeChange);
-                auto handleDuration = std::chrono::duration_cast<std::chrono::microseconds>(afterHandle - afterAssignment);
-                auto totalDuration = std::chrono::duration_cast<std::chrono::microseconds>(afterHandle - start);
-
-                std::cout << ">>> SETBRUSHGROUP TIMING for '" << value << "': Total=" << totalDuration.count()
-                          << "μs, Assignment=" << assignmentDuration.count()
-                          << "μs, Handle=" << handleDuration.count() << "μs <<<" << std::endl;
-#endif
-            }
-#ifdef DEBUG_INITIALIZATION
-            else
-            {
-                auto end = std::chrono::steady_clock::now();
-                auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
-                if (duration.count() > 100)
-                {
-                    std::cout << ">>> SETBRUSHGROUP: No change needed, took " << duration.count() << "μs <<<" << std::endl;
-                }
             }
-#endif
         }
 
         /**
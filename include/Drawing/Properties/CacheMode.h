@@ -0,0 +1,21 @@
+#pragma once
+
+namespace xit::Drawing
+{
+    /**
+     * @brief Defines how the rendered content of a visual is kept between frames.
+     */
+    enum class CacheMode
+    {
+        /**
+         * @brief The content is drawn into the window in every frame it is visible.
+         */
+        None = 0,
+        /**
+         * @brief The content is rendered once into an offscreen layer and composited as a single quad
+         * until it changes. Content outside of the bounds of the visual is cut off.
+         */
+        Layer = 1
+    };
+}
+using namespace xit::Drawing;
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <Event.h>
+#include <Drawing/Properties/CacheMode.h>
+
+namespace xit::Drawing
+{
+    /**
+     * @brief Represents a property that defines the cache mode.
+     */
+    class CacheModeProperty
+    {
+    private:
+        CacheMode cacheMode;
+
+        /**
+         * @brief Handles the event when the cache mode changes.
+         */
+        void HandleCacheModeChanged()
+        {
+            EventArgs e;
+            CacheModeChanged(*this, e);
+            OnCacheModeChanged(e);
+        }
+
+    protected:
+        /**
+         * @brief Called when the cache mode changes.
+         *
+         * You can override this method to add custom logic when the cache mode changes.
+         *
+         * @param e The event arguments.
+         */
+        virtual void OnCacheModeChanged(EventArgs &e) { (void)e; }
+
+    public:
+        /**
+         * @brief Gets the cache mode.
+         * @return The cache mode.
+         */
+        __always_inline CacheMode GetCacheMode() const { return cacheMode; }
+
+        /**
+         * @brief Sets the cache mode.
+         * @param value The new cache mode.
+         */
+        void SetCacheMode(const CacheMode value)
+        {
+            if (cacheMode != value)
+            {
+                cacheMode = value;
+                HandleCacheModeChanged();
+            }
+        }
+
+        /**
+         * @brief Event triggered when the cache mode changes.
+         */
+        Event<CacheModeProperty &, EventArgs &> CacheModeChanged;
+
+        /**
+         * @brief Default constructor.
+         */
+        CacheModeProperty() : cacheMode(CacheMode::None) {}
+    };
+}
+
+using namespace xit::Drawing;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <OpenGL/Text/FontStorage.h>
 
 namespace xit::Drawing
 {
@@ -9,14 +10,21 @@ namespace xit::Drawing
     private:
         std::string fontName;
         int fontSize;
+        float fontScale;
         bool needMeasureFont;
 
+        // resolved on first use after the name, size or scale changed
+        FontHandle fontHandle;
+
     protected:
         virtual void OnFontSizeChanged() {}
 
         __always_inline const bool GetNeedMeasureFont() const { return needMeasureFont; }
         void SetNeedMeasureFont(bool value) { needMeasureFont = value; }
 
+        // the DPI scale the font size is multiplied with
+        void SetFontScale(float value);
+
     public:
         FontProperty();
 
@@ -25,5 +33,10 @@ namespace xit::Drawing
 
         __always_inline int GetFontSize() const { return fontSize; }
         void SetFontSize(int value);
+
+        __always_inline int GetScaledFontSize() const { return (int)((float)fontSize * fontScale); }
+
+        // the font of the scaled font size, measuring and rendering with it does not look up the font
+        const FontHandle &GetFontHandle();
     };
-}
\ No newline at end of file
+}
@@ -25,6 +25,12 @@ namespace xit::Drawing
         __always_inline const std::string &GetText() const { return text; }
         void SetText(const std::string &value);
 
+        // replaces a part of the text in place instead of assigning a copy of the whole text
+        void ReplaceText(size_t index, size_t removedLength, const std::string &value);
+
+        // overwrites the characters of the text before it is cleared
+        void EraseText();
+
         __always_inline const TextWrapping &GetTextWrapping() const { return textWrapping; }
         void SetTextWrapping(const TextWrapping &value);
     };
@@ -9,7 +9,9 @@
 #include <Drawing/Buttons/ButtonBase.h>
 #include <Drawing/Border.h>
 #include <Drawing/Brushes/SolidColorBrush.h>
+#include <Drawing/TextBuffer.h>
 #include <Input/TextChangedEventArgs.h>
+#include <OpenGL/Text/TextRun.h>
 
 namespace xit::Drawing
 {
@@ -24,8 +26,11 @@ namespace xit::Drawing
         Border selectionBorder;
         Timer caretTimer;
 
-        std::string viewText;
-        std::string internalText;
+        // the entered text, the text of textLabel is patched with each edit instead of being copied from it
+        TextBuffer textBuffer;
+
+        // the caret positions of the text of textLabel, invalidated when it changes and rebuilt when the font changes
+        TextRun textRun;
 
         size_t textLength;
         // SecureText* secureText;
@@ -64,10 +69,10 @@ namespace xit::Drawing
 
         static constexpr char PasswordCharacter = '*';
 
-        __always_inline const std::string &GetText() const { return viewText; }
+        __always_inline const std::string &GetText() const { return textLabel.GetText(); }
         void SetText(const std::string &value);
 
-        inline std::string GetPassword() { return internalText; }
+        inline std::string GetPassword() { return textBuffer.ToString(); }
 
         __always_inline const std::string &GetHintText() const { return textHintLabel.GetText(); }
         __always_inline void SetHintText(const std::string &value) { textHintLabel.SetText(value); }
@@ -122,10 +127,13 @@ namespace xit::Drawing
         void UpdateForeground();
 
         size_t GetMouseCharacterIndex(int mouseXPosition);
+        const TextRun &GetTextRun();
+        void UpdateTextSize();
 
         void UpdateTextHintLabel();
 
         void UpdateVisibleText();
+        void UpdateVisibleText(size_t index, size_t removedLength, size_t insertedLength);
         void ShowPasswordButton_ActiveChanged(IsActiveProperty &sender, EventArgs &e);
         void HandleControl(KeyEventArgs &e, bool isSelection);
 
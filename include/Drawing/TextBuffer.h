@@ -0,0 +1,145 @@
+/**
+ * @file TextBuffer.h
+ * @brief Defines the TextBuffer class, the piece table holding the text of a TextBox.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace xit::Drawing
+{
+    /**
+     * @class TextBuffer
+     * @brief A piece table with an index of its line starts.
+     *
+     * Inserted text is appended to a single buffer which is never modified, the text is a sequence
+     * of pieces of that buffer. The pieces are the nodes of a treap ordered by their position in the text,
+     * every node knows the length and the number of line breaks of its subtree.
+     * Inserting and removing split and merge the treap in O(log n), finding a line or the line of a
+     * character descends it in O(log n). Consecutive typing extends the last piece instead of adding one.
+     * Removed text stays in the buffer until Erase, which overwrites it. The buffer grows by copying,
+     * the block it outgrew is overwritten before it is freed, so no typed text is left in freed memory.
+     */
+    class TextBuffer
+    {
+    private:
+        static constexpr size_t None = SIZE_MAX;
+
+        struct Node
+        {
+            size_t Start;          ///< Start of the piece in the buffer.
+            size_t Length;         ///< Length of the piece.
+            size_t NewLines;       ///< Line breaks in the piece.
+            size_t SubtreeLength;  ///< Length of all pieces of the subtree.
+            size_t SubtreeNewLines; ///< Line breaks of all pieces of the subtree.
+            uint32_t Priority;
+            size_t Left;
+            size_t Right;
+        };
+
+        std::string buffer;                  ///< All text ever inserted, append only.
+        std::vector<size_t> newLines;        ///< Positions of the line breaks in the buffer, sorted because it is append only.
+        std::vector<Node> nodes;             ///< Node pool, the treap links by index.
+        std::vector<size_t> freeNodes;       ///< Unused nodes of the pool.
+        std::array<size_t, 256> characterCounts; ///< Number of each byte in the text.
+        size_t root;
+        uint32_t seed;
+
+        __always_inline size_t SubtreeLength(size_t node) const { return node == None ? 0 : nodes[node].SubtreeLength; }
+        __always_inline size_t SubtreeNewLines(size_t node) const { return node == None ? 0 : nodes[node].SubtreeNewLines; }
+
+        size_t CountNewLines(size_t start, size_t length) const;
+        size_t CreateNode(size_t start, size_t length);
+        void FreeTree(size_t node);
+        void Update(size_t node);
+        void Split(size_t node, size_t index, size_t &left, size_t &right);
+        size_t Merge(size_t left, size_t right);
+        bool ExtendLast(size_t node, size_t start, size_t length);
+        void Reserve(size_t length);
+        void Append(size_t node, size_t index, size_t count, std::string &target) const;
+        bool Equals(size_t node, const std::string &text, size_t &offset) const;
+        void CountCharacters(size_t node, int sign);
+
+    public:
+        TextBuffer();
+        ~TextBuffer();
+
+        TextBuffer(const TextBuffer &) = delete;
+        TextBuffer &operator=(const TextBuffer &) = delete;
+
+        /**
+         * @brief Gets the length of the text.
+         */
+        __always_inline size_t GetLength() const { return SubtreeLength(root); }
+
+        __always_inline bool IsEmpty() const { return root == None; }
+
+        /**
+         * @brief Gets the number of lines, one more than the number of line breaks.
+         */
+        __always_inline size_t GetLineCount() const { return SubtreeNewLines(root) + 1; }
+
+        /**
+         * @brief Gets the index of the first character of a line in O(log n).
+         * @return The length of the text if the line does not exist.
+         */
+        size_t GetLineStart(size_t line) const;
+
+        /**
+         * @brief Gets the line of a character in O(log n).
+         */
+        size_t GetLine(size_t index) const;
+
+        /**
+         * @brief Gets a character in O(log n).
+         */
+        char At(size_t index) const;
+
+        /**
+         * @brief Gets the number of occurrences of a byte in O(1).
+         */
+        __always_inline size_t Count(char c) const { return characterCounts[(unsigned char)c]; }
+
+        /**
+         * @brief Returns true if the text contains any of the characters.
+         */
+        bool ContainsAny(const std::string &characters) const;
+
+        /**
+         * @brief Inserts a text in O(log n) plus the length of the text.
+         */
+        void Insert(size_t index, const std::string &text);
+
+        /**
+         * @brief Removes characters in O(log n) plus the number of removed characters. The range is clamped to the text.
+         */
+        void Remove(size_t index, size_t count);
+
+        /**
+         * @brief Copies a range of the text. The range is clamped to the text.
+         */
+        std::string GetText(size_t index, size_t count) const;
+
+        /**
+         * @brief Copies the whole text.
+         */
+        __always_inline std::string ToString() const { return GetText(0, GetLength()); }
+
+        /**
+         * @brief Compares the text with a string piece by piece, without copying it. Different lengths return at once.
+         */
+        bool Equals(const std::string &text) const;
+
+        /**
+         * @brief Removes the text and overwrites the buffer, also the text which was removed before.
+         */
+        void Erase();
+    };
+}
+
+using namespace xit::Drawing;
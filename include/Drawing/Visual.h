@@ -2,6 +2,7 @@
 
 #include <stdint.h>
 #include <any>
+#include <atomic>
 
 #include <Input/Point.h>
 #include <Drawing/Properties/ParentProperty.h>
@@ -20,12 +21,25 @@ namespace xit::Drawing
                    public Renderable,
                    public ParentProperty
     {
+        friend class Window; // uses the invalidation queue fields
+
     private:
         std::any tag;
 
+        // the owning window is cached until any parent in any tree changes, only used by the render thread
+        Window *window;
+        size_t windowGeneration;
+        static std::atomic<size_t> treeGeneration;
+
+        // the invalidation epoch of the window the visual was last queued in, see Window::InvalidateRegion
+        size_t invalidationEpoch;
+
     protected:
         virtual void OnNameChanged(EventArgs &e) override;
+        virtual void OnParentChanged(EventArgs &e) override;
         virtual void NotifyWindowOfInvalidation() override;
+        virtual void NotifyParentOfChildLayout() override;
+        virtual void NotifyParentOfDesiredSizeChange() override;
 
     public:
         __always_inline std::any &GetTag() { return tag; }
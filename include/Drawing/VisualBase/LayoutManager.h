@@ -37,9 +37,12 @@ namespace xit::Drawing::VisualBase
         bool needHeightRecalculation;
         bool needLeftRecalculation;
         bool needTopRecalculation;
+        bool needChildLayout; // at least one descendant has to be laid out
 
         Rectangle clientBounds;
 
+        static size_t layoutPassCount;
+
     protected:
         Size desiredSize;
 
@@ -97,6 +100,13 @@ namespace xit::Drawing::VisualBase
         // Parent notification methods for background buffer support
         virtual void NotifyWindowOfInvalidation();
 
+        // Parent notification methods for incremental layout, overridden by Visual
+        virtual void NotifyParentOfChildLayout() {}
+        virtual void NotifyParentOfDesiredSizeChange() {}
+
+        // Marks this element to be visited by the next layout pass because a descendant needs layout
+        __always_inline void SetNeedChildLayout() { needChildLayout = true; }
+
         static inline int CheckMinMaxWidth(const LayoutManager &visual, int value)
         {
             return Math::CheckMinMax(visual.GetMinWidth(), visual.GetMaxWidth(), value);
@@ -111,6 +121,12 @@ namespace xit::Drawing::VisualBase
 
         virtual void Invalidate();
 
+        /*!
+         * @brief Invalidates the desired size and the position of this element.
+         *        Called for the parent when the desired size of a child has changed.
+         */
+        void InvalidateMeasure();
+
         virtual int MeasureWidth(int availableSize);
         virtual int MeasureHeight(int availableSize);
         virtual Size Measure(const Size &availableSize);
@@ -130,6 +146,24 @@ namespace xit::Drawing::VisualBase
         __always_inline bool GetNeedLeftRecalculation() const { return needLeftRecalculation; }
         __always_inline bool GetNeedTopRecalculation() const { return needTopRecalculation; }
         __always_inline bool GetInvalidated() const { return invalidated; }
+        __always_inline bool GetNeedChildLayout() const { return needChildLayout; }
+
+        /*!
+         * @brief Returns true if UpdateLayout has anything to do with unchanged bounds.
+         */
+        __always_inline bool GetNeedLayout() const
+        {
+            return invalidated || needChildLayout ||
+                   needWidthRecalculation || needHeightRecalculation ||
+                   needLeftRecalculation || needTopRecalculation;
+        }
+
+        /*!
+         * @brief Gets the number of elements laid out by UpdateLayout since the last reset.
+         *        A frame without any layout changes does not lay out a single element.
+         */
+        __always_inline static size_t GetLayoutPassCount() { return layoutPassCount; }
+        __always_inline static void ResetLayoutPassCount() { layoutPassCount = 0; }
 
         virtual void OnBackgroundChanged(EventArgs &e) { (void)e; }
         virtual void OnForegroundChanged(EventArgs &e) { (void)e; }
@@ -0,0 +1,176 @@
+/**
+ * @file RenderCommandList.h
+ * @brief Defines the RenderCommandList class holding the recorded draw output of a visual subtree.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include <Drawing/Rectangle.h>
+#include <OpenGL/QuadInstance.h>
+#include <OpenGL/Text/GlyphInstance.h>
+
+#ifndef GLAD_INCLUDED
+#include <glad/glad.h>
+#define GLAD_INCLUDED
+#endif
+
+namespace xit::OpenGL
+{
+    class Texture;
+}
+
+namespace xit::Drawing::VisualBase
+{
+    class Renderable;
+
+    /**
+     * @brief The kind of a RenderCommand.
+     */
+    enum class RenderCommandType : unsigned char
+    {
+        Quads,    ///< Count quads starting at First.
+        Glyphs,   ///< Count glyphs starting at First, drawn with the atlas Texture.
+        PushClip, ///< Clips to Bounds. Count commands follow before the matching PopClip.
+        PopClip,  ///< Ends the clip of the matching PushClip.
+        Cull,     ///< The Count following commands are the output of a visual with Bounds, skipped if Bounds is not visible.
+        Child     ///< Renders Child, a visual with its own command list.
+    };
+
+    /**
+     * @brief A single recorded command, plain data without any ownership.
+     */
+    struct RenderCommand
+    {
+        RenderCommandType Type;
+        int Count;
+        size_t First;
+        int Bounds[4];       ///< left, top, width, height in window coordinates. A width of 0 is never culled.
+        GLuint Texture;
+        Renderable *Child;
+    };
+
+    /**
+     * @class RenderCommandList
+     * @brief The draw output of a visual and its content, recorded once and replayed every frame.
+     *
+     * While a list is recording, Graphics::DrawRectangle and TextRenderer::RenderText append
+     * their instances to it instead of drawing. Replaying copies the instances into the batches
+     * without walking the visual tree. Content with its own list is referenced by a Child command,
+     * so it can be recorded again without touching this list.
+     * The list keeps the visuals it recorded, they invalidate it when they change.
+     */
+    class RenderCommandList
+    {
+    private:
+        std::vector<RenderCommand> commands;
+        std::vector<QuadInstance> quads;
+        std::vector<const OpenGL::Texture *> quadTextures; ///< The texture storage of each quad, nullptr if it has none.
+        std::vector<GlyphInstance> glyphs;
+        std::vector<Renderable *> visuals;               ///< The visuals which were recorded into the list, in no particular order.
+        std::vector<size_t> openClips;                   ///< The indices of the PushClip commands without PopClip while recording.
+        size_t sealedCommands;                           ///< Commands before this index belong to a finished Cull and must not grow.
+        size_t glyphAtlasEvictions;                      ///< GlyphAtlas::GetEvictionCount when the list was recorded.
+        bool isValid;
+
+        static RenderCommandList *recording;
+
+        RenderCommand &AddCommand(RenderCommandType type);
+        bool CanAppendTo(RenderCommandType type) const;
+        static void SetBounds(RenderCommand &command, const Rectangle &bounds);
+
+    public:
+        RenderCommandList();
+
+        /**
+         * @brief Gets the list which is recording at the moment, nullptr if draws go to the batches.
+         */
+        __always_inline static RenderCommandList *GetRecording() { return recording; }
+
+        /**
+         * @brief Clears the list and lets the following draws append to it.
+         */
+        void BeginRecording();
+
+        /**
+         * @brief Stops recording. The list is valid until Invalidate is called.
+         */
+        void EndRecording();
+
+        /**
+         * @brief Returns true if the list was recorded and nothing it depends on has changed since.
+         */
+        bool GetIsValid() const;
+
+        /**
+         * @brief Marks the list to be recorded again before the next replay.
+         */
+        __always_inline void Invalidate() { isValid = false; }
+
+        /**
+         * @brief Removes all commands, instances and visuals.
+         */
+        void Clear();
+
+        /**
+         * @brief Appends a quad. Consecutive quads share one command.
+         * @param quad The quad, its texture slot is resolved when it is replayed.
+         * @param texture The texture storage sampled by the quad or nullptr.
+         */
+        void AddQuad(const QuadInstance &quad, const OpenGL::Texture *texture);
+
+        /**
+         * @brief Appends a glyph. Consecutive glyphs of the same atlas share one command.
+         * @param texture The atlas texture of the glyph.
+         * @return The glyph to fill in.
+         */
+        GlyphInstance &AddGlyph(GLuint texture);
+
+        /**
+         * @brief Starts clipping to a rectangle, must be followed by PopClip.
+         */
+        void PushClip(const Rectangle &bounds);
+
+        /**
+         * @brief Ends the clip of the last PushClip. A clip without any command is removed again.
+         */
+        void PopClip();
+
+        /**
+         * @brief Starts the output of a visual which may be culled when it is replayed.
+         * @param bounds The bounds of the visual, an empty rectangle if it must never be culled.
+         * @return The index to pass to EndCull.
+         */
+        size_t BeginCull(const Rectangle &bounds);
+
+        /**
+         * @brief Ends the output of a visual. Output without any command is removed again.
+         */
+        void EndCull(size_t index);
+
+        /**
+         * @brief Appends a reference to a visual with its own list.
+         */
+        void AddChild(Renderable *child);
+
+        /**
+         * @brief Remembers a visual which was recorded into the list, once no matter how often it is added.
+         */
+        void AddVisual(Renderable *visual);
+
+        /**
+         * @brief Forgets a visual in O(1), e.g. because it is destroyed or recorded by another list.
+         * The last visual takes its place.
+         */
+        void RemoveVisual(Renderable *visual);
+
+        __always_inline const std::vector<RenderCommand> &GetCommands() const { return commands; }
+        __always_inline const std::vector<QuadInstance> &GetQuads() const { return quads; }
+        __always_inline const std::vector<const OpenGL::Texture *> &GetQuadTextures() const { return quadTextures; }
+        __always_inline const std::vector<GlyphInstance> &GetGlyphs() const { return glyphs; }
+        __always_inline const std::vector<Renderable *> &GetVisuals() const { return visuals; }
+    };
+}
+
+using namespace xit::Drawing::VisualBase;
@@ -1,10 +1,12 @@
 #pragma once
 
+#include <vector>
 #include <Properties/EnabledProperty.h>
 #include <Drawing/Brushes/ImageBrush.h>
 #include <Drawing/Properties/BackgroundProperty.h>
 #include <Drawing/Properties/BorderBrushProperty.h>
 #include <Drawing/Properties/BrushGroupProperty.h>
+#include <Drawing/Properties/CacheModeProperty.h>
 #include <Drawing/Properties/ForegroundProperty.h>
 #include <Drawing/Properties/RotationProperty.h>
 #include <Drawing/Properties/ZIndexProperty.h>
@@ -16,16 +18,21 @@
 
 namespace xit::Drawing::VisualBase
 {
+    class RenderCommandList;
+
     class Renderable : public LayoutManager,
                        public Properties::EnabledProperty,
                        public BrushGroupProperty,
                        public RotationProperty,
                        public ZIndexProperty,
+                       public CacheModeProperty,
                        public BackgroundProperty,
                        public ForegroundProperty,
                        public BorderBrushProperty,
                        public VisualStateManager
     {
+        friend class RenderCommandList; // keeps renderCommandsSlot
+
     private:
         using Texture = xit::OpenGL::Texture;
 
@@ -42,10 +49,36 @@ namespace xit::Drawing::VisualBase
         LayoutVisualStateGroup *layoutVisualStateGroup;
         LayoutVisualState *currentLayoutVisualState;
 
-        static Renderable *firstInvalidator;
+        // the parts of the window which can still be drawn to, in window coordinates. The render pass owns it:
+        // Window::DoRender puts the redrawn region at the bottom, visuals clipping to their bounds push the
+        // intersection with their bounds while their content renders. The top is the scissor of Graphics.
+        static std::vector<Rectangle> clipStack;
+
+        // renderables with an image texture which is still loading, see InvalidateLoadedTextures
+        static std::vector<Renderable *> textureWaiters;
+        bool isWaitingForTexture;
+
+        // the recorded draw output of this visual and its content, nullptr if it draws directly, see SetCacheRenderCommands
+        RenderCommandList *renderCommands;
+        // the command list which recorded this visual, inline or as a reference to its own list
+        RenderCommandList *renderCommandsOwner;
+        // the index of this visual in the visuals of the list which recorded it last, see RenderCommandList::RemoveVisual
+        size_t renderCommandsSlot;
 
         void HandleBrushGroupChanged();
 
+        static bool PushClipBounds(const Rectangle &value);
+        static void PopClipBounds();
+        static void ApplyClipBounds();
+        const OpenGL::Texture *FindOrCreateImageTexture(const ImageBrush *imageBrush);
+        bool IsWaitingForTexture() const;
+
+        void RecordInto(RenderCommandList *recording, int actualWidth, int actualHeight);
+        void RecordRenderCommands(int actualWidth, int actualHeight);
+        void ReplayRenderCommands();
+        bool IsRenderCommandsValid() const;
+        bool CompositeLayer(int actualWidth, int actualHeight);
+
     protected:
         const OpenGL::Texture *backgroundTexture;
         const OpenGL::Texture *borderTexture;
@@ -56,6 +89,7 @@ namespace xit::Drawing::VisualBase
         virtual void OnBackgroundChanged(EventArgs &e) override;
         virtual void OnForegroundChanged(EventArgs &e) override;
         virtual void OnBorderBrushChanged(EventArgs &e) override;
+        virtual void OnScaleChanged(EventArgs &e) override;
 
         virtual void OnBrushGroupChanged(EventArgs &e);
         virtual void OnUpdateBrushes(BrushVisualState *value);
@@ -68,6 +102,13 @@ namespace xit::Drawing::VisualBase
 
         virtual void OnVisualStateChanged(EventArgs &e) override;
 
+        virtual void OnInvalidated(EventArgs &e) override;
+        virtual void OnVisibilityChanged(EventArgs &e) override;
+        virtual void OnLayoutChanged(const Rectangle &bounds) override;
+        virtual void OnZIndexChanged(EventArgs &e) override;
+        virtual void OnRotationChanged(EventArgs &e) override;
+        virtual void OnCacheModeChanged(EventArgs &e) override;
+
         virtual void OnRender();
 
     public:
@@ -123,5 +164,48 @@ namespace xit::Drawing::VisualBase
         }
 
         void Render();
+
+        /// <summary>
+        /// Gets whether the draw output of this visual and its content is recorded once and replayed
+        /// every frame until something in it changes.
+        /// </summary>
+        __always_inline bool GetCacheRenderCommands() const { return renderCommands != nullptr; }
+
+        /// <summary>
+        /// Records the draw output of this visual and its content into a RenderCommandList, containers do by default.
+        /// The list is recorded again when the visual or anything recorded into it is invalidated.
+        /// </summary>
+        void SetCacheRenderCommands(bool value);
+
+        /// <summary>
+        /// Records the command list holding the draw output of this visual again before the next frame.
+        /// Call it when something is drawn differently without invalidating the visual.
+        /// </summary>
+        void InvalidateRenderCommands();
+
+        /// <summary>
+        /// Returns true if the visual can be skipped with all of its content because it does not intersect
+        /// the clip bounds of its clipping ancestors and the region Window::DoRender redraws.
+        /// Rotated visuals are never skipped, they may reach out of their bounds.
+        /// </summary>
+        bool IsOutsideClipBounds() const;
+
+        /// <summary>
+        /// Limits rendering to a part of the window, Window::DoRender sets the region it redraws.
+        /// Starts a new clip stack with the region at its bottom.
+        /// </summary>
+        /// <param name="value">The region in window coordinates.</param>
+        static void SetClipBounds(const Rectangle &value);
+
+        /// <summary>
+        /// Clears the clip stack and disables the scissor, nothing is skipped any more.
+        /// </summary>
+        static void ResetClipBounds();
+
+        /// <summary>
+        /// Invalidates all renderables whose image textures finished loading since the last call.
+        /// Call this on the OpenGL thread after TextureLoader::ProcessUploads uploaded textures.
+        /// </summary>
+        static void InvalidateLoadedTextures();
     };
 } // namespace xit::Drawing::VisualBase
@@ -4,11 +4,29 @@
 #include "Drawing/Properties/WindowStyleProperty.h"
 #include "Drawing/Properties/WindowStateProperty.h"
 #include <Drawing/InputContent.h>
+#include <Drawing/DirtyRegionSet.h>
+#include <Drawing/FrameClock.h>
+#include <OpenGL/Profiler.h>
 #include <OpenGL/Scene2D.h>
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <semaphore>
+#include <thread>
 
 namespace xit::Drawing
 {
+    // What a frame cost, see Window::GetLastFrameStatistics
+    struct FrameStatistics
+    {
+        // pixels rendered into the accumulation target
+        size_t RenderedPixels = 0;
+        // pixels copied to the window
+        size_t PresentedPixels = 0;
+        // false if nothing changed and the buffers were not swapped
+        bool IsPresented = false;
+    };
+
     class Window : public InputContent,
                    public WindowStyleProperty,
                    public WindowStateProperty
@@ -34,20 +52,76 @@ namespace xit::Drawing
         Rectangle clientBounds;
         Scene2D scene;
 
-        std::vector<std::pair<Visual *, Rectangle>> invalidRegions;
+        // A queued invalidation. It holds a copy of the bounds and never points back to the visual,
+        // which may be destroyed before DoRender takes the queue.
+        struct InvalidationNode
+        {
+            Rectangle Bounds;
+            InvalidationNode *Next;
+        };
+
+        // lock-free stack of invalidations, drained by DoRender
+        std::atomic<InvalidationNode *> invalidations{nullptr};
+        // a visual is queued once per epoch, DoRender starts the next one when it takes the stack
+        std::atomic<size_t> invalidationEpoch{1};
+        DirtyRegionSet dirtyRegions;
         std::atomic<bool> redrawScheduled{false};
-        std::mutex invalidRegionsMutex;
+
+        // Upper limit of layout passes per frame, a pass is repeated while
+        // changed desired sizes still have to be propagated to the parents
+        static constexpr int MaxLayoutPasses = 8;
+
+        // Longest sleep of an idle main loop in seconds. Work posted to the Dispatcher
+        // without a WakeUp still runs, only delayed by up to this long
+        static constexpr double MaxIdleWait = 0.1;
+
         std::binary_semaphore mainLoopSemaphore{0};
 
-        // Double buffering for partial region rendering
-        GLuint frontFramebuffer{0};
-        GLuint backFramebuffer{0};
-        GLuint frontColorTexture{0};
-        GLuint backColorTexture{0};
-        GLuint frontDepthTexture{0};
-        GLuint backDepthTexture{0};
+        // Paces the frames to the refresh of the monitor and budgets their update and layout phases
+        FrameClock frameClock;
+        // the time of the current frame, a headless window gets it from RenderFrame and not from the system
+        FrameClock::Clock::time_point frameTime;
+        // layout passes of a layout which was continued in the next frame because it ran out of budget
+        int layoutPass{0};
+        bool isLayoutChanged{false};
+
+        // Persistent accumulation target, only the dirty regions are rendered into it
+        GLuint framebuffer{0};
+        GLuint colorTexture{0};
         bool framebuffersInitialized{false};
 
+        // Where the age of the back buffer comes from, see GetBufferAge
+        enum class BufferAgeSource
+        {
+            None,
+            EGL,
+            GLX
+        };
+
+        // The back buffer holds the frame presented bufferAge presents ago. A present copies its own damage
+        // and the damage of the presents since, kept for up to MaxBufferAge presents. Without EXT_buffer_age
+        // the content of the back buffer is unknown and a present copies the whole target.
+        static constexpr int MaxBufferAge = 4;
+        BufferAgeSource bufferAgeSource{BufferAgeSource::None};
+        std::array<std::vector<Rectangle>, MaxBufferAge - 1> damageHistory;
+        size_t damageHistoryStart{0};
+        int damageHistoryCount{0};
+        DirtyRegionSet presentRegions;
+        // the next present copies the whole target, e.g. after a resize the window buffers are undefined
+        bool isFullPresentNeeded{false};
+        FrameStatistics lastFrameStatistics;
+
+        // Windows render into the accumulation target only, without a visible window or a display, see SetIsHeadless
+        static bool isHeadless;
+
+        // the thread which created the windows and runs the main loop
+        static std::atomic<std::thread::id> renderThread;
+
+        // The counters of the last frame drawn over the top left corner, see Profiler::SetIsOverlayVisible
+        static constexpr int ProfilerOverlayMargin = 8;
+        static constexpr int ProfilerOverlayPadding = 6;
+        Rectangle profilerOverlayBounds;
+
         // Debug timing for construction to first frame
         std::chrono::steady_clock::time_point constructionStartTime;
         std::chrono::steady_clock::time_point initializeStartTime;
@@ -57,12 +131,19 @@ namespace xit::Drawing
 
         void App_Closing(EventArgs &e);
         void ScheduleRedraw();
+        bool IsFrameWaiting();
+        void WaitEvents();
+        void UpdateRefreshRate();
+        FrameClock::Clock::time_point Now() const;
 
-        // Double buffering methods
+        // Accumulation target methods
         void InitializeFramebuffers();
         void CleanupFramebuffers();
-        void SwapFramebuffers();
-        void CopyRegionBetweenFramebuffers(const Rectangle& region);
+        void Present(const std::vector<Rectangle> &damage, FrameStatistics &statistics);
+        void ResolveBufferAge();
+        int GetBufferAge();
+        void InvalidatePresents();
+        void RenderProfilerOverlay(const std::string &text, const Size &textSize);
 
     protected:
         bool isClosing;
@@ -91,7 +172,45 @@ namespace xit::Drawing
 
         void InvalidateRegion(Visual *visual, Rectangle bounds);
 
+        // Copies the whole window again with the next presents, e.g. when the system lost its content
+        void Refresh();
+
+        // Wakes the main loop from any thread, e.g. after posting to the Dispatcher.
+        // Without it posted work waits for the next event, at most MaxIdleWait
+        static void WakeUp();
+
+        __always_inline const FrameStatistics &GetLastFrameStatistics() const { return lastFrameStatistics; }
+
+        // Pacing, budgets and late frames of the window
+        __always_inline const FrameClock &GetFrameClock() const { return frameClock; }
+
+        // Continuous renders the whole window on every refresh, e.g. while animating. OnDemand only renders invalidated windows.
+        __always_inline FramePolicy GetFramePolicy() const { return frameClock.GetPolicy(); }
+        void SetFramePolicy(FramePolicy value);
+
+        // Renders the windows created afterwards offscreen, e.g. for tests and benchmarks on hosts without a GPU.
+        // Uses the null platform of GLFW with an EGL context (e.g. Mesa llvmpipe) and falls back to OSMesa.
+        // A headless window is not shown, the frames are driven by RenderFrame and read back by ReadPixels.
+        static void SetIsHeadless(bool value) { isHeadless = value; }
+        __always_inline static bool GetIsHeadless() { return isHeadless; }
+
+        // true on the thread which created the windows, the only one which may touch the OpenGL context or the layout
+        __always_inline static bool IsRenderThread() { return renderThread.load(std::memory_order_relaxed) == std::this_thread::get_id(); }
+
+        // Renders a frame if one is waiting and due at now, returns false if there was none.
+        // Show calls it with the system time, a headless window can be driven by a synthetic clock.
+        // Budgets are measured against now, so a synthetic frame always lays out completely.
+        bool RenderFrame(FrameClock::Clock::time_point now);
+
+        // Reads the last rendered image as RGBA rows from top to bottom, returns false if nothing was rendered yet
+        bool ReadPixels(std::vector<unsigned char> &pixels);
+
+        // Shows the profiler counters of the last frame over the content
+        __always_inline bool GetIsProfilerOverlayVisible() const { return Profiler::GetIsOverlayVisible(); }
+        void SetIsProfilerOverlayVisible(bool value);
+
         Window();
+        virtual ~Window();
 
     protected:
         virtual void OnWindowStateChanged(EventArgs &e) override;
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <vector>
+
+namespace xit::OpenGL
+{
+    class Texture;
+
+    /// <summary>
+    /// An image decoded (and resampled to its display size) by a worker of the TextureLoader,
+    /// waiting in the staging queue for its upload on the OpenGL thread.
+    /// </summary>
+    struct DecodedImage
+    {
+        Texture *Target = nullptr;
+        std::vector<unsigned char> Pixels; // empty if decoding failed
+        int Width = 0;                     // width of Pixels
+        int Height = 0;                    // height of Pixels
+        int Channels = 0;                  // channels of Pixels
+        int ImageWidth = 0;                // width of the image file
+        int ImageHeight = 0;               // height of the image file
+    };
+}
+
+using namespace xit::OpenGL;
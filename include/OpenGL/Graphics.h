@@ -1,25 +1,65 @@
 ﻿#pragma once
 
+#include <vector>
 #include <OpenGL/Shaders/ShaderProgram.h>
-#include <OpenGL/AttributeBuffer/AttributeBufferList.h>
+#include <OpenGL/RenderState.h>
+#include <OpenGL/VertexBuffers/VertexBuffer.h>
+#include <OpenGL/VertexBuffers/VertexBufferArray.h>
+#include <OpenGL/VertexBuffers/InstanceBuffer.h>
+#include <OpenGL/QuadInstance.h>
 #include <OpenGL/Texture.h>
 #include <Drawing/Brushes/BrushBase.h>
 #include <Drawing/Properties/Thickness.h>
 #include <Drawing/Properties/CornerRadius.h>
+#include <Drawing/Rectangle.h>
 
 namespace xit::OpenGL
 {
+    /// <summary>
+    /// Batched 2D quad renderer.
+    /// DrawRectangle only queues a QuadInstance, the queued rectangles are drawn
+    /// with a single instanced draw call when Flush is called.
+    /// While a RenderCommandList is recording, DrawRectangle appends the QuadInstance to it instead.
+    /// Rectangles and text are queued separately, queuing one flushes the other,
+    /// so at most one of both queues holds data and the draw order is kept.
+    /// Anything changing the GL state used by the batch (other shader programs, framebuffers)
+    /// has to call Flush first to keep the draw order intact.
+    /// The scissor is a command of the batch as well, SetScissor flushes when it changes
+    /// and OpenGL gets the new scissor right before the next draw call.
+    /// All state goes through RenderState, so a flush only binds what changed since the last one.
+    /// </summary>
     class Graphics
     {
+    public:
+        static constexpr int MaxInstances = 4096;
+        static constexpr int MaxTextureSlots = 8;
+
     private:
         static bool isInitialized;
         static ShaderProgram* shaderProgram;
-        static AttributeBufferList* attributeBufferList;
-        static AttributeBuffer* vertexDataBuffer;
-        static AttributeBuffer* texCoordsDataBuffer;
-        static AttributeBuffer* colorDataBuffer;
-        static AttributeBuffer* foregroundColorDataBuffer;
-        static AttributeBuffer* borderColorDataBuffer;
+        static VertexBufferArray* vertexBufferArray;
+        static VertexBuffer* cornerDataBuffer;
+        static InstanceBuffer* instanceDataBuffer;
+
+        // uniform handles of shaderProgram, resolved once in InitShader
+        static int projectionUniform;
+        static int resolutionUniform;
+        static int timeUniform;
+        static int targetOriginUniform;
+
+        static std::vector<QuadInstance> instances;
+        static const Texture* textureSlots[MaxTextureSlots];
+        static int textureSlotCount;
+
+        static size_t drawCallCount;
+
+        // scissor requested by SetScissor and DisableScissor, RenderState knows the one OpenGL was set to last
+        static bool isScissorEnabled;
+        static Rectangle scissorBounds;
+
+        // the position of the render target in the scene, see SetTargetOrigin
+        static int targetOriginX;
+        static int targetOriginY;
 
     public:
         //static Graphics()
@@ -29,10 +69,69 @@ namespace xit::OpenGL
 
     private:
         static void InitShader();
+        static float GetTextureSlot(const Texture* texture);
 
     public:
         static float* GetBrushColor(const BrushBase* brush);
 
+        /// <summary>
+        /// Queues a rectangle for the next Flush.
+        /// </summary>
         static void DrawRectangle(int x, int renderX, int y, int renderY, int z, int width, int height, glm::vec3 rotation, float* backgroundBrush, float* foregroundBrush, float* borderBrush, const Texture* backgroundTexture, const Texture* borderTexture, const Thickness& borderThickness, const CornerRadius& cornerRadius);
+
+        /// <summary>
+        /// Queues rectangles recorded by DrawRectangle into a RenderCommandList.
+        /// </summary>
+        /// <param name="quads">The rectangles.</param>
+        /// <param name="textures">The texture storage of each rectangle, nullptr if it has none.</param>
+        /// <param name="count">The number of rectangles.</param>
+        static void QueueQuads(const QuadInstance* quads, const Texture* const* textures, size_t count);
+
+        /// <summary>
+        /// Queues a texture with its own storage, e.g. the content of a RenderLayer.
+        /// </summary>
+        /// <param name="isPremultiplied">true if the colors of the texture are multiplied with their alpha.</param>
+        static void DrawTexture(int x, int renderX, int y, int renderY, int z, int width, int height, const Texture* texture, bool isPremultiplied);
+
+        /// <summary>
+        /// Draws all queued rectangles and all queued text.
+        /// </summary>
+        static void Flush();
+
+        /// <summary>
+        /// Draws all queued rectangles with one instanced draw call.
+        /// </summary>
+        static void FlushRectangles();
+
+        /// <summary>
+        /// Limits the following draws to a rectangle. Queued draws are flushed if the scissor changes.
+        /// </summary>
+        /// <param name="bounds">The rectangle in window coordinates (origin top left).</param>
+        static void SetScissor(const Rectangle &bounds);
+
+        /// <summary>
+        /// Removes the limit set by SetScissor. Queued draws are flushed if the scissor changes.
+        /// </summary>
+        static void DisableScissor();
+
+        /// <summary>
+        /// Sets the scissor of OpenGL to the requested one if they differ, so the state is never queried.
+        /// Called right before the draw calls of the renderers. Call it before glClear or glBlitFramebuffer,
+        /// they use the scissor as well.
+        /// </summary>
+        static void ApplyScissor();
+
+        /// <summary>
+        /// Sets the position of the render target in the scene, a RenderLayer covers only a part of it.
+        /// The shader and the scissor subtract it from the window coordinates. Queued draws are flushed if it changes.
+        /// </summary>
+        /// <param name="x">The left of the target in OpenGL window coordinates.</param>
+        /// <param name="y">The bottom of the target in OpenGL window coordinates.</param>
+        static void SetTargetOrigin(int x, int y);
+
+        /// <summary>
+        /// Gets the number of draw calls issued by Flush since the application started.
+        /// </summary>
+        __always_inline static size_t GetDrawCallCount() { return drawCallCount; }
     };
 }
@@ -0,0 +1,191 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace xit::OpenGL
+{
+    /// <summary>
+    /// The per frame counters of the Profiler.
+    /// </summary>
+    enum class ProfileCounter : int
+    {
+        LayoutMeasures,     // widths and heights measured again
+        LayoutArranges,     // visuals laid out by UpdateLayout
+        DrawCalls,
+        StateChanges,       // OpenGL state changes which were not skipped by RenderState
+        GlyphsDrawn,
+        TextureUploads,
+        TextureUploadBytes,
+        Invalidations,      // regions invalidated by visuals
+        Count
+    };
+
+    /// <summary>
+    /// A zone recorded by ProfileZone, times are nanoseconds since the start of the profiler.
+    /// </summary>
+    struct ProfileZoneEvent
+    {
+        const char *Name;
+        int64_t Start;
+        int64_t Duration;
+    };
+
+    /// <summary>
+    /// The counters of a finished frame.
+    /// </summary>
+    struct ProfileFrame
+    {
+        int64_t Start = 0;
+        int64_t Duration = 0;
+        std::array<size_t, (size_t)ProfileCounter::Count> Counters{};
+
+        __always_inline size_t Get(ProfileCounter counter) const { return Counters[(size_t)counter]; }
+    };
+
+    /// <summary>
+    /// Always compiled frame profiler.
+    /// Counters are relaxed atomic additions and always counted, the on screen overlay shows those of the last frame.
+    /// Zones are only recorded while the profiler is enabled, otherwise a ProfileZone costs a single atomic load.
+    /// Each thread writes its zones into its own ring buffer holding the last ZoneCapacity zones,
+    /// so recording does not contend with other threads. The buffers outlive their threads until Clear is called.
+    /// The recorded zones and frames can be written as Chrome trace event JSON, e.g. for chrome://tracing or Perfetto.
+    /// </summary>
+    class Profiler
+    {
+    public:
+        static constexpr size_t ZoneCapacity = 16384;
+        static constexpr size_t FrameCapacity = 256;
+
+    private:
+        struct ThreadBuffer
+        {
+            // only contended while the zones are written out
+            std::mutex Mutex;
+            std::array<ProfileZoneEvent, ZoneCapacity> Events;
+            size_t Written = 0;
+            unsigned int ThreadId = 0;
+        };
+
+        static std::atomic<bool> isEnabled;
+        static std::atomic<bool> isOverlayVisible;
+        static std::atomic<size_t> counters[(size_t)ProfileCounter::Count];
+
+        static std::mutex &GetMutex();
+        static std::vector<std::shared_ptr<ThreadBuffer>> &GetThreadBuffers();
+        static ThreadBuffer &GetThreadBuffer();
+
+        // guarded by GetMutex
+        static std::array<ProfileFrame, FrameCapacity> frames;
+        static size_t frameCount;
+        static int64_t frameStart;
+        static size_t frameStateChanges;
+
+    public:
+        /// <summary>
+        /// Gets the time in nanoseconds since the start of the profiler.
+        /// </summary>
+        static int64_t Now();
+
+        __always_inline static bool GetIsEnabled() { return isEnabled.load(std::memory_order_relaxed); }
+
+        /// <summary>
+        /// Starts or stops recording zones, the counters are always counted.
+        /// </summary>
+        static void SetIsEnabled(bool value);
+
+        __always_inline static bool GetIsOverlayVisible() { return isOverlayVisible.load(std::memory_order_relaxed); }
+        __always_inline static void SetIsOverlayVisible(bool value) { isOverlayVisible.store(value, std::memory_order_relaxed); }
+
+        /// <summary>
+        /// Adds to a counter of the current frame. Can be called on any thread.
+        /// </summary>
+        __always_inline static void Count(ProfileCounter counter, size_t value = 1)
+        {
+            counters[(size_t)counter].fetch_add(value, std::memory_order_relaxed);
+        }
+
+        /// <summary>
+        /// Records a zone into the ring buffer of the calling thread, see ProfileZone.
+        /// </summary>
+        static void AddZone(const char *name, int64_t start, int64_t end);
+
+        /// <summary>
+        /// Starts a frame, everything counted until EndFrame belongs to it.
+        /// </summary>
+        static void BeginFrame();
+
+        /// <summary>
+        /// Ends the frame started by BeginFrame and keeps its counters.
+        /// </summary>
+        static void EndFrame();
+
+        /// <summary>
+        /// Gets the counters of the last finished frame, all zero if there is none.
+        /// </summary>
+        static ProfileFrame GetLastFrame();
+
+        /// <summary>
+        /// Gets the number of frames finished since the start or the last Clear.
+        /// </summary>
+        static size_t GetFrameCount();
+
+        /// <summary>
+        /// Removes all zones and frames.
+        /// </summary>
+        static void Clear();
+
+        /// <summary>
+        /// Writes the recorded zones and the counters of the recorded frames as Chrome trace event JSON.
+        /// </summary>
+        static void WriteChromeTrace(std::ostream &stream);
+
+        /// <summary>
+        /// Writes the Chrome trace into a file.
+        /// </summary>
+        /// <returns>false if the file could not be written.</returns>
+        static bool WriteChromeTrace(const std::string &path);
+    };
+
+    /// <summary>
+    /// Records the time from its construction to its destruction as a zone of the Profiler.
+    /// The name must outlive the profiler, e.g. a string literal.
+    /// </summary>
+    class ProfileZone
+    {
+    private:
+        const char *name;
+        int64_t start;
+
+    public:
+        __always_inline explicit ProfileZone(const char *name)
+            : name(name),
+              start(Profiler::GetIsEnabled() ? Profiler::Now() : -1)
+        {
+        }
+
+        __always_inline ~ProfileZone()
+        {
+            if (start >= 0)
+                Profiler::AddZone(name, start, Profiler::Now());
+        }
+
+        ProfileZone(const ProfileZone &) = delete;
+        ProfileZone &operator=(const ProfileZone &) = delete;
+    };
+}
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+// Records the rest of the enclosing scope as a zone named name.
+#define PROFILE_ZONE(name) xit::OpenGL::ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+
+using namespace xit::OpenGL;
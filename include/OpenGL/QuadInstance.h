@@ -0,0 +1,25 @@
+#pragma once
+
+namespace xit::OpenGL
+{
+    /// <summary>
+    /// Per-instance data of a single rectangle drawn by Graphics.
+    /// The layout matches the instance attributes (location 1..8) of Shader.vert,
+    /// so a whole array of QuadInstance can be uploaded with a single buffer update.
+    /// </summary>
+    struct QuadInstance
+    {
+        float Rect[4];            // renderX, renderY, width, height (bottom left origin)
+        float Location[4];        // left, top (top left origin), z, rotation
+        float CornerRadius[4];    // top left, top right, bottom right, bottom left
+        float BorderThickness[4]; // left, top, right, bottom
+        float BackgroundColor[4];
+        float BorderColor[4];
+        float TextureParams[4];   // texture slot (-1 = none), texture channels, premultiplied alpha (1 = yes), unused
+        float TextureRect[4];     // texture coordinates inside the texture (left, top, right, bottom), see Texture::GetTextureRect
+    };
+
+    static_assert(sizeof(QuadInstance) == 32 * sizeof(float), "QuadInstance must be tightly packed");
+}
+
+using namespace xit::OpenGL;
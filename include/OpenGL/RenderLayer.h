@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstddef>
+#include <list>
+#include <OpenGL/Texture.h>
+
+#ifndef GLAD_INCLUDED
+#include <glad/glad.h>
+#define GLAD_INCLUDED
+#endif
+
+namespace xit::OpenGL
+{
+    /// <summary>
+    /// An offscreen texture holding the rendered content of a visual, see CacheMode::Layer.
+    /// The content is rendered once between Begin and End and composited as a single textured quad
+    /// with Graphics::DrawTexture until the visual changes.
+    /// Layers are stored with premultiplied alpha, so translucent content keeps its edges when it is composited.
+    /// All layers share a GPU memory budget, the least recently used layers are deleted when a new one does not fit.
+    /// Layers used in the current frame are never deleted, a layer which does not fit then is not created at all.
+    /// </summary>
+    class RenderLayer
+    {
+    public:
+        static constexpr size_t DefaultBudget = 64 * 1024 * 1024;
+
+    private:
+        static size_t budget;
+        static size_t usedBytes;
+        static size_t frame;
+        static RenderLayer *current;
+
+        // most recently used first
+        static std::list<RenderLayer *> &GetLayers();
+
+        const void *owner;
+        GLuint framebuffer;
+        Texture texture;
+        size_t lastUsedFrame;
+        bool isContentValid;
+
+        // restored by End
+        RenderLayer *parent;
+        GLuint previousFramebuffer;
+        int previousViewport[4];
+        int originX;
+        int originY;
+
+        RenderLayer(const void *owner);
+        ~RenderLayer();
+
+        bool Create(int width, int height);
+        static void Delete(std::list<RenderLayer *>::iterator layer);
+
+    public:
+        RenderLayer(const RenderLayer &) = delete;
+        RenderLayer &operator=(const RenderLayer &) = delete;
+
+        /// <summary>
+        /// Gets the layer of an owner and marks it as used in this frame.
+        /// A layer with another size is replaced by a new one, new layers have no valid content.
+        /// </summary>
+        /// <param name="owner">The visual the layer belongs to.</param>
+        /// <param name="width">The width in pixels.</param>
+        /// <param name="height">The height in pixels.</param>
+        /// <returns>The layer or nullptr if it does not fit into the budget, the owner has to render directly then.</returns>
+        static RenderLayer *Acquire(const void *owner, int width, int height);
+
+        /// <summary>
+        /// Deletes the layer of an owner if it has one.
+        /// </summary>
+        static void Release(const void *owner);
+
+        /// <summary>
+        /// Starts a new frame, layers used in earlier frames may be deleted to make room for new ones.
+        /// </summary>
+        static void BeginFrame();
+
+        /// <summary>
+        /// Sets the GPU memory all layers may use together and deletes the least recently used layers until they fit.
+        /// </summary>
+        static void SetBudget(size_t bytes);
+        __always_inline static size_t GetBudget() { return budget; }
+        __always_inline static size_t GetUsedBytes() { return usedBytes; }
+        __always_inline static size_t GetLayerCount() { return GetLayers().size(); }
+
+        __always_inline const Texture *GetTexture() const { return &texture; }
+        __always_inline int GetWidth() const { return texture.Width; }
+        __always_inline int GetHeight() const { return texture.Height; }
+        __always_inline size_t GetByteSize() const { return (size_t)texture.Width * (size_t)texture.Height * 4; }
+
+        __always_inline bool GetIsContentValid() const { return isContentValid; }
+        __always_inline void SetIsContentValid(bool value) { isContentValid = value; }
+
+        /// <summary>
+        /// Redirects the following draws into the layer and clears it. Layers may be nested.
+        /// </summary>
+        /// <param name="x">The left of the layer in OpenGL window coordinates.</param>
+        /// <param name="y">The bottom of the layer in OpenGL window coordinates.</param>
+        void Begin(int x, int y);
+
+        /// <summary>
+        /// Draws what is queued into the layer and returns to the previous target.
+        /// </summary>
+        void End();
+    };
+}
+
+using namespace xit::OpenGL;
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstddef>
+
+#ifndef GLAD_INCLUDED
+#include <glad/glad.h>
+#define GLAD_INCLUDED
+#endif
+
+namespace xit::OpenGL
+{
+    /// <summary>
+    /// Shadow copy of the OpenGL state used by the renderers.
+    /// All binds, blend and scissor changes go through it, calls which would not change anything
+    /// are dropped, so the renderers can bind what they need before every draw call without unbinding afterwards.
+    /// The state is never queried from OpenGL. Code changing it directly has to call Invalidate.
+    /// </summary>
+    class RenderState
+    {
+    public:
+        static constexpr int MaxTextureUnits = 16; // the minimum OpenGL 3.3 guarantees for fragment shaders
+
+    private:
+        static constexpr GLuint Unknown = ~0u;
+
+        static GLuint program;
+        static GLuint vertexArray;
+        static GLuint arrayBuffer;
+        static int activeTextureUnit;
+        static GLuint textures[MaxTextureUnits];
+        static int isBlendEnabled; // -1 unknown
+        static GLenum blendSource;
+        static GLenum blendDestination;
+        static GLenum blendSourceAlpha;
+        static GLenum blendDestinationAlpha;
+        static int isScissorEnabled; // -1 unknown
+        static int scissorBox[4];
+        static GLuint drawFramebuffer;
+        static int viewport[4];
+
+        static size_t stateChangeCount;
+        static size_t skippedChangeCount;
+
+    public:
+        /// <summary>
+        /// Forgets the whole state, the next call of each setter reaches OpenGL again.
+        /// Call it after a context was made current or foreign code changed the state.
+        /// </summary>
+        static void Invalidate();
+
+        static void UseProgram(GLuint programId);
+        static void BindVertexArray(GLuint vertexArrayId);
+
+        /// <summary>
+        /// Binds a buffer. Only GL_ARRAY_BUFFER is cached, the other targets are part of
+        /// the vertex array state or rarely used and always reach OpenGL.
+        /// </summary>
+        static void BindBuffer(GLenum target, GLuint bufferId);
+
+        static void ActiveTexture(int unit);
+
+        /// <summary>
+        /// Binds a 2D texture to the active texture unit.
+        /// </summary>
+        static void BindTexture(GLuint textureId);
+
+        /// <summary>
+        /// Binds a 2D texture to a texture unit, the unit becomes the active one if the binding changes.
+        /// </summary>
+        static void BindTexture(int unit, GLuint textureId);
+
+        static void SetBlend(bool enabled);
+        static void SetBlendFunc(GLenum source, GLenum destination);
+
+        /// <summary>
+        /// Sets different blend factors for the color and the alpha channel, e.g. to render premultiplied alpha into a RenderLayer.
+        /// </summary>
+        static void SetBlendFuncSeparate(GLenum source, GLenum destination, GLenum sourceAlpha, GLenum destinationAlpha);
+
+        static void SetScissorTest(bool enabled);
+
+        /// <summary>
+        /// Sets the scissor box in OpenGL window coordinates (origin bottom left).
+        /// </summary>
+        static void SetScissorBox(int x, int y, int width, int height);
+
+        /// <summary>
+        /// Binds a framebuffer and remembers the draw framebuffer, so a RenderLayer can return to it.
+        /// Framebuffer binds are rare, they always reach OpenGL.
+        /// </summary>
+        static void BindFramebuffer(GLenum target, GLuint framebufferId);
+
+        /// <summary>
+        /// Gets the framebuffer the following draws go to, 0 is the default framebuffer of the window.
+        /// </summary>
+        __always_inline static GLuint GetDrawFramebuffer() { return drawFramebuffer; }
+
+        static void SetViewport(int x, int y, int width, int height);
+
+        /// <summary>
+        /// Gets the viewport set last with SetViewport (x, y, width, height).
+        /// </summary>
+        __always_inline static const int *GetViewport() { return viewport; }
+
+        // delete the objects and clear the bindings which referenced them, OpenGL reuses the ids
+        static void DeleteProgram(GLuint programId);
+        static void DeleteVertexArray(GLuint vertexArrayId);
+        static void DeleteBuffer(GLuint bufferId);
+        static void DeleteTexture(GLuint textureId);
+        static void DeleteFramebuffer(GLuint framebufferId);
+
+        /// <summary>
+        /// Gets the number of state changes passed to OpenGL since the application started.
+        /// </summary>
+        __always_inline static size_t GetStateChangeCount() { return stateChangeCount; }
+
+        /// <summary>
+        /// Gets the number of state changes dropped because OpenGL already had that state.
+        /// </summary>
+        __always_inline static size_t GetSkippedChangeCount() { return skippedChangeCount; }
+    };
+}
+
+using namespace xit::OpenGL;
@@ -1,10 +1,13 @@
 ﻿#pragma once
 
+#include <cstring>
 #include <map>
+#include <vector>
 
 #include <Exceptions.h>
 #include <IO/IO.h>
 #include <OpenGL/Shaders/Shader.h>
+#include <OpenGL/RenderState.h>
 
 namespace xit::OpenGL
 {
@@ -16,11 +19,55 @@ namespace xit::OpenGL
         Shader *vertexShader;
         Shader *fragmentShader;
 
+        struct Uniform
+        {
+            int Location;
+            std::vector<unsigned char> Value; // the value sent last, empty if it is not known
+        };
+
+        /// <summary>
+        /// A mapping of uniform names to handles, the index of the uniform in uniforms.
+        /// Setting uniform data by name looks up the handle first, the renderers keep the handles.
+        /// </summary>
+        std::map<std::string, int> uniformNamesToHandles;
+        std::vector<Uniform> uniforms;
+
         /// <summary>
-        /// A mapping of uniform names to locations. This allows us to very easily specify
-        /// uniform data by name, quickly looking up the location first if needed.
+        /// Stores the value of a uniform. Returns false if the uniform does not exist
+        /// or already has this value, so it does not have to be sent again.
         /// </summary>
-        std::map<std::string, int> uniformNamesToLocations;
+        bool UpdateUniform(int handle, const void *value, size_t size)
+        {
+            if (handle < 0 || handle >= (int)uniforms.size())
+                return false;
+
+            Uniform &uniform = uniforms[(size_t)handle];
+
+            // not found or removed by the compiler, OpenGL would ignore it anyway
+            if (uniform.Location < 0)
+                return false;
+
+            if (uniform.Value.size() == size && std::memcmp(uniform.Value.data(), value, size) == 0)
+                return false;
+
+            const unsigned char *bytes = static_cast<const unsigned char *>(value);
+            uniform.Value.assign(bytes, bytes + size);
+
+            return true;
+        }
+
+        /// <summary>
+        /// Looks up the locations of all known uniforms again after linking, linking resets their values.
+        /// </summary>
+        void ResolveUniforms()
+        {
+            for (const std::pair<const std::string, int> &pair : uniformNamesToHandles)
+            {
+                Uniform &uniform = uniforms[(size_t)pair.second];
+                uniform.Location = glGetUniformLocation(shaderProgramObject, pair.first.c_str());
+                uniform.Value.clear();
+            }
+        }
 
         void CheckProgramObject()
         {
@@ -115,6 +162,8 @@ namespace xit::OpenGL
                 Logger::Log(LogLevel::Error, "ShaderProgram", "Failed to link shader program with ID " + std::to_string(shaderProgramObject) + ".\n" + GetInfoLog());
                 return false;
             }
+
+            ResolveUniforms();
             return true;
         }
 
@@ -163,6 +212,8 @@ namespace xit::OpenGL
                 Logger::Log(LogLevel::Error, "ShaderProgram", "Failed to link shader program with ID " + std::to_string(shaderProgramObject) + ".\n" + GetInfoLog());
                 return false;
             }
+
+            ResolveUniforms();
             return true;
         }
 
@@ -174,7 +225,7 @@ namespace xit::OpenGL
             vertexShader->Delete();
             fragmentShader->Delete();
 
-            glDeleteProgram(shaderProgramObject);
+            RenderState::DeleteProgram(shaderProgramObject);
 
             shaderProgramObject = 0;
         }
@@ -191,12 +242,12 @@ namespace xit::OpenGL
 
         __always_inline void Bind()
         {
-            glUseProgram(shaderProgramObject);
+            RenderState::UseProgram(shaderProgramObject);
         }
 
         __always_inline void Unbind()
         {
-            glUseProgram(0);
+            RenderState::UseProgram(0);
         }
 
         __always_inline bool GetLinkStatus()
@@ -237,73 +288,165 @@ namespace xit::OpenGL
             }
         }
 
+        __always_inline void SetUniform1(int handle, float v1)
+        {
+            if (UpdateUniform(handle, &v1, sizeof(v1)))
+                glUniform1f(uniforms[(size_t)handle].Location, v1);
+        }
+
+        __always_inline void SetUniform1(int handle, int count, const int *values)
+        {
+            if (UpdateUniform(handle, values, (size_t)count * sizeof(int)))
+                glUniform1iv(uniforms[(size_t)handle].Location, count, values);
+        }
+
+        __always_inline void SetUniform2(int handle, float v1, float v2)
+        {
+            float value[] = {v1, v2};
+            if (UpdateUniform(handle, value, sizeof(value)))
+                glUniform2f(uniforms[(size_t)handle].Location, v1, v2);
+        }
+
+        __always_inline void SetUniform2(int handle, int v1, int v2)
+        {
+            int value[] = {v1, v2};
+            if (UpdateUniform(handle, value, sizeof(value)))
+                glUniform2i(uniforms[(size_t)handle].Location, v1, v2);
+        }
+
+        __always_inline void SetUniform2(int handle, int count, const float *values)
+        {
+            if (UpdateUniform(handle, values, (size_t)count * 2 * sizeof(float)))
+                glUniform2fv(uniforms[(size_t)handle].Location, count, values);
+        }
+
+        __always_inline void SetUniform3(int handle, float v1, float v2, float v3)
+        {
+            float value[] = {v1, v2, v3};
+            if (UpdateUniform(handle, value, sizeof(value)))
+                glUniform3f(uniforms[(size_t)handle].Location, v1, v2, v3);
+        }
+
+        __always_inline void SetUniform3(int handle, int count, const float *values)
+        {
+            if (UpdateUniform(handle, values, (size_t)count * 3 * sizeof(float)))
+                glUniform3fv(uniforms[(size_t)handle].Location, count, values);
+        }
+
+        __always_inline void SetUniform4(int handle, float v1, float v2, float v3, float v4)
+        {
+            float value[] = {v1, v2, v3, v4};
+            if (UpdateUniform(handle, value, sizeof(value)))
+                glUniform4f(uniforms[(size_t)handle].Location, v1, v2, v3, v4);
+        }
+
+        __always_inline void SetUniform4(int handle, int v1, int v2, int v3, int v4)
+        {
+            int value[] = {v1, v2, v3, v4};
+            if (UpdateUniform(handle, value, sizeof(value)))
+                glUniform4i(uniforms[(size_t)handle].Location, v1, v2, v3, v4);
+        }
+
+        __always_inline void SetUniform4(int handle, int count, const float *values)
+        {
+            if (UpdateUniform(handle, values, (size_t)count * 4 * sizeof(float)))
+                glUniform4fv(uniforms[(size_t)handle].Location, count, values);
+        }
+
+        __always_inline void SetUniformMatrix3(int handle, const float *m)
+        {
+            if (UpdateUniform(handle, m, 9 * sizeof(float)))
+                glUniformMatrix3fv(uniforms[(size_t)handle].Location, 1, false, m);
+        }
+
+        __always_inline void SetUniformMatrix4(int handle, const float *m)
+        {
+            if (UpdateUniform(handle, m, 16 * sizeof(float)))
+                glUniformMatrix4fv(uniforms[(size_t)handle].Location, 1, false, m);
+        }
+
         __always_inline void SetUniform1(const std::string &uniformName, float v1)
         {
-            glUniform1f(GetUniformLocation(uniformName), v1);
+            SetUniform1(GetUniformHandle(uniformName), v1);
+        }
+
+        __always_inline void SetUniform1(const std::string &uniformName, int count, const int *values)
+        {
+            SetUniform1(GetUniformHandle(uniformName), count, values);
         }
 
         __always_inline void SetUniform2(const std::string &uniformName, float v1, float v2)
         {
-            glUniform2f(GetUniformLocation(uniformName), v1, v2);
+            SetUniform2(GetUniformHandle(uniformName), v1, v2);
         }
 
         __always_inline void SetUniform2(const std::string &uniformName, int v1, int v2)
         {
-            glUniform2i(GetUniformLocation(uniformName), v1, v2);
+            SetUniform2(GetUniformHandle(uniformName), v1, v2);
         }
 
         __always_inline void SetUniform2(const std::string &uniformName, int count, const float *values)
         {
-            glUniform2fv(GetUniformLocation(uniformName), count, values);
+            SetUniform2(GetUniformHandle(uniformName), count, values);
         }
 
         __always_inline void SetUniform3(const std::string &uniformName, float v1, float v2, float v3)
         {
-            glUniform3f(GetUniformLocation(uniformName), v1, v2, v3);
+            SetUniform3(GetUniformHandle(uniformName), v1, v2, v3);
         }
-        __always_inline void SetUniform3(const std::string &uniformName, int count, float *values)
+
+        __always_inline void SetUniform3(const std::string &uniformName, int count, const float *values)
         {
-            glUniform3fv(GetUniformLocation(uniformName), count, values);
+            SetUniform3(GetUniformHandle(uniformName), count, values);
         }
 
         __always_inline void SetUniform4(const std::string &uniformName, float v1, float v2, float v3, float v4)
         {
-            glUniform4f(GetUniformLocation(uniformName), v1, v2, v3, v4);
+            SetUniform4(GetUniformHandle(uniformName), v1, v2, v3, v4);
         }
+
         __always_inline void SetUniform4(const std::string &uniformName, int v1, int v2, int v3, int v4)
         {
-            glUniform4i(GetUniformLocation(uniformName), v1, v2, v3, v4);
+            SetUniform4(GetUniformHandle(uniformName), v1, v2, v3, v4);
         }
+
         __always_inline void SetUniform4(const std::string &uniformName, int count, const float *values)
         {
-            glUniform4fv(GetUniformLocation(uniformName), count, values);
+            SetUniform4(GetUniformHandle(uniformName), count, values);
         }
 
         __always_inline void SetUniformMatrix3(const std::string &uniformName, const float *m)
         {
-            glUniformMatrix3fv(GetUniformLocation(uniformName), 1, false, m);
+            SetUniformMatrix3(GetUniformHandle(uniformName), m);
         }
 
         __always_inline void SetUniformMatrix4(const std::string &uniformName, const float *m)
         {
-            glUniformMatrix4fv(GetUniformLocation(uniformName), 1, false, m);
+            SetUniformMatrix4(GetUniformHandle(uniformName), m);
         }
 
-        __always_inline int GetUniformLocation(const std::string &uniformName)
+        /// <summary>
+        /// Gets the handle of a uniform for the SetUniform overloads taking a handle.
+        /// The name is only looked up once, keep the handle instead of passing the name on every draw.
+        /// The handle stays valid when the program is linked again.
+        /// </summary>
+        int GetUniformHandle(const std::string &uniformName)
         {
-            //  If we don't have the uniform name in the dictionary, get it's
-            //  location and add it.
-            int &location = uniformNamesToLocations[uniformName];
+            auto found = uniformNamesToHandles.find(uniformName);
 
-            if (location == 0)
-            {
-                location = glGetUniformLocation(shaderProgramObject, uniformName.c_str());
-                //uniformNamesToLocations.emplace(uniformName, location);
-                //  TODO: if it's not found, we should probably throw an exception.
-            }
+            if (found != uniformNamesToHandles.end())
+                return found->second;
+
+            int handle = (int)uniforms.size();
+            uniforms.push_back({glGetUniformLocation(shaderProgramObject, uniformName.c_str()), {}});
+            uniformNamesToHandles.emplace(uniformName, handle);
 
-            //  Return the uniform location.
-            return location;
+            return handle;
+        }
+
+        __always_inline int GetUniformLocation(const std::string &uniformName)
+        {
+            return uniforms[(size_t)GetUniformHandle(uniformName)].Location;
         }
     };
 }
@@ -15,14 +15,16 @@ namespace xit::OpenGL
     struct Character
     {
     public:
-        GLuint TextureID; // ID handle of the glyph texture
-        Size GlyphSize;   // Size of glyph
+        GLuint TextureID;    // ID handle of the glyph atlas texture
+        Point AtlasPosition; // Top left position of the glyph bitmap in the atlas
+        Size GlyphSize;      // Size of glyph
         Point Bearing;    // Offset from baseline to left/top of glyph
         int Advance;      // Offset to advance to next glyph
         float *Buffer;    // Storage for vertex data so we dont have to create it over and over again
 
         Character()
             : TextureID(UINT32_MAX),
+              AtlasPosition(0, 0),
               GlyphSize(0, 0),
               Bearing(0, 0),
               Advance(0),
@@ -32,6 +34,7 @@ namespace xit::OpenGL
 
         Character(const Character &other)
             : TextureID(other.TextureID),
+              AtlasPosition(other.AtlasPosition),
               GlyphSize(other.GlyphSize),
               Bearing(other.Bearing),
               Advance(other.Advance),
@@ -1,155 +1,243 @@
 ﻿#pragma once
 
-#include <map>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
 #include <MathHelper.h>
 
 #include <IO/IO.h>
 #include <OpenGL/Text/Character.h>
+#include <OpenGL/Text/FontFace.h>
+#include <OpenGL/Text/GlyphAtlas.h>
 #include <Drawing/Size.h>
 
-#include <ft2build.h>
-#include FT_FREETYPE_H
-
-#ifdef DEBUG_FONT_PERFORMANCE
-#include <chrono>
-#include <iostream>
-#endif
+#include <OpenGL/Profiler.h>
 
 namespace xit::OpenGL
 {
-    class CharacterList : public std::map<char, Character>
+    /// <summary>
+    /// The state of the font face of a CharacterList, a font which failed to load is not loaded again.
+    /// </summary>
+    enum class FontLoadState
     {
+        NotLoaded,
+        Loaded,
+        Failed
+    };
+
+    /// <summary>
+    /// The state of a single glyph of a CharacterList.
+    /// </summary>
+    enum class GlyphState : uint8_t
+    {
+        NotLoaded,
+        Loaded,  // the bitmap is in the atlas
+        Evicted, // the atlas was full and evicted the bitmap, the advance is still known
+        Missing  // the font has no glyph for the character or it does not fit into the atlas, it is not loaded again
+    };
+
+    /// <summary>
+    /// The glyphs of a font in a single size.
+    /// Text is measured and rendered byte wise, so the glyphs are a table directly indexed by the byte.
+    /// The advances are kept in a separate array, measuring a line only sums them up.
+    /// </summary>
+    class CharacterList
+    {
+    public:
+        static constexpr size_t GlyphCount = 256;
+
     private:
         int fontHeight;
+        // extent of the glyphs above and below the baseline, grows like fontHeight when a glyph exceeds it
+        int ascent;
+        int descent;
         std::string fontName;
         int fontSize;
-        FT_Library library;
+        // the face is shared by all sizes of the font, both are owned by the FontFace
         FT_Face face;
-        bool initialized;
+        FT_Size size;
+        FontLoadState loadState;
+        GlyphAtlas atlas;
+
+        std::array<Character, GlyphCount> characters;
+        std::array<GlyphState, GlyphCount> glyphStates{};
+        alignas(64) std::array<int, GlyphCount> advances{};
+
+        __always_inline static size_t Index(char c) { return (unsigned char)c; }
+
+        // sums the advances of a line, the loop has no branches so the compiler can vectorize it
+        __always_inline int SumAdvances(const unsigned char *text, size_t length) const
+        {
+            int width = 0;
+
+            for (size_t i = 0; i < length; i++)
+                width += advances[text[i]];
+
+            return width;
+        }
 
     public:
         CharacterList()
             : fontHeight(12),
+              ascent(12),
+              descent(0),
               fontName(""),
               fontSize(12),
-              library(nullptr),
               face(nullptr),
-              initialized(false)
+              size(nullptr),
+              loadState(FontLoadState::NotLoaded)
         {
         }
 
-        CharacterList(const CharacterList &other)
-            : std::map<char, Character>(other),
-              fontName(other.fontName),
-              fontSize(other.fontSize),
-              library(other.library),
-              face(other.face),
-              initialized(other.initialized)
-        {
-            fontHeight = other.fontHeight;
+        // the list owns its atlas and FontHandles point at it, it stays in its FontStorage node
+        CharacterList(const CharacterList &) = delete;
+        CharacterList &operator=(const CharacterList &) = delete;
 
-            for (std::pair<char, Character> existing : other)
-            {
-                emplace(existing);
-            }
-        }
+        /// <summary>
+        /// Gets the height of a line, it grows while characters are loaded.
+        /// </summary>
+        __always_inline int GetFontHeight() const { return fontHeight; }
+
+        /// <summary>
+        /// Gets how far the glyphs of a line reach above the baseline.
+        /// </summary>
+        __always_inline int GetAscent() const { return ascent; }
+
+        /// <summary>
+        /// Gets how far the glyphs of a line reach below the baseline.
+        /// </summary>
+        __always_inline int GetDescent() const { return descent; }
+
+        bool IsInitialized() const { return loadState == FontLoadState::Loaded; }
+        FontLoadState GetLoadState() const { return loadState; }
+
+        /// <summary>
+        /// Gets the atlas holding the bitmaps of all loaded characters.
+        /// </summary>
+        const GlyphAtlas &GetAtlas() const { return atlas; }
 
-        ~CharacterList()
+        __always_inline GlyphState GetGlyphState(char c) const { return glyphStates[Index(c)]; }
+
+        /// <summary>
+        /// Gets if the bitmap of a character has to be loaded before it can be rendered.
+        /// </summary>
+        __always_inline bool NeedsLoad(char c) const
         {
-            if (initialized)
-            {
-                if (face)
-                    FT_Done_Face(face);
+            GlyphState state = glyphStates[Index(c)];
+            return state == GlyphState::NotLoaded || state == GlyphState::Evicted;
+        }
 
-                if (library)
-                    FT_Done_FreeType(library);
-            }
+        /// <summary>
+        /// Gets a loaded character, nullptr if it is not loaded or missing. Never loads or inserts anything.
+        /// </summary>
+        __always_inline const Character *Find(char c) const
+        {
+            return glyphStates[Index(c)] == GlyphState::Loaded ? &characters[Index(c)] : nullptr;
         }
 
-        CharacterList &operator=(const CharacterList &other)
+        /// <summary>
+        /// Gets the advance of a character, 0 if it was never loaded or is missing in the font.
+        /// </summary>
+        __always_inline int GetAdvance(char c) const { return advances[Index(c)]; }
+
+        /// <summary>
+        /// Gets the advances of all characters, indexed by the byte.
+        /// </summary>
+        __always_inline const std::array<int, GlyphCount> &GetAdvances() const { return advances; }
+
+        /// <summary>
+        /// Loads the characters of a text which were never loaded, afterwards all advances of the text are known.
+        /// </summary>
+        void LoadAdvances(const std::string &text) { LoadAdvances(text.data(), text.length()); }
+
+        void LoadAdvances(const char *text, size_t length)
         {
-            fontHeight = other.fontHeight;
+            const unsigned char *data = (const unsigned char *)text;
 
-            for (std::pair<char, Character> existing : other)
+            // only the advance is needed, evicted glyphs are not loaded again
+            for (size_t i = 0; i < length; i++)
             {
-                emplace(existing);
+                if (glyphStates[data[i]] == GlyphState::NotLoaded && data[i] != '\n')
+                    LoadSingleCharacter((char)data[i]);
             }
-            return *this;
         }
 
-        const int FontHeight = fontHeight;
-
         void LoadSingleCharacter(char c)
         {
-            if (!initialized)
+            if (loadState != FontLoadState::Loaded)
             {
                 Logger::Log(LogLevel::Error, "CharacterList.LoadSingleCharacter", "Font not initialized");
                 return;
             }
 
-#ifdef DEBUG_FONT_PERFORMANCE
-            auto start = std::chrono::high_resolution_clock::now();
-#endif
+            PROFILE_ZONE("CharacterList::LoadSingleCharacter");
+
+            size_t index = Index(c);
+
+            // the face renders at the size which is active
+            FT_Activate_Size(size);
 
             FT_Error result;
             // load character glyph
-            if ((result = FT_Load_Char(face, c, FT_LOAD_RENDER)) != FT_Err_Ok)
+            if ((result = FT_Load_Char(face, (FT_ULong)index, FT_LOAD_RENDER)) != FT_Err_Ok)
             {
                 Logger::Log(LogLevel::Error, "CharacterList.LoadSingleCharacter", "Failed to load Glyph %c", c);
+                glyphStates[index] = GlyphState::Missing;
+                advances[index] = 0;
                 return;
             }
 
-            // generate texture
-            uint textureId = 0;
-            glGenTextures(1, &textureId);
-            glBindTexture(GL_TEXTURE_2D, textureId);
-            glTexImage2D(
-                GL_TEXTURE_2D,
-                0,
-                GL_RED,
-                (int)face->glyph->bitmap.width,
-                (int)face->glyph->bitmap.rows,
-                0,
-                GL_RED,
-                GL_UNSIGNED_BYTE,
-                face->glyph->bitmap.buffer);
-            // set texture options
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, (int)GL_CLAMP_TO_EDGE);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, (int)GL_CLAMP_TO_EDGE);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, (int)GL_LINEAR);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, (int)GL_LINEAR);
+            advances[index] = static_cast<int>(face->glyph->advance.x >> 6);
+
+            // copy the bitmap into the atlas
+            size_t generation = atlas.GetGeneration();
+            Point atlasPosition;
+
+            if (!atlas.Add(face->glyph->bitmap.buffer,
+                           (int)face->glyph->bitmap.width,
+                           (int)face->glyph->bitmap.rows,
+                           face->glyph->bitmap.pitch,
+                           atlasPosition))
+            {
+                // the advance is kept, measuring and rendering still leave the space of the glyph
+                Logger::Log(LogLevel::Error, "CharacterList.LoadSingleCharacter", "Glyph %c does not fit into the atlas", c);
+                glyphStates[index] = GlyphState::Missing;
+                return;
+            }
+
+            // the atlas was full and evicted everything, the other characters are reloaded on demand
+            if (generation != atlas.GetGeneration())
+            {
+                for (GlyphState &state : glyphStates)
+                {
+                    if (state == GlyphState::Loaded)
+                        state = GlyphState::Evicted;
+                }
+            }
 
             // now store character for later use
-            Character character;
-            character.TextureID = textureId;
+            Character &character = characters[index];
+            character.TextureID = atlas.GetTextureId();
+            character.AtlasPosition = atlasPosition;
             character.GlyphSize.SetWidth((int)face->glyph->bitmap.width);
             character.GlyphSize.SetHeight((int)face->glyph->bitmap.rows);
 
             character.Bearing.X = face->glyph->bitmap_left;
             character.Bearing.Y = face->glyph->bitmap_top;
 
-            character.Advance = static_cast<int>(face->glyph->advance.x >> 6);
+            character.Advance = advances[index];
 
             int charHeight = character.GlyphSize.GetHeight();
             fontHeight = charHeight > fontHeight ? charHeight : fontHeight;
+            ascent = std::max(ascent, character.Bearing.Y);
+            descent = std::max(descent, charHeight - character.Bearing.Y);
 
-            emplace(std::make_pair(c, character));
-
-            glBindTexture(GL_TEXTURE_2D, 0);
-
-#ifdef DEBUG_FONT_PERFORMANCE
-            auto end = std::chrono::high_resolution_clock::now();
-            auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
-            std::cout << "CharacterList::LoadSingleCharacter - Character '" << c << "' loaded in " << duration.count() << "μs" << std::endl;
-#endif
+            glyphStates[index] = GlyphState::Loaded;
         }
 
         void Measure(const std::string &text, Size &target)
         {
-#ifdef DEBUG_FONT_PERFORMANCE
-            auto start = std::chrono::high_resolution_clock::now();
-#endif
-
             if (text.empty())
             {
                 target.SetWidth(0);
@@ -157,125 +245,61 @@ namespace xit::OpenGL
                 return;
             }
 
-            // SizeF size = new SizeF(0, FontHeight);
-            int width = 0;
-            // float height = 0;
+            LoadAdvances(text);
 
-            size_t len = text.length();
+            const unsigned char *data = (const unsigned char *)text.data();
+            size_t length = text.length();
 
+            int width = 0;
             int rows = 1;
-            int rowWidth = 0;
+            const unsigned char *row = data;
+            const unsigned char *end = data + length;
 
-            // iterate through all characters
-            for (size_t i = 0; i < len; i++)
+            // sum each row on its own, the widest row is the width
+            while (const unsigned char *newLine = (const unsigned char *)memchr(row, '\n', (size_t)(end - row)))
             {
-                try
-                {
-                    char c = text[i];
-
-                    // Lazy loading: only create character if it doesn't exist
-                    if (find(c) == end())
-                    {
-#ifdef DEBUG_FONT_PERFORMANCE
-                        std::cout << "CharacterList::Measure - Lazy loading character '" << c << "' (ASCII " << (int)c << ")" << std::endl;
-#endif
-                        LoadSingleCharacter(c);
-                    }
-
-                    Character ch = operator[](c);
-                    // if (TryGetValue(text[i], ch))
-                    {
-                        if (text[i] == '\n')
-                        {
-                            rows++;
-                            width = rowWidth > width ? rowWidth : width;
-                            rowWidth = 0;
-                            continue;
-                        }
-
-                        rowWidth += ch.Advance;
-
-                        // float tmp = ch->GlyphSize.GetHeight() - (ch->GlyphSize.GetHeight() - ch->Bearing.Y);
-
-                        /*          if (tmp > height)
-                                  {
-                                      height = tmp;
-                                  }*/
-
-                        // if (i < text.Length - 1)
-                        //     size.GetWidth() += (ch.Advance - size.GetWidth());
-                    }
-                }
-                catch (...)
-                {
-                    Logger::Log(LogLevel::Error, "CharacterList", "Could not find character [%s] in character list", text[i]);
-                }
+                int rowWidth = SumAdvances(row, (size_t)(newLine - row));
+                width = rowWidth > width ? rowWidth : width;
+
+                rows++;
+                row = newLine + 1;
             }
 
+            int rowWidth = SumAdvances(row, (size_t)(end - row));
             width = rowWidth > width ? rowWidth : width;
 
             target.SetWidth(width);
             target.SetHeight(fontHeight * rows);
-
-#ifdef DEBUG_FONT_PERFORMANCE
-            auto end = std::chrono::high_resolution_clock::now();
-            auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
-            std::cout << "CharacterList::Measure - Text '" << text << "' measured in " << duration.count()
-                      << "μs, result: " << target.GetWidth() << "x" << target.GetHeight() << std::endl;
-#endif
         }
 
-        static void Create(const std::string &fontName, int fontSize, CharacterList &destination)
+        /// <summary>
+        /// Creates the list of a size of an opened font face, see FontStorage.
+        /// </summary>
+        static void Create(FontFace &fontFace, const std::string &fontName, int fontSize, CharacterList &destination)
         {
-#ifdef DEBUG_FONT_PERFORMANCE
-            auto totalStart = std::chrono::high_resolution_clock::now();
-            std::cout << "CharacterList::Create - Initializing font '" << fontName << "' size " << fontSize << " (lazy loading)" << std::endl;
-#endif
-
-            if (FT_Init_FreeType(&destination.library))
-            {
-                Logger::Log(LogLevel::Error, "CharacterList.Create", "Could not init FreeType Library");
-                return;
-            }
-
-#ifdef DEBUG_FONT_PERFORMANCE
-            auto initEnd = std::chrono::high_resolution_clock::now();
-            auto initDuration = std::chrono::duration_cast<std::chrono::microseconds>(initEnd - totalStart);
-            std::cout << "CharacterList::Create - FreeType init took " << initDuration.count() << "μs" << std::endl;
-#endif
+            destination.face = fontFace.GetFace();
+            destination.size = fontFace.CreateSize(fontSize);
 
-            FT_Error result;
-            if (((result = FT_New_Face(destination.library, fontName.c_str(), 0, &destination.face)) != FT_Err_Ok))
+            if (!destination.size)
             {
-                Logger::Log(LogLevel::Error, "CharacterList.Create", "Failed to load font. Error code: %d", result);
-                FT_Done_FreeType(destination.library);
+                Logger::Log(LogLevel::Error, "CharacterList.Create", "Failed to create size %d of font %s", fontSize, fontName.c_str());
+                destination.face = nullptr;
+                destination.loadState = FontLoadState::Failed;
                 return;
             }
-            else
-            {
-                FT_Set_Pixel_Sizes(destination.face, 0, (uint)fontSize);
-            }
-
-#ifdef DEBUG_FONT_PERFORMANCE
-            auto faceEnd = std::chrono::high_resolution_clock::now();
-            auto faceDuration = std::chrono::duration_cast<std::chrono::microseconds>(faceEnd - initEnd);
-            std::cout << "CharacterList::Create - Font face loading took " << faceDuration.count() << "μs" << std::endl;
-#endif
 
             glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // disable byte-alignment restriction
 
             // Store font info for lazy loading
             destination.fontName = fontName;
             destination.fontSize = fontSize;
-            destination.initialized = true;
+            destination.loadState = FontLoadState::Loaded;
             destination.fontHeight = fontSize; // Initial estimate, will be updated as characters are loaded
 
-#ifdef DEBUG_FONT_PERFORMANCE
-            auto totalEnd = std::chrono::high_resolution_clock::now();
-            auto totalDuration = std::chrono::duration_cast<std::chrono::microseconds>(totalEnd - totalStart);
-            std::cout << "CharacterList::Create - Font initialization completed in " << totalDuration.count()
-                      << "μs (characters will be loaded on-demand)" << std::endl;
-#endif
+            // the metrics are in 26.6 fixed point, the descender is negative
+            const FT_Size_Metrics &metrics = destination.size->metrics;
+            destination.ascent = (int)((metrics.ascender + 63) >> 6);
+            destination.descent = (int)((-metrics.descender + 63) >> 6);
         }
     };
 }
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include FT_SIZES_H
+
+namespace xit::OpenGL
+{
+    /// <summary>
+    /// A font file mapped into memory and opened once as FreeType face.
+    /// All sizes of the font share the face, every CharacterList has its own FT_Size on it, see CreateSize.
+    /// Like the glyph atlas, faces are only used on the render thread, FreeType faces are not thread safe.
+    /// </summary>
+    class FontFace
+    {
+    private:
+        void *data;
+        size_t dataSize;
+        FT_Face face;
+
+        void Close();
+
+    public:
+        FontFace();
+        ~FontFace();
+
+        FontFace(const FontFace &) = delete;
+        FontFace &operator=(const FontFace &) = delete;
+
+        __always_inline bool IsOpen() const { return face != nullptr; }
+        __always_inline FT_Face GetFace() const { return face; }
+
+        /// <summary>
+        /// Maps the font file and opens the face on the mapped memory.
+        /// </summary>
+        /// <returns>false if the file could not be mapped or is not a font.</returns>
+        bool Open(FT_Library library, const std::string &fileName);
+
+        /// <summary>
+        /// Creates a size of the face with the given pixel height, it is freed together with the face.
+        /// </summary>
+        /// <returns>nullptr if the size could not be created.</returns>
+        FT_Size CreateSize(int pixelSize);
+    };
+}
+
+using namespace xit::OpenGL;
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <OpenGL/Text/CharacterList.h>
+
+namespace xit::OpenGL
+{
+    /// <summary>
+    /// A font resolved once by FontStorage::Resolve. It points directly at the CharacterList of a font name and size,
+    /// so measuring and rendering text with it does not look up the font again.
+    /// A handle stays valid until FontStorage::Clear, see FontStorage::IsCurrent.
+    /// </summary>
+    class FontHandle
+    {
+    private:
+        CharacterList *characterList;
+        size_t generation;
+
+    public:
+        FontHandle()
+            : characterList(nullptr),
+              generation(0)
+        {
+        }
+
+        FontHandle(CharacterList *characterList, size_t generation)
+            : characterList(characterList),
+              generation(generation)
+        {
+        }
+
+        bool operator==(const FontHandle &other) const = default;
+
+        __always_inline size_t GetGeneration() const { return generation; }
+
+        __always_inline bool IsResolved() const { return characterList != nullptr; }
+
+        /// <summary>
+        /// Gets if the font face was loaded. A font which failed to load stays resolved but is not loaded again.
+        /// </summary>
+        __always_inline bool IsInitialized() const { return characterList && characterList->IsInitialized(); }
+
+        __always_inline CharacterList &GetCharacterList() const { return *characterList; }
+
+        /// <summary>
+        /// Measures a text, the size is empty if the font is not loaded.
+        /// </summary>
+        void Measure(const std::string &text, Size &target) const
+        {
+            if (!IsInitialized())
+            {
+                target.SetWidth(0);
+                target.SetHeight(0);
+                return;
+            }
+
+            characterList->Measure(text, target);
+        }
+    };
+}
+
+using namespace xit::OpenGL;
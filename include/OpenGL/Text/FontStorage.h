@@ -2,6 +2,7 @@
 
 #include <map>
 #include <OpenGL/Text/CharacterList.h>
+#include <OpenGL/Text/FontHandle.h>
 
 namespace xit::OpenGL
 {
@@ -12,16 +13,37 @@ namespace xit::OpenGL
         {
         public:
             FontSizeCharacterList();
-            FontSizeCharacterList(const FontSizeCharacterList& other);
+            FontSizeCharacterList(const FontSizeCharacterList& other) = delete;
 
-            FontSizeCharacterList& operator=(const FontSizeCharacterList& other);
+            FontSizeCharacterList& operator=(const FontSizeCharacterList& other) = delete;
 
             bool operator==(const FontSizeCharacterList& other) const = default;
         };
 
         static std::map<std::string, FontSizeCharacterList>& GetFontStorageMap();
+        static std::map<std::string, FontFace>& GetFontFaceMap();
+
+        // one FreeType library for the process, nullptr if FreeType could not be initialized
+        static FT_Library GetLibrary();
+
+        // faces which failed to open are kept closed, the file is not opened again
+        static FontFace& FindOrOpenFace(const std::string& fontName);
+
+        // incremented by Clear, handles of an older generation point at removed lists
+        static size_t generation;
 
     public:
+        /// <summary>
+        /// Finds or creates the font and returns a handle pointing at its CharacterList.
+        /// The font file is loaded with the first call only, also if loading failed.
+        /// </summary>
+        static FontHandle Resolve(const std::string& fontName, int fontSize);
+
+        /// <summary>
+        /// Gets if a handle was resolved and is not invalidated by Clear.
+        /// </summary>
+        static bool IsCurrent(const FontHandle& handle) { return handle.IsResolved() && handle.GetGeneration() == generation; }
+
         static CharacterList& FindOrCreate(const std::string& fontName, int fontSize);
 
         static void Clear();
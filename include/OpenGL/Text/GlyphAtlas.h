@@ -0,0 +1,96 @@
+#pragma once
+
+#include <vector>
+#include <Input/Point.h>
+
+#ifndef GLAD_INCLUDED
+#include <glad/glad.h>
+#define GLAD_INCLUDED
+#endif
+
+namespace xit::OpenGL
+{
+    /// <summary>
+    /// A single GL_RED texture holding the glyph bitmaps of one font and size.
+    /// Glyphs are packed into shelves (rows of glyphs with similar height).
+    /// When the atlas is full it doubles its height up to MaxHeight, glyph positions stay valid.
+    /// When it can not grow any more all glyphs are evicted and the generation is incremented,
+    /// the owner has to reload the glyphs it still needs.
+    /// </summary>
+    class GlyphAtlas
+    {
+    public:
+        static constexpr int Width = 512;
+        static constexpr int InitialHeight = 128;
+        static constexpr int MaxHeight = 2048;
+        static constexpr int Padding = 1;
+
+    private:
+        struct Shelf
+        {
+            int Top;
+            int Height;
+            int Used;
+        };
+
+        GLuint textureId;
+        int height;
+        int usedHeight;
+        size_t generation;
+        std::vector<Shelf> shelves;
+        std::vector<unsigned char> pixels; // CPU copy, needed to re-upload the texture when it grows
+
+        static size_t evictionCount;
+
+        void CreateTexture();
+        bool Allocate(int glyphWidth, int glyphHeight, int &x, int &y);
+        bool Grow();
+        void Reset();
+
+    public:
+        GlyphAtlas();
+        ~GlyphAtlas();
+
+        // the texture and the pixels belong to one atlas
+        GlyphAtlas(const GlyphAtlas &) = delete;
+        GlyphAtlas &operator=(const GlyphAtlas &) = delete;
+
+        /// <summary>
+        /// Gets the OpenGL texture id or 0 if no glyph has been added yet.
+        /// </summary>
+        __always_inline GLuint GetTextureId() const { return textureId; }
+
+        /// <summary>
+        /// Gets the current height of the texture in pixels.
+        /// </summary>
+        __always_inline int GetHeight() const { return height; }
+
+        /// <summary>
+        /// Gets the number of evictions. Positions returned by Add before the last eviction are invalid.
+        /// </summary>
+        __always_inline size_t GetGeneration() const { return generation; }
+
+        /// <summary>
+        /// Gets the number of evictions of all atlases. Recorded glyphs are invalid once it changes.
+        /// </summary>
+        __always_inline static size_t GetEvictionCount() { return evictionCount; }
+
+        /// <summary>
+        /// Copies a glyph bitmap into the atlas.
+        /// </summary>
+        /// <param name="bitmap">The 8 bit glyph bitmap, first row is the top of the glyph.</param>
+        /// <param name="glyphWidth">The width of the bitmap in pixels.</param>
+        /// <param name="glyphHeight">The height of the bitmap in pixels.</param>
+        /// <param name="pitch">The number of bytes per bitmap row.</param>
+        /// <param name="position">Receives the top left position of the glyph in the atlas.</param>
+        /// <returns>false if the glyph does not fit into an empty atlas.</returns>
+        bool Add(const unsigned char *bitmap, int glyphWidth, int glyphHeight, int pitch, Point &position);
+
+        /// <summary>
+        /// Deletes the texture. Only call this while the OpenGL context is current.
+        /// </summary>
+        void Destroy();
+    };
+}
+
+using namespace xit::OpenGL;
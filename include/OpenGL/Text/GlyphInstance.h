@@ -0,0 +1,20 @@
+#pragma once
+
+namespace xit::OpenGL
+{
+    /// <summary>
+    /// Per-instance data of a single glyph drawn by TextRenderer.
+    /// The layout matches the instance attributes (location 1..4) of TextShader.vert.
+    /// </summary>
+    struct GlyphInstance
+    {
+        float Rect[4];      // left, bottom, width, height (bottom left origin)
+        float AtlasRect[4]; // left, top, width, height of the glyph bitmap in the atlas in pixels
+        float Color[4];
+        float Z;
+    };
+
+    static_assert(sizeof(GlyphInstance) == 13 * sizeof(float), "GlyphInstance must be tightly packed");
+}
+
+using namespace xit::OpenGL;
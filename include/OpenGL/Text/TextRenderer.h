@@ -1,24 +1,59 @@
 ﻿#pragma once
 
+#include <vector>
 #include <IO/IO.h>
 #include <glm.hpp>
 
 #include <OpenGL/Shaders/ShaderProgram.h>
-#include <OpenGL/AttributeBuffer/AttributeBufferList.h>
+#include <OpenGL/VertexBuffers/VertexBuffer.h>
+#include <OpenGL/VertexBuffers/VertexBufferArray.h>
+#include <OpenGL/VertexBuffers/InstanceBuffer.h>
+#include <OpenGL/Text/GlyphInstance.h>
+#include <OpenGL/Text/FontHandle.h>
 
 namespace xit::OpenGL
 {
+    /// <summary>
+    /// Batched text renderer.
+    /// RenderText queues one GlyphInstance per character, consecutive text runs using the same
+    /// glyph atlas are drawn together with a single instanced draw call when Flush is called.
+    /// Graphics::Flush flushes the text batch too.
+    /// While a RenderCommandList is recording, RenderText appends the glyphs to it instead.
+    /// </summary>
     class TextRenderer
     {
+    public:
+        static constexpr int MaxGlyphs = 8192;
+
     private:
         static bool isInitialized;
         static ShaderProgram* textShader;
-        static AttributeBufferList* attributeBufferList;
-        static AttributeBuffer* vertexDataBuffer;
-        static AttributeBuffer* texCoordsDataBuffer;
+        static VertexBufferArray* vertexBufferArray;
+        static VertexBuffer* cornerDataBuffer;
+        static InstanceBuffer* instanceDataBuffer;
+        static int projectionUniform; // handle of textShader, resolved once in Initialize
+
+        static std::vector<GlyphInstance> glyphs;
+        static GLuint atlasTexture;
 
     public:
         static void Initialize();
         static void RenderText(const std::string& fontName, int fontSize, const std::string& text, int x, int y, int z, glm::vec4& color);
+
+        /// <summary>
+        /// Renders a text with a resolved font, see FontStorage::Resolve.
+        /// </summary>
+        static void RenderText(const FontHandle& font, const std::string& text, int x, int y, int z, glm::vec4& color);
+
+        /// <summary>
+        /// Queues glyphs recorded by RenderText into a RenderCommandList.
+        /// </summary>
+        /// <param name="texture">The glyph atlas the glyphs were recorded with.</param>
+        static void QueueGlyphs(GLuint texture, const GlyphInstance* instances, size_t count);
+
+        /// <summary>
+        /// Draws all queued glyphs with one instanced draw call.
+        /// </summary>
+        static void Flush();
     };
 }
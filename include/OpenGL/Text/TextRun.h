@@ -0,0 +1,97 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include <OpenGL/Text/FontHandle.h>
+
+namespace xit::OpenGL
+{
+    /// <summary>
+    /// A text measured once with a font. It keeps the x position of every caret position and the start of every line,
+    /// so caret positions and selection extents are lookups and hit testing is a binary search.
+    /// The run is reused until Invalidate is called for a new text or the font changed.
+    /// </summary>
+    class TextRun
+    {
+    private:
+        FontHandle font;
+        bool isValid;
+
+        // offsets[i] is the x of the caret in front of character i relative to the start of its line, size is length + 1
+        std::vector<int> offsets;
+        // index of the first character of every line
+        std::vector<size_t> lineStarts;
+        int width;
+        // number of lines as wide as width, the lines are only scanned again when the last of them shrank
+        size_t widestLineCount;
+
+        size_t GetLineEnd(size_t line) const;
+        void UpdateWidth();
+        void AddLineWidth(int lineWidth);
+
+    public:
+        TextRun();
+
+        /// <summary>
+        /// Marks the text as changed, the next Update builds the run again.
+        /// </summary>
+        __always_inline void Invalidate() { isValid = false; }
+
+        __always_inline bool IsValid(const FontHandle &value) const { return isValid && font == value; }
+
+        /// <summary>
+        /// Builds the run if the text was invalidated or the font changed.
+        /// </summary>
+        void Update(const FontHandle &value, const std::string &text);
+
+        /// <summary>
+        /// Builds the run from the advances of a font, indexed by the byte.
+        /// </summary>
+        void Build(const std::string &text, const std::array<int, CharacterList::GlyphCount> &advances);
+
+        /// <summary>
+        /// Updates the run after removedLength characters at index were replaced by insertedLength characters.
+        /// Only the lines of the edit are measured again, the run is built completely if it was not valid.
+        /// </summary>
+        /// <param name="text">The text after the edit.</param>
+        void Edit(const FontHandle &value, const std::string &text, size_t index, size_t removedLength, size_t insertedLength);
+
+        /// <summary>
+        /// Updates the lines of an edit from the advances of a font, see Edit.
+        /// </summary>
+        void Edit(const std::string &text, size_t index, size_t removedLength, size_t insertedLength,
+                  const std::array<int, CharacterList::GlyphCount> &advances);
+
+        __always_inline size_t GetLength() const { return offsets.size() - 1; }
+        __always_inline size_t GetLineCount() const { return lineStarts.size(); }
+
+        /// <summary>
+        /// Gets the width of the widest line.
+        /// </summary>
+        __always_inline int GetWidth() const { return width; }
+
+        /// <summary>
+        /// Gets the x of the caret in front of a character relative to the start of its line, the index is clamped to the length.
+        /// </summary>
+        __always_inline int GetX(size_t index) const { return offsets[index < offsets.size() ? index : offsets.size() - 1]; }
+
+        /// <summary>
+        /// Gets the line of a character.
+        /// </summary>
+        size_t GetLine(size_t index) const;
+
+        /// <summary>
+        /// Gets the width of the widest line of a range of characters.
+        /// </summary>
+        int GetWidth(size_t start, size_t length) const;
+
+        /// <summary>
+        /// Gets the caret position of a line closest to an x position, ties go to the lower index.
+        /// </summary>
+        size_t GetIndex(int x, size_t line = 0) const;
+    };
+}
+
+using namespace xit::OpenGL;
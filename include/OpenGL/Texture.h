@@ -1,10 +1,12 @@
 #pragma once
 
+#include <atomic>
 #include <map>
 
 #include <IO/IO.h>
 #include <Application/App.h>
 #include <OpenGL/Asset.h>
+#include <OpenGL/DecodedImage.h>
 
 #ifndef GLAD_INCLUDED
 #include <glad/glad.h>
@@ -13,28 +15,33 @@
 
 namespace xit::OpenGL
 {
+    class TextureAtlas;
+    class TextureLoader;
+
     /**
      * @brief A Texture object is simply an array of bytes. It has OpenGL functions, but is
      * not limited to OpenGL, so DirectX or custom library functions could be later added.
      */
     class Texture : public OpenGL::Asset
     {
+        friend class RenderLayer;
+        friend class TextureAtlas;
+        friend class TextureLoader;
+
     private:
         static int textureMaxSize;
 
         static std::map<std::string, Texture> &GetTexturesMap();
         static std::list<std::string> &GetFailedImagesList();
 
-        bool created = false;
-        bool done = false;
-        int numberOfChannels = 0;
-        std::string filePath;
-
         /**
-         * @brief This is an array of bytes (r, g, b, a) that represent the pixels in this
-         * texture object.
+         * @brief Written by the OpenGL thread when the upload finished, may be read by any thread.
          */
-        unsigned char *pixelData = nullptr;
+        std::atomic<bool> created = false;
+        std::atomic<bool> done = false;
+
+        int numberOfChannels = 0;
+        std::string filePath;
 
         /**
          * @brief The width of the texture image.
@@ -46,13 +53,41 @@ namespace xit::OpenGL
          */
         int height = 0;
 
+        /**
+         * @brief The size in pixels the image is displayed at, 0 if unknown.
+         * The decoded image is resampled to this size before it is uploaded.
+         */
+        int displayWidth = 0;
+        int displayHeight = 0;
+
+        /**
+         * @brief The atlas page holding the pixels or nullptr if the texture has its own OpenGL texture.
+         */
+        const Texture *page = nullptr;
+
+        /**
+         * @brief The texture coordinates of the image inside the page (left, top, right, bottom).
+         */
+        float textureRect[4] = {0.0f, 0.0f, 1.0f, 1.0f};
+
         /**
          * @brief This is for OpenGL textures, it is the unique ID for the OpenGL texture.
          */
         GLuint textureId = 0;
 
-        void CreateAsync();
-        void CreateFromFileAsync();
+        /**
+         * @brief Reads, decodes and resamples the file. Called by a worker of the TextureLoader.
+         * @param image Receives the pixels, they stay empty if the file could not be loaded.
+         */
+        void Decode(DecodedImage &image) const;
+
+        /**
+         * @brief Uploads the decoded pixels and marks the texture as done. Called on the OpenGL thread.
+         * @param image The decoded image.
+         */
+        void Upload(const DecodedImage &image);
+
+        static void GetResampledSize(int imageWidth, int imageHeight, int displayWidth, int displayHeight, int &resampledWidth, int &resampledHeight);
 
     public:
         const int &Width = width;
@@ -70,8 +105,21 @@ namespace xit::OpenGL
          */
         GLuint GetChannels() const;
 
-        bool GetIsCreated() const { return created; }
-        bool GetIsDone() const { return done; }
+        bool GetIsCreated() const { return created.load(std::memory_order_acquire); }
+        bool GetIsDone() const { return done.load(std::memory_order_acquire); }
+
+        /**
+         * @brief Gets the texture holding the pixels. This is the atlas page for small images,
+         * otherwise the texture itself. Textures sharing the same storage can be drawn in one batch.
+         * @return The texture to bind.
+         */
+        const Texture *GetStorage() const { return page ? page : this; }
+
+        /**
+         * @brief Gets the texture coordinates of the image inside its storage.
+         * @return left, top, right, bottom in the range 0..1.
+         */
+        const float *GetTextureRect() const { return textureRect; }
 
         /**
          * @brief Initializes a new instance of the <see cref="Texture"/> class.
@@ -84,6 +132,12 @@ namespace xit::OpenGL
          */
         void Bind() const;
 
+        /**
+         * @brief Bind to a texture unit, nothing is sent to OpenGL if the unit already has it.
+         * @param unit The texture unit.
+         */
+        void Bind(int unit) const;
+
         /**
          * @brief Unbind from the specified OpenGL instance.
          */
@@ -108,8 +162,8 @@ namespace xit::OpenGL
         /**
          * @brief This function creates the texture from an image file.
          * @param path The path to the image file.
-         * @param width The width of the image.
-         * @param height The height of the image.
+         * @param width The width in pixels the image is displayed at, 0 or less if unknown.
+         * @param height The height in pixels the image is displayed at, 0 or less if unknown.
          * @return True if the texture was successfully loaded.
          */
         virtual bool Create(const std::string &path, int width, int height);
@@ -128,10 +182,10 @@ namespace xit::OpenGL
 
     public:
         /**
-         * @brief Finds or creates a texture.
+         * @brief Finds or creates a texture. Each file is loaded once per display size.
          * @param file The path to the image file.
-         * @param width The width of the image.
-         * @param height The height of the image.
+         * @param width The width in pixels the image is displayed at (including the DPI scale), 0 or less if unknown.
+         * @param height The height in pixels the image is displayed at (including the DPI scale), 0 or less if unknown.
          * @return The texture object.
          */
         static const Texture *FindOrCreateTexture(const std::string &file, int width, int height);
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <list>
+#include <vector>
+#include <OpenGL/Texture.h>
+
+namespace xit::OpenGL
+{
+    /// <summary>
+    /// Shared RGBA pages for small images.
+    /// Images up to MaxImageSize pixels are copied into a page and only get texture coordinates inside it,
+    /// so all images of a page use the same texture slot of Graphics and do not break the batch.
+    /// Images are packed into shelves (rows of images with similar height), a new page is added when all pages are full.
+    /// Images are stored at their display size, so pages have no mipmaps.
+    /// </summary>
+    class TextureAtlas
+    {
+    public:
+        static constexpr int PageSize = 1024;
+        static constexpr int MaxImageSize = 128;
+        static constexpr int Padding = 1;
+
+    private:
+        struct Shelf
+        {
+            int Top;
+            int Height;
+            int Used;
+        };
+
+        struct Page
+        {
+            Texture Storage;
+            int UsedHeight = 0;
+            std::vector<Shelf> Shelves;
+        };
+
+        static std::list<Page> &GetPages();
+
+        static void CreatePage(Page &page);
+        static bool Allocate(Page &page, int imageWidth, int imageHeight, int &x, int &y);
+
+    public:
+        /// <summary>
+        /// Copies an image into a page and lets the texture point to it. Must be called on the OpenGL thread.
+        /// </summary>
+        /// <param name="pixels">The pixels of the image, first row is the top of the image.</param>
+        /// <param name="imageWidth">The width of the image in pixels.</param>
+        /// <param name="imageHeight">The height of the image in pixels.</param>
+        /// <param name="channels">The number of channels (1-4), the image is converted to RGBA.</param>
+        /// <param name="texture">The texture referencing the image.</param>
+        /// <returns>false if the image is too large for the atlas, the texture is not changed then.</returns>
+        static bool Add(const unsigned char *pixels, int imageWidth, int imageHeight, int channels, Texture &texture);
+
+        /// <summary>
+        /// Gets the number of pages.
+        /// </summary>
+        static size_t GetPageCount() { return GetPages().size(); }
+
+        /// <summary>
+        /// Deletes all pages. Only call this while the OpenGL context is current.
+        /// Textures added before are invalid afterwards.
+        /// </summary>
+        static void Destroy();
+    };
+}
+
+using namespace xit::OpenGL;
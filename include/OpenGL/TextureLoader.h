@@ -0,0 +1,101 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <OpenGL/DecodedImage.h>
+
+#ifndef GLAD_INCLUDED
+#include <glad/glad.h>
+#define GLAD_INCLUDED
+#endif
+
+namespace xit::OpenGL
+{
+    /// <summary>
+    /// Loads image files in the background.
+    /// A pool of worker threads reads, decrypts, decodes and resamples the files and puts the pixels
+    /// into a staging queue holding at most MaxStagedImages images, workers wait while it is full.
+    /// The OpenGL thread drains the queue with ProcessUploads, which stops when its time budget is used up.
+    /// Uploads of standalone textures go through a pixel unpack buffer, so the driver can copy them asynchronously.
+    /// </summary>
+    class TextureLoader
+    {
+    public:
+        static constexpr size_t MaxStagedImages = 8;
+        static constexpr unsigned int MaxWorkers = 4;
+
+    private:
+        struct Pool
+        {
+            std::mutex Mutex;
+            std::condition_variable JobAvailable;
+            std::condition_variable StagingAvailable;
+            std::deque<Texture *> Jobs;
+            std::deque<DecodedImage> Staged;
+            std::vector<std::thread> Workers;
+            size_t Pending = 0; // jobs queued, being decoded or staged
+            bool IsStopping = false;
+
+            ~Pool();
+        };
+
+        static Pool &GetPool();
+        static GLuint pixelBuffer;
+        static std::atomic<void (*)()> wakeUp;
+
+        static void Work(Pool &pool);
+
+    public:
+        /// <summary>
+        /// Queues a texture for loading, the file path and display size have to be set.
+        /// The workers are started with the first call.
+        /// </summary>
+        /// <param name="texture">The texture to load. It must stay alive until it is done.</param>
+        static void Load(Texture *texture);
+
+        /// <summary>
+        /// Uploads staged images until the queue is empty or the budget is used up.
+        /// At least one image is uploaded if there is one. Must be called on the OpenGL thread.
+        /// </summary>
+        /// <param name="budget">The time the uploads may take.</param>
+        /// <returns>The number of textures which are done now.</returns>
+        static size_t ProcessUploads(std::chrono::microseconds budget);
+
+        /// <summary>
+        /// Gets the number of textures queued, being decoded or waiting for their upload.
+        /// Callers loading many images can use it to keep the queue short.
+        /// </summary>
+        static size_t GetPendingLoadCount();
+
+        /// <summary>
+        /// Returns true if decoded images wait for ProcessUploads.
+        /// </summary>
+        static bool HasStagedImages();
+
+        /// <summary>
+        /// Sets the function the workers call after they staged an image, e.g. to wake a sleeping main loop.
+        /// It is called on the worker threads.
+        /// </summary>
+        __always_inline static void SetWakeUp(void (*value)()) { wakeUp.store(value); }
+
+        /// <summary>
+        /// Copies pixels into the pixel unpack buffer and binds it. Must be called on the OpenGL thread.
+        /// </summary>
+        /// <param name="pixels">The pixels to upload.</param>
+        /// <param name="size">The number of bytes.</param>
+        /// <returns>The pointer to pass to glTexImage2D, an offset into the buffer or pixels if the buffer could not be mapped.</returns>
+        static const unsigned char *BeginPixelUpload(const unsigned char *pixels, size_t size);
+
+        /// <summary>
+        /// Unbinds the pixel unpack buffer after the pixels were passed to OpenGL.
+        /// </summary>
+        static void EndPixelUpload();
+    };
+}
+
+using namespace xit::OpenGL;
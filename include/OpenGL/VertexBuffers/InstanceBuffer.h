@@ -0,0 +1,204 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <vector>
+#include <OpenGL/VertexBuffers/VertexBufferBase.h>
+
+namespace xit::OpenGL
+{
+    /// <summary>
+    /// A VertexBuffer holding per-instance data for instanced draw calls.
+    /// Stream writes the data into a ring buffer of Segments segments and returns its offset,
+    /// the storage is never re-allocated. Each segment is protected by a fence when the ring moves on,
+    /// so a segment is only overwritten after the GPU has finished the draw calls reading it.
+    /// SetData is the old upload path, it orphans the whole storage on every call.
+    /// </summary>
+    class InstanceBuffer : public VertexBufferBase
+    {
+    public:
+        static constexpr int Segments = 4;
+
+    private:
+        struct Attribute
+        {
+            GLuint Index;
+            int Components;
+            int Stride;
+            size_t Offset;
+        };
+
+        GLsizeiptr capacity;
+        GLsizeiptr segmentSize;
+        GLintptr head;
+        int segment;
+        GLintptr attributeBase;
+        GLsync fences[Segments];
+        std::vector<Attribute> attributes;
+
+        void PointAttributes(GLintptr base)
+        {
+            for (const Attribute &attribute : attributes)
+            {
+                glVertexAttribPointer(attribute.Index, attribute.Components, GL_FLOAT, GL_FALSE, attribute.Stride, reinterpret_cast<const void *>(base + attribute.Offset));
+            }
+            attributeBase = base;
+        }
+
+        void NextSegment()
+        {
+            // the draw calls reading the segment we leave are protected until the ring comes back
+            fences[segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+            segment = (segment + 1) % Segments;
+            head = (GLintptr)segment * segmentSize;
+
+            if (fences[segment])
+            {
+                // usually already signaled, the segment was left Segments - 1 segments ago
+                glClientWaitSync(fences[segment], GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+                glDeleteSync(fences[segment]);
+                fences[segment] = nullptr;
+            }
+        }
+
+    public:
+        InstanceBuffer()
+            : capacity(0),
+              segmentSize(0),
+              head(0),
+              segment(0),
+              attributeBase(0),
+              fences{nullptr}
+        {
+        }
+
+        /// <summary>
+        /// Gets the size of the buffer storage in bytes.
+        /// </summary>
+        __always_inline GLsizeiptr GetCapacity() const { return capacity; }
+
+        /// <summary>
+        /// Gets the largest number of bytes a single Stream or SetData call can upload.
+        /// </summary>
+        __always_inline GLsizeiptr GetSegmentSize() const { return segmentSize; }
+
+        /// <summary>
+        /// Allocates the buffer storage for Segments uploads of up to sizeInBytes each. The buffer has to be bound.
+        /// </summary>
+        /// <param name="sizeInBytes">The size of the largest upload in bytes.</param>
+        void Allocate(GLsizeiptr sizeInBytes)
+        {
+            segmentSize = sizeInBytes;
+            capacity = sizeInBytes * Segments;
+            head = 0;
+            segment = 0;
+            glBufferData(GL_ARRAY_BUFFER, capacity, nullptr, GL_STREAM_DRAW);
+        }
+
+        /// <summary>
+        /// Describes one float attribute inside the interleaved instance data.
+        /// The buffer and the vertex array have to be bound.
+        /// </summary>
+        /// <param name="attributeIndex">The layout location of the attribute in the shader program.</param>
+        /// <param name="components">The number of floats of the attribute (1-4).</param>
+        /// <param name="stride">The size of one instance in bytes.</param>
+        /// <param name="offset">The offset of the attribute inside one instance in bytes.</param>
+        void SetAttribute(GLuint attributeIndex, int components, int stride, size_t offset)
+        {
+            attributes.push_back({attributeIndex, components, stride, offset});
+
+            glVertexAttribPointer(attributeIndex, components, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<const void *>(attributeBase + offset));
+            glVertexAttribDivisor(attributeIndex, 1);
+            glEnableVertexAttribArray(attributeIndex);
+        }
+
+        /// <summary>
+        /// Writes the data behind the previous writes and lets the attributes point to it.
+        /// The buffer and the vertex array have to be bound.
+        /// </summary>
+        /// <param name="data">The instance data.</param>
+        /// <param name="sizeInBytes">The number of bytes to upload. Must not exceed the segment size.</param>
+        /// <returns>The offset of the data inside the buffer in bytes.</returns>
+        GLintptr Stream(const void *data, GLsizeiptr sizeInBytes)
+        {
+            // writes never cross a segment, continue at the start of the next one
+            if (head + sizeInBytes > (GLintptr)(segment + 1) * segmentSize)
+                NextSegment();
+
+            GLintptr offset = head;
+
+            void *target = glMapBufferRange(GL_ARRAY_BUFFER, offset, sizeInBytes, GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+
+            if (target)
+            {
+                std::memcpy(target, data, (size_t)sizeInBytes);
+                glUnmapBuffer(GL_ARRAY_BUFFER);
+            }
+            else
+            {
+                glBufferSubData(GL_ARRAY_BUFFER, offset, sizeInBytes, data);
+            }
+
+            head += sizeInBytes;
+
+            PointAttributes(offset);
+
+            return offset;
+        }
+
+        /// <summary>
+        /// Replaces the contents of the buffer. The buffer and the vertex array have to be bound.
+        /// </summary>
+        /// <param name="data">The instance data.</param>
+        /// <param name="sizeInBytes">The number of bytes to upload. Must not exceed the segment size.</param>
+        void SetData(const void *data, GLsizeiptr sizeInBytes)
+        {
+            // orphan the old storage, the driver hands out fresh memory if it is still in use
+            glBufferData(GL_ARRAY_BUFFER, capacity, nullptr, GL_STREAM_DRAW);
+            glBufferSubData(GL_ARRAY_BUFFER, 0, sizeInBytes, data);
+
+            // the new storage is not read by any draw call yet
+            for (GLsync &fence : fences)
+            {
+                if (fence)
+                {
+                    glDeleteSync(fence);
+                    fence = nullptr;
+                }
+            }
+
+            head = sizeInBytes;
+            segment = 0;
+
+            if (attributeBase != 0)
+                PointAttributes(0);
+        }
+
+        __always_inline virtual void Delete() override
+        {
+            for (GLsync &fence : fences)
+            {
+                if (fence)
+                {
+                    glDeleteSync(fence);
+                    fence = nullptr;
+                }
+            }
+
+            VertexBufferBase::Delete();
+        }
+
+        __always_inline virtual void Bind() override
+        {
+            VertexBufferBase::Bind(GL_ARRAY_BUFFER);
+        }
+
+        __always_inline virtual void Unbind() override
+        {
+            VertexBufferBase::Unbind(GL_ARRAY_BUFFER);
+        }
+    };
+}
+
+using namespace xit::OpenGL;
@@ -23,17 +23,18 @@ namespace xit::OpenGL
 
         __always_inline virtual void Delete() override
         {
-            glDeleteVertexArrays(1, &id);
+            RenderState::DeleteVertexArray(id);
+            id = 0;
         }
 
         __always_inline virtual void Bind() override
         {
-            glBindVertexArray(id);
+            RenderState::BindVertexArray(id);
         }
 
         __always_inline virtual void Unbind() override
         {
-            glBindVertexArray(0);
+            RenderState::BindVertexArray(0);
         }
     };
 }
@@ -5,6 +5,8 @@
 #define GLAD_INCLUDED
 #endif
 
+#include <OpenGL/RenderState.h>
+
 namespace xit::OpenGL
 {
     class VertexBufferBase
@@ -36,16 +38,17 @@ namespace xit::OpenGL
 
         __always_inline virtual void Delete()
         {
-            glDeleteBuffers(1, &id);
+            RenderState::DeleteBuffer(id);
+            id = 0;
         }
 
         __always_inline void Bind(GLenum target)
         {
-            glBindBuffer(target, id);
+            RenderState::BindBuffer(target, id);
         }
         __always_inline void Unbind(GLenum target)
         {
-            glBindBuffer(target, 0);
+            RenderState::BindBuffer(target, 0);
         }
 
         virtual void Bind() = 0;
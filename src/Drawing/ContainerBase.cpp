@@ -1,9 +1,6 @@
 #include <Drawing/ContainerBase.h>
 #include <Input/InputHandler.h>
-#ifdef DEBUG_GRID_PERFORMANCE
-#include <chrono>
-#include <iostream>
-#endif
+#include <OpenGL/Profiler.h>
 
 namespace xit::Drawing
 {
@@ -22,6 +19,9 @@ namespace xit::Drawing
         grid.SetColumns(GetColumns());
         grid.SetRows(GetRows());
 
+        // the content is drawn from a recorded list until something in it changes
+        SetCacheRenderCommands(true);
+
         SetName("ContainerBase");
     }
 
@@ -341,26 +341,18 @@ namespace xit::Drawing
 
     void ContainerBase::OnUpdate(const Rectangle &bounds)
     {
-        // TODO if bounds did not change, do we have to update? Only in case if items have been added or removed? Check the requirements!
         bool updateSize = GetNeedWidthRecalculation() || GetNeedHeightRecalculation();
         bool updateLocations = GetNeedLeftRecalculation() || GetNeedTopRecalculation();
+        // only some children need layout, the others skip themselves because their bounds did not change
+        bool updateChildren = GetNeedChildLayout();
 
-#ifdef DEBUG_GRID_PERFORMANCE
-        auto start = std::chrono::high_resolution_clock::now();
-        std::cout << "ContainerBase::OnUpdate - " << GetName() << " with " << children.size()
-                  << " children, updateSize=" << updateSize << ", updateLocations=" << updateLocations << std::endl;
-#endif
+        PROFILE_ZONE("ContainerBase::OnUpdate");
 
         InputContent::OnUpdate(bounds);
 
         // Use cached client bounds from LayoutManager for optimal performance
         Rectangle stored = GetClientBounds();
 
-#ifdef DEBUG_GRID_PERFORMANCE
-        std::cout << "ContainerBase::OnUpdate - Client bounds: (" << stored.GetLeft() << ","
-                  << stored.GetTop() << "," << stored.GetWidth() << "," << stored.GetHeight() << ")" << std::endl;
-#endif
-
         // Handle negative margin (special case for SplitContainer)
         int left = stored.GetLeft();
         int top = stored.GetTop();
@@ -376,17 +368,12 @@ namespace xit::Drawing
         //     left += margin.GetLeft();
 
         // TODO this order is different to ScrollViewer
-#ifdef DEBUG_GRID_PERFORMANCE
-        auto gridStart = std::chrono::high_resolution_clock::now();
-#endif
-        grid.SetBounds(stored);
-#ifdef DEBUG_GRID_PERFORMANCE
-        auto gridEnd = std::chrono::high_resolution_clock::now();
-        auto gridDuration = std::chrono::duration_cast<std::chrono::microseconds>(gridEnd - gridStart);
-        std::cout << "ContainerBase::OnUpdate - Grid.SetBounds() took " << gridDuration.count() << "μs" << std::endl;
-#endif
-
-        if (updateSize || updateLocations)
+        {
+            PROFILE_ZONE("Grid::SetBounds");
+            grid.SetBounds(stored);
+        }
+
+        if (updateSize || updateLocations || updateChildren)
         {
             for (Visual *content : children)
             {
@@ -470,12 +457,6 @@ namespace xit::Drawing
                 content->UpdateLayout(thisClientsBounds);
             }
         }
-
-#ifdef DEBUG_GRID_PERFORMANCE
-        auto end = std::chrono::high_resolution_clock::now();
-        auto totalDuration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
-        std::cout << "ContainerBase::OnUpdate - " << GetName() << " total time: " << totalDuration.count() << "μs" << std::endl;
-#endif
     }
 
     void ContainerBase::OnRender()
@@ -484,7 +465,9 @@ namespace xit::Drawing
 
         for (Visual *content : children)
         {
-            content->Render();
+            // children scrolled out of view or outside the redrawn region are skipped with all of their content
+            if (!content->IsOutsideClipBounds())
+                content->Render();
         }
     }
 
@@ -503,12 +486,16 @@ namespace xit::Drawing
 
     void ContainerBase::InvokeChildAdded(Visual &content)
     {
+        InvalidateRenderCommands();
+
         EventArgs e;
         ChildAdded(content, e);
         OnChildAdded(content, e);
     }
     void ContainerBase::InvokeChildRemoved(Visual &content)
     {
+        InvalidateRenderCommands();
+
         EventArgs e;
         ChildRemoved(content, e);
         OnChildRemoved(content, e);
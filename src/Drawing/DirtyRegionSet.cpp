@@ -0,0 +1,134 @@
+#include <Drawing/DirtyRegionSet.h>
+
+#include <algorithm>
+
+namespace xit::Drawing
+{
+    DirtyRegionSet::DirtyRegionSet()
+        : area(0, 0, 0, 0),
+          isUsed{false},
+          usedCount(0)
+    {
+        regions.reserve(MaxRegions);
+    }
+
+    //******************************************************************************
+    // Private
+    //******************************************************************************
+
+    void DirtyRegionSet::Merge(Rectangle &target, const Rectangle &source)
+    {
+        int left = std::min(target.GetLeft(), source.GetLeft());
+        int top = std::min(target.GetTop(), source.GetTop());
+        int right = std::max(target.GetRight(), source.GetRight());
+        int bottom = std::max(target.GetBottom(), source.GetBottom());
+
+        target = Rectangle(left, top, right - left, bottom - top);
+    }
+
+    bool DirtyRegionSet::Overlaps(const Rectangle &a, const Rectangle &b)
+    {
+        return a.GetLeft() < b.GetRight() && b.GetLeft() < a.GetRight() &&
+               a.GetTop() < b.GetBottom() && b.GetTop() < a.GetBottom();
+    }
+
+    //******************************************************************************
+    // Public
+    //******************************************************************************
+
+    void DirtyRegionSet::SetArea(const Rectangle &value)
+    {
+        area = value;
+        Clear();
+    }
+
+    void DirtyRegionSet::Add(const Rectangle &region)
+    {
+        // clip to the area, invisible parts do not have to be drawn
+        int left = std::max(region.GetLeft(), area.GetLeft());
+        int top = std::max(region.GetTop(), area.GetTop());
+        int right = std::min(region.GetRight(), area.GetRight());
+        int bottom = std::min(region.GetBottom(), area.GetBottom());
+
+        if (right <= left || bottom <= top)
+            return;
+
+        Rectangle clipped(left, top, right - left, bottom - top);
+
+        // the bucket containing the center of the region
+        int column = (((left + right) >> 1) - area.GetLeft()) * Columns / area.GetWidth();
+        int row = (((top + bottom) >> 1) - area.GetTop()) * Rows / area.GetHeight();
+
+        column = std::clamp(column, 0, Columns - 1);
+        row = std::clamp(row, 0, Rows - 1);
+
+        int index = row * Columns + column;
+
+        if (isUsed[index])
+        {
+            Merge(buckets[index], clipped);
+        }
+        else
+        {
+            buckets[index] = clipped;
+            isUsed[index] = true;
+            usedCount++;
+        }
+    }
+
+    void DirtyRegionSet::Clear()
+    {
+        std::fill(std::begin(isUsed), std::end(isUsed), false);
+        usedCount = 0;
+        regions.clear();
+    }
+
+    const std::vector<Rectangle> &DirtyRegionSet::GetRegions()
+    {
+        regions.clear();
+
+        for (int i = 0; i < MaxRegions; i++)
+        {
+            if (isUsed[i])
+                regions.push_back(buckets[i]);
+        }
+
+        // a merged region may overlap regions already checked, repeat until nothing overlaps.
+        // There are at most MaxRegions regions, so this stays cheap.
+        bool merged = true;
+
+        while (merged)
+        {
+            merged = false;
+
+            for (size_t i = 0; i < regions.size(); i++)
+            {
+                for (size_t j = i + 1; j < regions.size();)
+                {
+                    if (Overlaps(regions[i], regions[j]))
+                    {
+                        Merge(regions[i], regions[j]);
+                        regions.erase(regions.begin() + (std::ptrdiff_t)j);
+                        merged = true;
+                    }
+                    else
+                    {
+                        j++;
+                    }
+                }
+            }
+        }
+
+        return regions;
+    }
+
+    int DirtyRegionSet::GetCoveredArea() const
+    {
+        int coveredArea = 0;
+
+        for (const Rectangle &region : regions)
+            coveredArea += region.GetWidth() * region.GetHeight();
+
+        return coveredArea;
+    }
+}
@@ -0,0 +1,121 @@
+#include <Drawing/FrameClock.h>
+
+#include <algorithm>
+
+namespace xit::Drawing
+{
+    FrameClock::FrameClock()
+        : refreshRate(0),
+          interval(0),
+          policy(FramePolicy::OnDemand),
+          isVSync(false),
+          isInFrame(false),
+          isRenderEnded(false),
+          lastFrameDuration(0),
+          lastWorkDuration(0),
+          lastUpdateDuration(0),
+          lastLayoutDuration(0),
+          frameCount(0),
+          lateFrameCount(0),
+          isLastFrameLate(false)
+    {
+        SetRefreshRate(DefaultRefreshRate);
+    }
+
+    //******************************************************************************
+    // Private
+    //******************************************************************************
+
+    FrameClock::Clock::time_point FrameClock::GetNextTick(Clock::time_point time) const
+    {
+        // the first tick after time
+        Clock::duration sinceVSync = time - vsyncTime;
+
+        if (sinceVSync < Clock::duration::zero())
+            return vsyncTime;
+
+        return vsyncTime + (sinceVSync / interval + 1) * interval;
+    }
+
+    //******************************************************************************
+    // Public
+    //******************************************************************************
+
+    void FrameClock::SetRefreshRate(int value)
+    {
+        if (value <= 0)
+            value = DefaultRefreshRate;
+
+        refreshRate = value;
+        interval = std::chrono::duration_cast<Clock::duration>(std::chrono::nanoseconds(1000000000 / value));
+    }
+
+    void FrameClock::BeginFrame(Clock::time_point now)
+    {
+        frameStartTime = now;
+        updateEndTime = now;
+        lastUpdateDuration = Clock::duration::zero();
+        lastLayoutDuration = Clock::duration::zero();
+        isInFrame = true;
+        isRenderEnded = false;
+    }
+
+    void FrameClock::EndUpdate(Clock::time_point now)
+    {
+        updateEndTime = now;
+        lastUpdateDuration = now - frameStartTime;
+    }
+
+    void FrameClock::EndLayout(Clock::time_point now)
+    {
+        if (isInFrame)
+            lastLayoutDuration = now - updateEndTime;
+    }
+
+    void FrameClock::EndRender(Clock::time_point now)
+    {
+        if (!isInFrame)
+            return;
+
+        renderEndTime = now;
+        isRenderEnded = true;
+    }
+
+    void FrameClock::EndFrame(Clock::time_point now, bool isPresented)
+    {
+        lastFrameDuration = now - frameStartTime;
+        lastWorkDuration = (isRenderEnded ? renderEndTime : now) - frameStartTime;
+        isLastFrameLate = lastWorkDuration > interval;
+        isInFrame = false;
+
+        frameCount++;
+        if (isLastFrameLate)
+            lateFrameCount++;
+
+        if (isPresented && isVSync)
+        {
+            // the swap returned at a vertical blank, the next frame can start right away
+            vsyncTime = now;
+            nextFrameTime = now;
+        }
+        else
+        {
+            // at most one frame per tick, a frame which missed its tick waits for the one after it ended
+            nextFrameTime = GetNextTick(frameStartTime);
+
+            if (nextFrameTime < now)
+                nextFrameTime = GetNextTick(now);
+        }
+    }
+
+    FrameClock::Clock::duration FrameClock::GetRemainingUpdateBudget(Clock::time_point now) const
+    {
+        Clock::duration left = frameStartTime + interval / UpdateBudgetShare - now;
+        return std::max(left, Clock::duration::zero());
+    }
+
+    bool FrameClock::IsLayoutOverBudget(Clock::time_point now) const
+    {
+        return isInFrame && now - updateEndTime >= interval / LayoutBudgetShare;
+    }
+}
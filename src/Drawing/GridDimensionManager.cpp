@@ -1,6 +1,6 @@
 #include <Drawing/GridDimensionManager.h>
-#ifdef DEBUG_GRID_PERFORMANCE
-#include <chrono>
+#include <OpenGL/Profiler.h>
+#ifdef DEBUG_GRID
 #include <iostream>
 #endif
 
@@ -39,11 +39,8 @@ namespace xit::Drawing
     {
         if (updateInfo.UpdateAuto && children != nullptr && children->size() > 0)
         {
-#ifdef DEBUG_GRID_PERFORMANCE
-            auto start = std::chrono::high_resolution_clock::now();
-            std::cout << "GridDimensionManager::UpdateAuto - Processing " << children->size() 
-                      << " children, " << autoValues.size() << " auto values" << std::endl;
-#endif
+            PROFILE_ZONE("GridDimensionManager::UpdateAuto");
+
             autoTotalSize = 0;
 
             if (autoValues.size() > 0)
@@ -75,12 +72,6 @@ namespace xit::Drawing
                     autoTotalSize += sizes[a];
                 }
 
-#ifdef DEBUG_GRID_PERFORMANCE
-                auto end = std::chrono::high_resolution_clock::now();
-                auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
-                std::cout << "GridDimensionManager::UpdateAuto - Completed in " << duration.count() << "μs" << std::endl;
-#endif
-
 #ifdef DEBUG_GRID
                 std::cout << "Auto values: ";
                 for (size_t a : autoValues)
@@ -128,13 +119,7 @@ namespace xit::Drawing
     {
         if (updateInfo.NeedUpdate())
         {
-#ifdef DEBUG_GRID_PERFORMANCE
-            auto timing_start = std::chrono::high_resolution_clock::now();
-            std::cout << "GridDimensionManager::UpdateSizes - Starting layout calculation" << std::endl;
-            std::cout << "  Fixed values: " << fixedValues.size() 
-                      << ", Auto values: " << autoValues.size() 
-                      << ", Star values: " << starValues.size() << std::endl;
-#endif
+            PROFILE_ZONE("GridDimensionManager::UpdateSizes");
             
             GridLayoutHelper::CheckSizeListLength(numberOfValues, sizes, positions);
 
@@ -163,13 +148,6 @@ namespace xit::Drawing
             }
 
             currentSize = total;
-            
-#ifdef DEBUG_GRID_PERFORMANCE
-            auto timing_end = std::chrono::high_resolution_clock::now();
-            auto duration = std::chrono::duration_cast<std::chrono::microseconds>(timing_end - timing_start);
-            std::cout << "GridDimensionManager::UpdateSizes - Completed in " << duration.count() 
-                      << "μs, final size: " << currentSize << std::endl;
-#endif
         }
     }
 
@@ -213,5 +213,10 @@ namespace xit::Drawing
                 GetFailedImagesList().push_back(imageSource);
             }
         }
+        else
+        {
+            // containers reused by a virtualizing ListView clear their image before they get the next one
+            SetBackground(nullptr);
+        }
     }
 }
@@ -5,10 +5,7 @@
 #include <chrono>
 #endif
 
-#ifdef DEBUG_FONT_PERFORMANCE
-#include <chrono>
-#include <iostream>
-#endif
+#include <OpenGL/Profiler.h>
 
 namespace xit::Drawing
 {
@@ -109,7 +106,7 @@ namespace xit::Drawing
 
     void Label::OnRender()
     {
-        std::string text = GetText();
+        const std::string &text = GetText();
 
 #ifdef DEBUG_LABEL
         std::cout << "[DEBUG] Label::OnRender() called with text='" << text << "' name='" << GetName() << "' at timestamp " << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count() << std::endl;
@@ -129,7 +126,7 @@ namespace xit::Drawing
 #ifdef DEBUG_LABEL
             std::cout << "[DEBUG] Calling TextRenderer::RenderText()" << std::endl;
 #endif
-            TextRenderer::RenderText(GetFontName(), GetFontSize(), text, GetLeft(), textTop, GetZIndex(), color);
+            TextRenderer::RenderText(GetFontHandle(), text, GetLeft(), textTop, GetZIndex(), color);
 #ifdef DEBUG_LABEL
             std::cout << "[DEBUG] TextRenderer::RenderText() returned" << std::endl;
 #endif
@@ -145,6 +142,7 @@ namespace xit::Drawing
     void Label::SetDPIScale(float scaleX, float scaleY)
     {
         TextProperty::SetNeedMeasureText(true);
+        FontProperty::SetFontScale(scaleX);
         FontProperty::SetNeedMeasureFont(true);
         Visual::SetDPIScale(scaleX, scaleY);
     }
@@ -160,31 +158,19 @@ namespace xit::Drawing
 
         if (needMeasureText && GetIsVisible())
         {
-#ifdef DEBUG_FONT_PERFORMANCE
-            auto start = std::chrono::high_resolution_clock::now();
-            std::cout << "Label::MeasureText - Starting measurement for '" << GetName()
-                      << "' text='" << GetText() << "'" << std::endl;
-#endif
+            PROFILE_ZONE("Label::MeasureText");
 
-            int scaledFontSize = (int)((float)GetFontSize() * GetScaleX());
             const std::string &thisText = GetText();
 
             if (thisText.empty())
             {
                 // even if empty, we need to reserve the height for the text
                 textSize.SetWidth(0);
-                textSize.SetHeight(scaledFontSize);
+                textSize.SetHeight(GetScaledFontSize());
                 return textSize;
             }
 
-            MeasureText(GetFontName(), scaledFontSize, thisText, textSize);
-
-#ifdef DEBUG_FONT_PERFORMANCE
-            auto end = std::chrono::high_resolution_clock::now();
-            auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
-            std::cout << "Label::MeasureText - '" << GetName() << "' completed in " << duration.count()
-                      << "μs, result: " << textSize.GetWidth() << "x" << textSize.GetHeight() << std::endl;
-#endif
+            GetFontHandle().Measure(thisText, textSize);
 
             if (!textSize.IsEmpty())
             {
@@ -201,22 +187,16 @@ namespace xit::Drawing
         return textSize;
     }
 
-    const void Label::MeasureText(const std::string &fontName, int fontSize, const std::string &text, Size &target)
+    void Label::SetTextSize(const Size &value)
     {
-#ifdef DEBUG_FONT_PERFORMANCE
-        auto start = std::chrono::high_resolution_clock::now();
-        std::cout << "Label::MeasureText(static) - FontStorage::FindOrCreate('" << fontName
-                  << "', " << fontSize << ") for text '" << text << "'" << std::endl;
-#endif
+        textSize = value;
+        TextProperty::SetNeedMeasureText(false);
+        FontProperty::SetNeedMeasureFont(false);
+    }
 
+    const void Label::MeasureText(const std::string &fontName, int fontSize, const std::string &text, Size &target)
+    {
         FontStorage::FindOrCreate(fontName, fontSize).Measure(text, target);
-
-#ifdef DEBUG_FONT_PERFORMANCE
-        auto end = std::chrono::high_resolution_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
-        std::cout << "Label::MeasureText(static) - FontStorage operation completed in " << duration.count()
-                  << "μs, result: " << target.GetWidth() << "x" << target.GetHeight() << std::endl;
-#endif
     }
 
     //******************************************************************************
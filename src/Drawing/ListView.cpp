@@ -1,5 +1,7 @@
 #include <Drawing/ListView.h>
 #include <Threading/Dispatcher.h>
+#include <OpenGL/TextureLoader.h>
+#include <algorithm>
 
 namespace xit::Drawing
 {
@@ -45,7 +47,6 @@ namespace xit::Drawing
             {
                 visibleItems.clear();
                 UpdateList();
-                updateThread.join();
             }
 
             int lastSelectedIndex = selectedIndex;
@@ -94,12 +95,66 @@ namespace xit::Drawing
         Refresh();
     }
 
+    void ListView::SetIsVirtualizing(bool value)
+    {
+        if (isVirtualizing != value)
+        {
+            isVirtualizing = value;
+
+            if (isVirtualizing)
+            {
+                // containers of the list shown before are reused, they all have to report their selection
+                for (Visual *content : GetChildren())
+                {
+                    ListItem *listItem = dynamic_cast<ListItem *>(content);
+                    if (listItem != nullptr)
+                    {
+                        listItem->IsActiveChanged.Remove(&ListView::ListViewItem_ActiveChanged, this);
+                        listItem->IsActiveChanged.Add(&ListView::ListViewItem_ActiveChanged, this);
+                    }
+                }
+            }
+            else
+            {
+                // replace the spacer rows, the containers get their rows back in UpdateList
+                std::string rows = "Auto";
+                for (size_t i = 1; i < GetChildCount(); i++)
+                {
+                    rows += ",Auto";
+                }
+                SetRows(rows);
+            }
+
+            if (items != nullptr)
+            {
+                UpdateList();
+            }
+        }
+    }
+
+    void ListView::SetItemHeight(int value)
+    {
+        if (itemHeight != value)
+        {
+            itemHeight = value;
+
+            if (isVirtualizing)
+            {
+                RealizeItems(GetActualHeight());
+                Invalidate();
+            }
+        }
+    }
+
     ListView::ListView()
     {
         headerItemCount = 0;
         isSelectionChanging = false;
         items = nullptr;
         itemsSource = nullptr;
+        isVirtualizing = false;
+        itemHeight = 0;
+        estimatedItemHeight = 0;
         filter = nullptr;
         listViewType = ListViewType::Text;
 
@@ -120,15 +175,6 @@ namespace xit::Drawing
 
     ListView::~ListView()
     {
-        if (updateThread.joinable())
-        {
-            updateThread.join();
-        }
-        for (std::thread &thread : threads)
-        {
-            if (thread.joinable())
-                thread.join();
-        }
     }
 
     void ListView::ListViewItem_ActiveChanged(IsActiveProperty &sender, EventArgs &e)
@@ -141,6 +187,11 @@ namespace xit::Drawing
             {
                 int index = GetChildIndex(listItem);
 
+                if (isVirtualizing)
+                {
+                    index = index >= 0 && index < (int)realizedItems.size() ? realizedItems[index] : -1;
+                }
+
                 if (selectionMode == SelectionMode::Single)
                 {
                     SetSelectedIndex(index);
@@ -158,18 +209,15 @@ namespace xit::Drawing
 
     void ListView::UpdateList()
     {
-        if (updateThread.joinable())
-        {
-            updateThread.join();
-        }
-        for (std::thread &thread : threads)
+        // images of the previous list which are not requested yet are not needed any more
+        pendingImages.clear();
+
+        if (isVirtualizing)
         {
-            if (thread.joinable())
-            {
-                thread.join();
-            }
+            UpdateVirtualList();
+            Invalidate();
+            return;
         }
-        threads.clear();
 
         // updateThread = std::thread([this]
         //                            {
@@ -189,11 +237,6 @@ namespace xit::Drawing
                     listItem->SetShowLabel(ListViewType::ImageText == listViewType || ListViewType::Text == listViewType);
 
                     InsertChild(i, listItem);
-
-                    while (GetNumberOfRows() < GetChildCount())
-                    {
-                        SetRows(GetRows() + ",Auto");
-                    }
                 }
                 else
                 {
@@ -239,28 +282,23 @@ namespace xit::Drawing
                     SingleSelect(static_cast<int>(i));
                 }
 
-                threads.push_back(std::thread([this, listItem]
-                                              {
-                    if (App::IsClosing)
-                    {
-                        return;
-                    }
-                    listItem->SetImageSource(listItem->GetText()); 
-                    Invalidate(); }));
+                // the item is shown with its text right away, the image follows in LoadPendingImages
+                pendingImages.push_back(listItem);
 
                 i++;
             }
 
-            i = 0;
-
-            for (std::thread &thread : threads)
+            // a row per added child, the rows are parsed once and not once per item
+            size_t rowCount = GetNumberOfRows();
+            if (rowCount < GetChildCount())
             {
-                if (thread.joinable())
+                std::string rows = GetRows();
+                for (size_t row = rowCount; row < GetChildCount(); row++)
                 {
-                    thread.join();
+                    rows += rows.empty() ? "Auto" : ",Auto";
                 }
+                SetRows(rows);
             }
-            threads.clear();
 
             if (selectedIndex >= (int)items->size())
             {
@@ -293,6 +331,217 @@ namespace xit::Drawing
         // });
     }
 
+    void ListView::LoadPendingImages()
+    {
+        if (pendingImages.empty())
+            return;
+
+        Rectangle viewport(GetLeft(), GetTop(), GetActualWidth(), GetActualHeight());
+        size_t count = 0;
+
+        // rows inside the viewport first, the others when the visible ones are requested
+        for (int pass = 0; pass < 2; pass++)
+        {
+            for (ListItem *&listItem : pendingImages)
+            {
+                if (count >= MaxImagesPerUpdate || GetPendingImageLoadCount() >= MaxPendingImageLoads)
+                    break;
+
+                if (listItem == nullptr)
+                    continue;
+
+                if (pass == 0)
+                {
+                    Rectangle itemBounds(listItem->GetLeft(), listItem->GetTop(), listItem->GetActualWidth(), listItem->GetActualHeight());
+
+                    if (listItem->GetVisibility() != Visibility::Visible || !viewport.IntersectsWith(itemBounds))
+                        continue;
+                }
+
+                // decoding happens in the TextureLoader, the item is invalidated when the image is uploaded
+                listItem->SetImageSource(listItem->GetText());
+                listItem = nullptr;
+                count++;
+            }
+        }
+
+        std::erase(pendingImages, nullptr);
+    }
+
+    int ListView::GetItemHeightInPixels() const
+    {
+        if (itemHeight > 0)
+            return std::max(1, static_cast<int>(static_cast<float>(itemHeight) * GetScaleY()));
+
+        if (estimatedItemHeight > 0)
+            return estimatedItemHeight;
+
+        // nothing is laid out yet, the first layout corrects the estimate
+        return std::max(1, static_cast<int>(static_cast<float>(UIDefaults::DefaultItemHeight) * GetScaleY()));
+    }
+
+    ListItem *ListView::GetRealizedContainer(int index)
+    {
+        auto it = std::find(realizedItems.begin(), realizedItems.end(), index);
+
+        if (index == -1 || it == realizedItems.end())
+            return nullptr;
+
+        return (ListItem *)GetChildAt(static_cast<size_t>(std::distance(realizedItems.begin(), it)));
+    }
+
+    void ListView::UpdateVirtualList()
+    {
+        virtualItems.clear();
+        virtualItemIndices.clear();
+
+        int itemCount = 0;
+
+        if (items != nullptr)
+        {
+            for (const std::string &item : *items)
+            {
+                if (FilterItem(item))
+                {
+                    virtualItems.push_back(&item);
+                    virtualItemIndices.push_back(itemCount);
+                }
+                itemCount++;
+            }
+        }
+
+        if (selectedIndex >= itemCount)
+        {
+            selectedIndex = itemCount - 1;
+            selectedValue = selectedIndex == -1 ? std::string() : *std::next(items->begin(), selectedIndex);
+        }
+
+        // the items may have changed behind the same indices, so all containers get their text again
+        realizedItems.assign(GetChildCount(), -1);
+        RealizeItems(GetActualHeight());
+    }
+
+    void ListView::RealizeItems(int viewportHeight)
+    {
+        int spacing = GetRowSpacing();
+        int stride = GetItemHeightInPixels() + spacing;
+        size_t count = virtualItems.size();
+
+        // two more for the rows only partly inside the viewport
+        size_t visibleCount = static_cast<size_t>(std::max(viewportHeight, 0) / stride) + 2;
+        size_t realizedCount = std::min(count, visibleCount + 2 * VirtualizationOverscan);
+
+        int offset = static_cast<int>(static_cast<float>(GetVerticalOffset()) * GetScaleY());
+        size_t first = static_cast<size_t>(std::max(offset / stride - static_cast<int>(VirtualizationOverscan), 0));
+        first = std::min(first, count - realizedCount);
+
+        // containers created before the list view became virtualizing are reused as well
+        realizedItems.resize(GetChildCount(), -1);
+
+        while (GetChildCount() < realizedCount)
+        {
+            ListItem *listItem = GetContainerForItemOverride();
+            listItem->SetShowImage(ListViewType::Image == listViewType || ListViewType::ImageText == listViewType);
+            listItem->SetShowLabel(ListViewType::ImageText == listViewType || ListViewType::Text == listViewType);
+            listItem->IsActiveChanged.Add(&ListView::ListViewItem_ActiveChanged, this);
+
+            AddChild(listItem);
+            realizedItems.push_back(-1);
+        }
+
+        // fixed rows stand in for the items before and after the realized ones, so the extent stays
+        // the one of the whole list and the realized items are placed where they are scrolled to
+        std::string rows;
+        size_t firstRow = 0;
+
+        int topHeight = static_cast<int>(first) * stride - spacing;
+        if (topHeight > 0)
+        {
+            rows = std::to_string(topHeight);
+            firstRow = 1;
+        }
+
+        for (size_t i = 0; i < realizedCount; i++)
+        {
+            rows += rows.empty() ? "Auto" : ",Auto";
+        }
+
+        int bottomHeight = static_cast<int>(count - first - realizedCount) * stride - spacing;
+        if (bottomHeight > 0)
+        {
+            rows += rows.empty() ? std::to_string(bottomHeight) : "," + std::to_string(bottomHeight);
+        }
+
+        if (rows.empty())
+        {
+            rows = "Auto";
+        }
+
+        if (rows != GetRows())
+        {
+            SetRows(rows);
+        }
+
+        selectedChildren.clear();
+
+        for (size_t i = 0; i < realizedItems.size(); i++)
+        {
+            ListItem *listItem = (ListItem *)GetChildAt(i);
+
+            if (listItem == nullptr)
+                continue;
+
+            if (i >= realizedCount)
+            {
+                realizedItems[i] = -1;
+
+                if (listItem->GetVisibility() != Visibility::Collapsed)
+                {
+                    listItem->SetIsActive(false);
+                    listItem->SetVisibility(Visibility::Collapsed);
+                }
+                continue;
+            }
+
+            int index = virtualItemIndices[first + i];
+            listItem->SetRow(firstRow + i);
+
+            if (realizedItems[i] != index)
+            {
+                realizedItems[i] = index;
+
+                const std::string &item = *virtualItems[first + i];
+                listItem->SetText(item);
+                listItem->SetVisibility(Visibility::Visible);
+
+                if (ListViewType::Image == listViewType)
+                    listItem->SetToolTip(item);
+
+                if (ListViewType::Text != listViewType)
+                {
+                    // do not show the image of the previous item until the new one is requested
+                    listItem->SetImageSource(std::string());
+
+                    if (std::find(pendingImages.begin(), pendingImages.end(), listItem) == pendingImages.end())
+                        pendingImages.push_back(listItem);
+                }
+            }
+
+            if (index == selectedIndex)
+            {
+                // added first, so activating the container does not change the selection
+                selectedChildren.push_back(listItem);
+                listItem->SetIsActive(true);
+            }
+            else
+            {
+                listItem->SetIsActive(false);
+            }
+        }
+
+        SetExtentHeight(count > 0 ? static_cast<int>(count) * stride - spacing : 0);
+    }
+
     void ListView::UpdateListViewType()
     {
         // this version should be faster than the commented one
@@ -335,7 +584,20 @@ namespace xit::Drawing
 
         selectedChildren.clear();
 
-        if (index != -1)
+        if (index != -1 && isVirtualizing)
+        {
+            // the item may not be realized, it is activated when it is scrolled into the viewport
+            ListItem *listItem = GetRealizedContainer(index);
+            if (listItem != nullptr)
+            {
+                selectedChildren.push_back(listItem);
+                listItem->SetIsActive(true);
+                listItem->Focus();
+            }
+
+            HandleSelectionChanged(&selectedChildren);
+        }
+        else if (index != -1)
         {
             int childIndex = index + headerItemCount;
 
@@ -367,11 +629,41 @@ namespace xit::Drawing
         ScrollItemIntoView();
     }
 
+    void ListView::OnUpdate(const Rectangle &bounds)
+    {
+        // scrolling invalidates the content, so this is where containers are moved to the items in view
+        if (isVirtualizing)
+            RealizeItems(bounds.GetHeight());
+
+        ScrollViewer::OnUpdate(bounds);
+
+        if (isVirtualizing && itemHeight <= 0 && !realizedItems.empty() && realizedItems[0] != -1)
+        {
+            int actualHeight = GetChildAt(0)->GetActualHeight();
+
+            // the estimate was wrong, the rows standing in for the other items are resized with the next layout
+            if (actualHeight > 0 && actualHeight != estimatedItemHeight)
+            {
+                estimatedItemHeight = actualHeight;
+                Invalidate();
+            }
+        }
+
+        // the rows are laid out now, so we know which of them are visible.
+        // Requested images invalidate their items when they are uploaded, which brings us back here.
+        LoadPendingImages();
+    }
+
     ListItem *ListView::GetContainerForItemOverride()
     {
         return new ListItem();
     }
 
+    size_t ListView::GetPendingImageLoadCount() const
+    {
+        return TextureLoader::GetPendingLoadCount();
+    }
+
     void ListView::OnKeyDown(KeyEventArgs &e)
     {
         // TODO this event is no loger called. Check why!
@@ -425,6 +717,19 @@ namespace xit::Drawing
 
     void ListView::ApplyFilter()
     {
+        if (isVirtualizing)
+        {
+            UpdateVirtualList();
+
+            if (!virtualItems.empty() && !selectedValue.empty() &&
+                !std::binary_search(virtualItemIndices.begin(), virtualItemIndices.end(), selectedIndex))
+            {
+                SetSelectedIndex(virtualItemIndices.front());
+                ScrollItemIntoView();
+            }
+            return;
+        }
+
         if (filter != nullptr)
         {
             visibleItems.clear();
@@ -487,12 +792,32 @@ namespace xit::Drawing
             return;
         }
 
-        auto it = std::find(visibleItems.begin(), visibleItems.end(), selectedValue);
+        int index = -1;
+        double itemHeight = 0;
 
-        if (it != visibleItems.end())
+        if (isVirtualizing)
+        {
+            auto it = std::lower_bound(virtualItemIndices.begin(), virtualItemIndices.end(), selectedIndex);
+
+            if (it != virtualItemIndices.end() && *it == selectedIndex)
+            {
+                index = static_cast<int>(std::distance(virtualItemIndices.begin(), it));
+                itemHeight = GetItemHeightInPixels();
+            }
+        }
+        else
+        {
+            auto it = std::find(visibleItems.begin(), visibleItems.end(), selectedValue);
+
+            if (it != visibleItems.end())
+            {
+                index = static_cast<int>(std::distance(visibleItems.begin(), it));
+                itemHeight = GetChildAt(0)->GetActualHeight();
+            }
+        }
+
+        if (index != -1)
         {
-            int index = static_cast<int>(std::distance(visibleItems.begin(), it));
-            double itemHeight = GetChildAt(0)->GetActualHeight();
             double itemTop = (itemHeight * index) + (GetRowSpacing() * index);
             double itemBottom = itemTop + itemHeight;
 
@@ -515,6 +840,12 @@ namespace xit::Drawing
             return;
         }
 
+        if (isVirtualizing)
+        {
+            ApplyFilter();
+            return;
+        }
+
         int i = 0;
         for (std::string item : *items)
         {
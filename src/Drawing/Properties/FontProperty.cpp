@@ -6,16 +6,28 @@ namespace xit::Drawing
     FontProperty::FontProperty()
         : fontName(UIDefaults::DefaultFont),
           fontSize(0),
+          fontScale(1.0f),
           needMeasureFont(true)
     {
         SetFontSize(UIDefaults::DefaultFontSize);
     }
 
+    void FontProperty::SetFontScale(float value)
+    {
+        if (fontScale != value)
+        {
+            fontScale = value;
+            fontHandle = FontHandle();
+            needMeasureFont = true;
+        }
+    }
+
     void FontProperty::SetFontName(const std::string &value)
     {
         if (fontName != value)
         {
             fontName = value;
+            fontHandle = FontHandle();
             needMeasureFont = true;
         }
     }
@@ -25,8 +37,18 @@ namespace xit::Drawing
         if (fontSize != value)
         {
             fontSize = value;
+            fontHandle = FontHandle();
             needMeasureFont = true;
             OnFontSizeChanged();
         }
     }
-}
\ No newline at end of file
+
+    const FontHandle &FontProperty::GetFontHandle()
+    {
+        // resolved lazily, the font can only be loaded with an OpenGL context
+        if (!FontStorage::IsCurrent(fontHandle))
+            fontHandle = FontStorage::Resolve(fontName, GetScaledFontSize());
+
+        return fontHandle;
+    }
+}
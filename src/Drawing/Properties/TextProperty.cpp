@@ -34,6 +34,27 @@ namespace xit::Drawing
         }
     }
 
+    void TextProperty::ReplaceText(size_t index, size_t removedLength, const std::string &value)
+    {
+        text.replace(index, removedLength, value);
+        needMeasureText = true;
+        OnTextChanged();
+    }
+
+    void TextProperty::EraseText()
+    {
+        if (text.empty())
+            return;
+
+        volatile char *data = text.data();
+        for (size_t i = 0; i < text.size(); i++)
+            data[i] = 0;
+
+        text.clear();
+        needMeasureText = true;
+        OnTextChanged();
+    }
+
     void TextProperty::SetTextWrapping(const TextWrapping &value)
     {
         if (textWrapping != value)
@@ -105,6 +105,7 @@ namespace xit::Drawing
     {
         bool updateSize = GetNeedWidthRecalculation() || GetNeedHeightRecalculation();
         bool updateLocations = GetNeedLeftRecalculation() || GetNeedTopRecalculation();
+        bool updateChildren = GetNeedChildLayout();
 
         InputContent::OnUpdate(bounds);
 
@@ -126,7 +127,7 @@ namespace xit::Drawing
 
         grid.SetBounds(stored);
 
-        if (updateSize || updateLocations)
+        if (updateSize || updateLocations || updateChildren)
         {
             if (orientation == Drawing::Orientation::Horizontal)
             {
@@ -9,15 +9,6 @@
 
 namespace xit::Drawing
 {
-    void SecureClear(void *ptr, size_t size)
-    {
-        volatile unsigned char *p = reinterpret_cast<volatile unsigned char *>(ptr);
-        while (size--)
-        {
-            *p++ = 0;
-        }
-    }
-
     //******************************************************************************
     // Properties
     //******************************************************************************
@@ -64,21 +55,15 @@ namespace xit::Drawing
 
     void TextBox::SetText(const std::string &value)
     {
-        if (isEditEnabled && (internalText != value))
+        if (isEditEnabled && !textBuffer.Equals(value))
         {
-            // For password fields, securely erase old content before setting new text
-            if (isPassword)
-            {
-                Erase();
-            }
-
             size_t valueLength = value.length();
-            size_t oldTextLength = internalText.length();
+            size_t oldTextLength = textLength;
 
-            if (oldTextLength != 0)
-                internalText.clear();
+            // the buffer keeps removed text until it is erased, which matters for passwords
+            Erase();
 
-            internalText = valueLength ? value : "";
+            textBuffer.Insert(0, value);
             textLength = valueLength;
             UpdateVisibleText();
 
@@ -179,9 +164,6 @@ namespace xit::Drawing
         SetClipToBounds(true);
         SetUseOrientation(false);
 
-        internalText = "";
-        viewText = "";
-
         SetColumns("*");
         SetRows("*");
 
@@ -248,13 +230,16 @@ namespace xit::Drawing
         SetIsError(
             !invalidCharacters.empty() &&
             invalidCharactersLength > 0 &&
-            internalText.find_first_of(invalidCharacters) != std::string::npos);
+            textBuffer.ContainsAny(invalidCharacters));
     }
 
     void TextBox::CaretBlink(EventArgs &e)
     {
         isCaretVisible = !isCaretVisible;
-        Invalidate();
+
+        // only the caret visibility changed, repaint without laying out again
+        InvalidateRenderCommands();
+        NotifyWindowOfInvalidation();
     }
     void TextBox::UpdateCaret()
     {
@@ -267,7 +252,7 @@ namespace xit::Drawing
 
         std::cout << "[DEBUG] UpdateCaret() - caretIndex=" << caretIndex << ", textLength=" << textLength << std::endl;
         std::cout << "[DEBUG] UpdateCaret() - totalSize.GetWidth()=" << totalSize.GetWidth() << std::endl;
-        std::cout << "[DEBUG] UpdateCaret() - fullTextToMeasure='" << fullTextToMeasure << "' (using viewText)" << std::endl;
+        std::cout << "[DEBUG] UpdateCaret() - fullTextToMeasure='" << fullTextToMeasure << "' (using textLabel)" << std::endl;
         std::cout << "[DEBUG] UpdateCaret() - alignment=" << (int)GetTextAlignment() << " (0=Left, 1=Center, 2=Right, 3=Stretch)" << std::endl;
 #endif
 
@@ -275,9 +260,7 @@ namespace xit::Drawing
 
         if (caretIndex > 0 && GetIsVisible())
         {
-            Size size;
-            Label::MeasureText(GetFontName(), GetFontSize(), viewText.substr(0, caretIndex), size);
-            left = size.GetWidth();
+            left = GetTextRun().GetX(caretIndex);
         }
         else
         {
@@ -319,6 +302,10 @@ namespace xit::Drawing
 
         caret.SetMargin((offset + left), 0, 0, 0);
 
+        // the caret is no child, make sure the next layout pass visits us to move it
+        SetNeedChildLayout();
+        NotifyParentOfChildLayout();
+
 #ifdef DEBUG_TEXTBOX
         std::cout << "[DEBUG] UpdateCaret() - FINAL: Setting caret margin to " << (offset + left) << std::endl;
         std::cout << "[DEBUG] UpdateCaret() - ===========================================" << std::endl;
@@ -344,14 +331,16 @@ namespace xit::Drawing
             int offset = 0;
             int left = 0;
 
+            const TextRun &run = GetTextRun();
+
             Size size;
-            Label::MeasureText(GetFontName(), GetFontSize(), viewText.substr(selectionStart, selectionLength), size);
+            size.SetWidth(run.GetWidth(selectionStart, selectionLength));
 
             selectionBorder.SetWidth(size.GetWidth() + 1);
 
             if (selectionStart != 0)
             {
-                Label::MeasureText(GetFontName(), GetFontSize(), viewText.substr(0, selectionStart), size);
+                size.SetWidth(run.GetX(selectionStart));
                 left = size.GetWidth();
             }
 
@@ -437,45 +426,42 @@ namespace xit::Drawing
 
     size_t TextBox::GetMouseCharacterIndex(int mouseXPosition)
     {
-        size_t index = 0;
-        int closest = 0;
-
         Size size = textLabel.MeasureText();
         if (mouseXPosition >= size.GetWidth())
         {
-            index = textLength;
-            return index;
+            return textLength;
         }
 
-        for (size_t i = 0; i <= textLength; i++)
-        {
-            Label::MeasureText(GetFontName(), GetFontSize(), viewText.substr(0, i), size);
+        // the closest caret position, a binary search over the caret positions of the run
+        return GetTextRun().GetIndex(mouseXPosition);
+    }
 
-            if (size.GetWidth() < mouseXPosition)
-            {
-                closest = size.GetWidth();
-                index = i;
-            }
-            else
-            {
-                if (std::abs(size.GetWidth() - mouseXPosition) < std::abs(closest - mouseXPosition))
-                {
-                    index = i;
-                }
-                break;
-            }
-        }
+    const TextRun &TextBox::GetTextRun()
+    {
+        textRun.Update(textLabel.GetFontHandle(), textLabel.GetText());
+        return textRun;
+    }
+
+    void TextBox::UpdateTextSize()
+    {
+        // the run measured the text already, the label does not measure it again
+        const FontHandle &font = textLabel.GetFontHandle();
+        if (!font.IsInitialized() || !textRun.IsValid(font))
+            return;
 
-        return index;
+        if (textLabel.GetText().empty())
+            textLabel.SetTextSize(Size(0, textLabel.GetScaledFontSize()));
+        else
+            textLabel.SetTextSize(Size(textRun.GetWidth(), font.GetCharacterList().GetFontHeight() * (int)textRun.GetLineCount()));
     }
 
     void TextBox::UpdateTextHintLabel()
     {
 #ifdef DEBUG_TEXTBOX
-        std::cout << "[DEBUG] UpdateTextHintLabel() called, internalText.empty()=" << internalText.empty() << std::endl;
+        std::cout << "[DEBUG] UpdateTextHintLabel() called, textBuffer.IsEmpty()=" << textBuffer.IsEmpty() << std::endl;
 #endif
 
-        if (internalText.empty())
+        if (textBuffer.IsEmpty())
         {
             textHintLabel.SetFontSize(UIDefaults::DefaultFontSize);
             textHintLabel.SetVerticalAlignment(VerticalAlignment::Center);
@@ -495,7 +481,7 @@ namespace xit::Drawing
         std::cout << "[DEBUG] textLabel VerticalAlignment: " << (int)textLabel.GetVerticalAlignment() << std::endl;
         std::cout << "[DEBUG] textHintLabel VerticalAlignment: " << (int)textHintLabel.GetVerticalAlignment() << std::endl;
 #endif
-        // textHintLabel.SetVisibility(internalText.empty() ? Visibility::Visible : Visibility::Collapsed);
+        // textHintLabel.SetVisibility(textBuffer.IsEmpty() ? Visibility::Visible : Visibility::Collapsed);
     }
 
     void TextBox::UpdateVisibleText()
@@ -503,31 +489,43 @@ namespace xit::Drawing
 #ifdef DEBUG_TEXTBOX
         std::cout << "[DEBUG] UpdateVisibleText() called" << std::endl;
         std::cout << "[DEBUG] isPassword=" << isPassword << ", textLength=" << textLength << std::endl;
-        std::cout << "[DEBUG] internalText='" << internalText << "'" << std::endl;
+        std::cout << "[DEBUG] textBuffer='" << textBuffer.ToString() << "'" << std::endl;
 #endif
 
         if (showPasswordButton.GetIsActive() || !isPassword)
         {
-            viewText = internalText;
+            textLabel.SetText(textBuffer.ToString());
 #ifdef DEBUG_TEXTBOX
-            std::cout << "[DEBUG] Using internalText: '" << viewText << "'" << std::endl;
+            std::cout << "[DEBUG] Using textBuffer: '" << textLabel.GetText() << "'" << std::endl;
 #endif
         }
         else
         {
-            viewText = textLength > 0 ? std::string(textLength, PasswordCharacter) : "";
+            textLabel.SetText(std::string(textLength, PasswordCharacter));
 #ifdef DEBUG_TEXTBOX
-            std::cout << "[DEBUG] Using asterisks: '" << viewText << "'" << std::endl;
+            std::cout << "[DEBUG] Using asterisks: '" << textLabel.GetText() << "'" << std::endl;
 #endif
         }
 
-        textLabel.SetText(viewText);
+        textRun.Invalidate();
         UpdateCaret();
 
 #ifdef DEBUG_TEXTBOX
         std::cout << "[DEBUG] UpdateVisibleText() complete" << std::endl;
 #endif
     }
+    void TextBox::UpdateVisibleText(size_t index, size_t removedLength, size_t insertedLength)
+    {
+        // patches only the edited characters of the label, the caret positions of the other lines are kept
+        if (showPasswordButton.GetIsActive() || !isPassword)
+            textLabel.ReplaceText(index, removedLength, textBuffer.GetText(index, insertedLength));
+        else
+            textLabel.ReplaceText(index, removedLength, std::string(insertedLength, PasswordCharacter));
+
+        textRun.Edit(textLabel.GetFontHandle(), textLabel.GetText(), index, removedLength, insertedLength);
+        UpdateTextSize();
+        UpdateCaret();
+    }
     void TextBox::ShowPasswordButton_ActiveChanged(IsActiveProperty &sender, EventArgs &e)
     {
         UpdateVisibleText();
@@ -557,7 +555,7 @@ namespace xit::Drawing
         {
             if (selectionLength > 0)
             {
-                std::string selection = internalText.substr(selectionStart, selectionLength);
+                std::string selection = textBuffer.GetText(selectionStart, selectionLength);
                 if (!selection.empty())
                 {
                     Clipboard::SetText(selection);
@@ -566,7 +564,7 @@ namespace xit::Drawing
             }
             else if (textLength > 0)
             {
-                std::string selection = internalText.substr(0, textLength);
+                std::string selection = textBuffer.GetText(0, textLength);
                 if (!selection.empty())
                 {
                     Clipboard::SetText(selection);
@@ -578,13 +576,13 @@ namespace xit::Drawing
         {
             if (selectionLength > 0)
             {
-                std::string selection = internalText.substr(selectionStart, selectionLength);
+                std::string selection = textBuffer.GetText(selectionStart, selectionLength);
                 if (!selection.empty())
                 {
                     Clipboard::SetText(selection);
                     TextChangedEventArgs tce(0, 0, isSelection ? selectionLength : 1, selectionStart);
 
-                    std::string removedText = internalText.substr(tce.RemovedOffset, tce.RemovedLength);
+                    std::string removedText = textBuffer.GetText(tce.RemovedOffset, tce.RemovedLength);
                     auto command = std::make_unique<TextInsertCommand>(this, tce.RemovedOffset, removedText, true);
                     undoRedoManager.SetNextCommand(std::move(command));
 
@@ -599,10 +597,10 @@ namespace xit::Drawing
             }
             else if (textLength > 0)
             {
-                Clipboard::SetText(internalText);
+                Clipboard::SetText(textBuffer.ToString());
                 TextChangedEventArgs tce(0, 0, isSelection ? selectionLength : 1, selectionStart);
 
-                std::string removedText = internalText.substr(tce.RemovedOffset, tce.RemovedLength);
+                std::string removedText = textBuffer.GetText(tce.RemovedOffset, tce.RemovedLength);
                 auto command = std::make_unique<TextInsertCommand>(this, tce.RemovedOffset, removedText, true);
                 undoRedoManager.SetNextCommand(std::move(command));
 
@@ -630,7 +628,7 @@ namespace xit::Drawing
                 {
                     TextChangedEventArgs tce(selectionLength, selectionStart, 0, 0);
 
-                    std::string removedText = internalText.substr(tce.RemovedOffset, tce.RemovedLength);
+                    std::string removedText = textBuffer.GetText(tce.RemovedOffset, tce.RemovedLength);
                     auto command = std::make_unique<TextInsertCommand>(this, tce.RemovedOffset, removedText, true);
                     undoRedoManager.SetNextCommand(std::move(command));
 
@@ -643,7 +641,7 @@ namespace xit::Drawing
                 // {
                 //     TextChangedEventArgs tce(0, 0, textLength, 0);
 
-                //     std::string removedText = internalText.substr(tce.RemovedOffset, tce.RemovedLength);
+                //     std::string removedText = textBuffer.GetText(tce.RemovedOffset, tce.RemovedLength);
                 //     auto command = std::make_unique<TextInsertCommand>(this, tce.RemovedOffset, removedText, true);
                 //     undoRedoManager.SetNextCommand(std::move(command));
 
@@ -755,7 +753,7 @@ namespace xit::Drawing
                 {
                     TextChangedEventArgs tce(0, 0, isSelection ? selectionLength : 1, selectionStart = isSelection ? selectionStart : caretIndex - 1);
 
-                    std::string removedText = internalText.substr(tce.RemovedOffset, tce.RemovedLength);
+                    std::string removedText = textBuffer.GetText(tce.RemovedOffset, tce.RemovedLength);
                     auto command = std::make_unique<TextInsertCommand>(this, tce.RemovedOffset, removedText, true);
                     undoRedoManager.SetNextCommand(std::move(command));
 
@@ -780,7 +778,7 @@ namespace xit::Drawing
                 {
                     TextChangedEventArgs tce(0, 0, isSelection ? selectionLength : 1, selectionStart);
 
-                    std::string removedText = internalText.substr(tce.RemovedOffset, tce.RemovedLength);
+                    std::string removedText = textBuffer.GetText(tce.RemovedOffset, tce.RemovedLength);
                     auto command = std::make_unique<TextInsertCommand>(this, tce.RemovedOffset, removedText, true);
                     undoRedoManager.SetNextCommand(std::move(command));
 
@@ -1176,38 +1174,33 @@ namespace xit::Drawing
 
     void TextBox::Insert(size_t index, const std::string &s)
     {
-        size_t sLength = s.length();
-        std::string tmp;
+        if (s.empty())
+            return;
 
-        tmp = internalText.insert(index, s);
-        internalText = tmp;
-        textLength += sLength;
+        index = std::min(index, textLength);
 
-        UpdateVisibleText();
+        textBuffer.Insert(index, s);
+        textLength = textBuffer.GetLength();
+
+        UpdateVisibleText(index, 0, s.length());
     }
     void TextBox::Insert(size_t index, char c)
     {
-        std::string tmp;
-        size_t sLength = 1;
-
         if (c == 0)
             return;
 
-        tmp = internalText.insert(index, 1, c);
-        internalText = tmp;
-        textLength += sLength;
-
-        UpdateVisibleText();
+        Insert(index, std::string(1, c));
     }
     void TextBox::Remove(size_t index, size_t count)
     {
-        if (index < textLength && index >= 0)
+        if (index < textLength)
         {
-            std::string tmp = internalText.substr(0, index) + internalText.substr(index + count);
-            internalText = tmp;
-            textLength = internalText.length();
+            count = std::min(count, textLength - index);
 
-            UpdateVisibleText();
+            textBuffer.Remove(index, count);
+            textLength = textBuffer.GetLength();
+
+            UpdateVisibleText(index, count, 0);
         }
     }
     void TextBox::SelectAll()
@@ -1218,11 +1211,17 @@ namespace xit::Drawing
     }
     void TextBox::Erase()
     {
-        if (!internalText.empty())
-        {
-            SecureClear(&internalText[0], internalText.size()); // Securely overwrite memory
-        }
-        internalText.clear(); // Clear the string
-        textLength = 0;       // Reset text length to match cleared content
+        textBuffer.Erase(); // Securely overwrite the text, also the removed one
+        textLength = 0;     // Reset text length to match cleared content
+
+        // the label holds the plain text unless it is masked
+        textLabel.EraseText();
+        textRun.Invalidate();
+
+        caretIndex = 0;
+        selectionStart = 0;
+        selectionLength = 0;
+        UpdateCaret();
+        UpdateSelection();
     }
 }
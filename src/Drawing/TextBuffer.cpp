@@ -0,0 +1,440 @@
+#include <Drawing/TextBuffer.h>
+
+#include <algorithm>
+
+namespace xit::Drawing
+{
+    static void Overwrite(std::string &text)
+    {
+        volatile char *data = text.data();
+        for (size_t i = 0; i < text.size(); i++)
+            data[i] = 0;
+    }
+
+    TextBuffer::TextBuffer()
+        : characterCounts{},
+          root(None),
+          seed(0x9E3779B9u)
+    {
+    }
+
+    TextBuffer::~TextBuffer()
+    {
+        Erase();
+    }
+
+    //******************************************************************************
+    // Private
+    //******************************************************************************
+
+    size_t TextBuffer::CountNewLines(size_t start, size_t length) const
+    {
+        auto first = std::lower_bound(newLines.begin(), newLines.end(), start);
+        auto last = std::lower_bound(first, newLines.end(), start + length);
+        return (size_t)(last - first);
+    }
+
+    size_t TextBuffer::CreateNode(size_t start, size_t length)
+    {
+        // xorshift, the priorities only have to be spread evenly
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+
+        Node node{start, length, CountNewLines(start, length), 0, 0, seed, None, None};
+
+        size_t index;
+        if (!freeNodes.empty())
+        {
+            index = freeNodes.back();
+            freeNodes.pop_back();
+            nodes[index] = node;
+        }
+        else
+        {
+            index = nodes.size();
+            nodes.push_back(node);
+        }
+
+        Update(index);
+        return index;
+    }
+
+    void TextBuffer::FreeTree(size_t node)
+    {
+        if (node == None)
+            return;
+
+        FreeTree(nodes[node].Left);
+        FreeTree(nodes[node].Right);
+        freeNodes.push_back(node);
+    }
+
+    void TextBuffer::Update(size_t node)
+    {
+        Node &n = nodes[node];
+        n.SubtreeLength = SubtreeLength(n.Left) + n.Length + SubtreeLength(n.Right);
+        n.SubtreeNewLines = SubtreeNewLines(n.Left) + n.NewLines + SubtreeNewLines(n.Right);
+    }
+
+    void TextBuffer::Split(size_t node, size_t index, size_t &left, size_t &right)
+    {
+        if (node == None)
+        {
+            left = right = None;
+            return;
+        }
+
+        size_t leftLength = SubtreeLength(nodes[node].Left);
+        size_t pieceLength = nodes[node].Length;
+
+        if (index <= leftLength)
+        {
+            size_t l, r;
+            Split(nodes[node].Left, index, l, r);
+            nodes[node].Left = r;
+            Update(node);
+
+            left = l;
+            right = node;
+        }
+        else if (index >= leftLength + pieceLength)
+        {
+            size_t l, r;
+            Split(nodes[node].Right, index - leftLength - pieceLength, l, r);
+            nodes[node].Right = l;
+            Update(node);
+
+            left = node;
+            right = r;
+        }
+        else
+        {
+            // the index is inside the piece, its rest becomes the first node of the right part
+            size_t offset = index - leftLength;
+            size_t rest = CreateNode(nodes[node].Start + offset, pieceLength - offset);
+
+            nodes[node].Length = offset;
+            nodes[node].NewLines = CountNewLines(nodes[node].Start, offset);
+
+            size_t r = nodes[node].Right;
+            nodes[node].Right = None;
+            Update(node);
+
+            left = node;
+            right = Merge(rest, r);
+        }
+    }
+
+    size_t TextBuffer::Merge(size_t left, size_t right)
+    {
+        if (left == None)
+            return right;
+        if (right == None)
+            return left;
+
+        if (nodes[left].Priority > nodes[right].Priority)
+        {
+            size_t merged = Merge(nodes[left].Right, right);
+            nodes[left].Right = merged;
+            Update(left);
+            return left;
+        }
+
+        size_t merged = Merge(left, nodes[right].Left);
+        nodes[right].Left = merged;
+        Update(right);
+        return right;
+    }
+
+    bool TextBuffer::ExtendLast(size_t node, size_t start, size_t length)
+    {
+        if (node == None)
+            return false;
+
+        bool isExtended;
+
+        if (nodes[node].Right != None)
+        {
+            isExtended = ExtendLast(nodes[node].Right, start, length);
+        }
+        else if (nodes[node].Start + nodes[node].Length == start)
+        {
+            nodes[node].Length += length;
+            nodes[node].NewLines = CountNewLines(nodes[node].Start, nodes[node].Length);
+            isExtended = true;
+        }
+        else
+        {
+            isExtended = false;
+        }
+
+        if (isExtended)
+            Update(node);
+
+        return isExtended;
+    }
+
+    void TextBuffer::Reserve(size_t length)
+    {
+        if (length <= buffer.capacity())
+            return;
+
+        // grown by hand, append would free the old block with the text still in it
+        std::string grown;
+        grown.reserve(std::max(length, buffer.capacity() * 2));
+        grown.append(buffer);
+
+        buffer.swap(grown);
+        Overwrite(grown);
+    }
+
+    void TextBuffer::Append(size_t node, size_t index, size_t count, std::string &target) const
+    {
+        if (node == None || count == 0)
+            return;
+
+        const Node &n = nodes[node];
+        size_t leftLength = SubtreeLength(n.Left);
+        size_t pieceEnd = leftLength + n.Length;
+
+        if (index < leftLength)
+            Append(n.Left, index, std::min(count, leftLength - index), target);
+
+        if (index < pieceEnd && index + count > leftLength)
+        {
+            size_t from = index > leftLength ? index - leftLength : 0;
+            size_t to = std::min(index + count, pieceEnd) - leftLength;
+            target.append(buffer, n.Start + from, to - from);
+        }
+
+        if (index + count > pieceEnd)
+        {
+            size_t from = index > pieceEnd ? index - pieceEnd : 0;
+            Append(n.Right, from, index + count - pieceEnd - from, target);
+        }
+    }
+
+    bool TextBuffer::Equals(size_t node, const std::string &text, size_t &offset) const
+    {
+        if (node == None)
+            return true;
+
+        const Node &n = nodes[node];
+
+        if (!Equals(n.Left, text, offset))
+            return false;
+
+        if (text.compare(offset, n.Length, buffer, n.Start, n.Length) != 0)
+            return false;
+
+        offset += n.Length;
+        return Equals(n.Right, text, offset);
+    }
+
+    void TextBuffer::CountCharacters(size_t node, int sign)
+    {
+        if (node == None)
+            return;
+
+        const Node &n = nodes[node];
+
+        for (size_t i = n.Start; i < n.Start + n.Length; i++)
+            characterCounts[(unsigned char)buffer[i]] += (size_t)sign;
+
+        CountCharacters(n.Left, sign);
+        CountCharacters(n.Right, sign);
+    }
+
+    //******************************************************************************
+    // Public
+    //******************************************************************************
+
+    size_t TextBuffer::GetLineStart(size_t line) const
+    {
+        if (line == 0)
+            return 0;
+
+        // the line starts behind its preceding line break
+        size_t remaining = line;
+        size_t offset = 0;
+        size_t node = root;
+
+        while (node != None)
+        {
+            const Node &n = nodes[node];
+            size_t leftNewLines = SubtreeNewLines(n.Left);
+
+            if (remaining <= leftNewLines)
+            {
+                node = n.Left;
+                continue;
+            }
+
+            remaining -= leftNewLines;
+            offset += SubtreeLength(n.Left);
+
+            if (remaining <= n.NewLines)
+            {
+                size_t first = (size_t)(std::lower_bound(newLines.begin(), newLines.end(), n.Start) - newLines.begin());
+                return offset + newLines[first + remaining - 1] - n.Start + 1;
+            }
+
+            remaining -= n.NewLines;
+            offset += n.Length;
+            node = n.Right;
+        }
+
+        return GetLength();
+    }
+
+    size_t TextBuffer::GetLine(size_t index) const
+    {
+        size_t line = 0;
+        size_t node = root;
+
+        while (node != None)
+        {
+            const Node &n = nodes[node];
+            size_t leftLength = SubtreeLength(n.Left);
+
+            if (index < leftLength)
+            {
+                node = n.Left;
+                continue;
+            }
+
+            line += SubtreeNewLines(n.Left);
+            index -= leftLength;
+
+            if (index < n.Length)
+                return line + CountNewLines(n.Start, index);
+
+            line += n.NewLines;
+            index -= n.Length;
+            node = n.Right;
+        }
+
+        return line;
+    }
+
+    char TextBuffer::At(size_t index) const
+    {
+        size_t node = root;
+
+        while (node != None)
+        {
+            const Node &n = nodes[node];
+            size_t leftLength = SubtreeLength(n.Left);
+
+            if (index < leftLength)
+            {
+                node = n.Left;
+                continue;
+            }
+
+            index -= leftLength;
+
+            if (index < n.Length)
+                return buffer[n.Start + index];
+
+            index -= n.Length;
+            node = n.Right;
+        }
+
+        return 0;
+    }
+
+    bool TextBuffer::ContainsAny(const std::string &characters) const
+    {
+        for (char c : characters)
+        {
+            if (Count(c) > 0)
+                return true;
+        }
+
+        return false;
+    }
+
+    void TextBuffer::Insert(size_t index, const std::string &text)
+    {
+        if (text.empty())
+            return;
+
+        index = std::min(index, GetLength());
+
+        size_t start = buffer.size();
+        Reserve(start + text.length());
+        buffer.append(text);
+
+        for (size_t i = 0; i < text.length(); i++)
+        {
+            if (text[i] == '\n')
+                newLines.push_back(start + i);
+
+            characterCounts[(unsigned char)text[i]]++;
+        }
+
+        size_t left, right;
+        Split(root, index, left, right);
+
+        // typing appends behind the piece which was inserted last
+        if (!ExtendLast(left, start, text.length()))
+            left = Merge(left, CreateNode(start, text.length()));
+
+        root = Merge(left, right);
+    }
+
+    void TextBuffer::Remove(size_t index, size_t count)
+    {
+        size_t length = GetLength();
+
+        if (index >= length || count == 0)
+            return;
+
+        count = std::min(count, length - index);
+
+        size_t left, middle, right;
+        Split(root, index, left, middle);
+        Split(middle, count, middle, right);
+
+        CountCharacters(middle, -1);
+        FreeTree(middle);
+
+        root = Merge(left, right);
+    }
+
+    std::string TextBuffer::GetText(size_t index, size_t count) const
+    {
+        size_t length = GetLength();
+
+        index = std::min(index, length);
+        count = std::min(count, length - index);
+
+        std::string text;
+        text.reserve(count);
+        Append(root, index, count, text);
+        return text;
+    }
+
+    bool TextBuffer::Equals(const std::string &text) const
+    {
+        if (text.length() != GetLength())
+            return false;
+
+        size_t offset = 0;
+        return Equals(root, text, offset);
+    }
+
+    void TextBuffer::Erase()
+    {
+        // the buffer still holds removed text, e.g. deleted characters of a password
+        Overwrite(buffer);
+        buffer.clear();
+        newLines.clear();
+        nodes.clear();
+        freeNodes.clear();
+        characterCounts.fill(0);
+        root = None;
+    }
+}
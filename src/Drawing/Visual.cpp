@@ -17,19 +17,39 @@ namespace xit::Drawing
     // Constructor
     //******************************************************************************
 
+    std::atomic<size_t> Visual::treeGeneration = 1;
+
     Visual::Visual()
-        : tag(nullptr)
+        : tag(nullptr),
+          window(nullptr),
+          windowGeneration(0),
+          invalidationEpoch(0)
     {
     }
 
     Window *Visual::GetWindow()
     {
+        size_t generation = treeGeneration.load(std::memory_order_acquire);
+
+        // Walk up only after the tree has changed, invalidating is called far more often than parents change.
+        // Other threads, e.g. timers, walk up every time, the cache is not shared between threads.
+        bool isRenderThread = Window::IsRenderThread();
+        if (isRenderThread && windowGeneration == generation)
+            return window;
+
         Visual *current = this;
         while (current->GetParent() != nullptr)
         {
             current = static_cast<Visual *>(current->GetParent());
         }
-        return dynamic_cast<Window *>(current);
+        Window *found = dynamic_cast<Window *>(current);
+
+        if (isRenderThread)
+        {
+            window = found;
+            windowGeneration = generation;
+        }
+        return found;
     }
 
     //******************************************************************************
@@ -49,6 +69,12 @@ namespace xit::Drawing
         }
     }
 
+    void Visual::OnParentChanged(EventArgs &e)
+    {
+        // the window of this visual and of all its descendants may have changed
+        treeGeneration.fetch_add(1, std::memory_order_acq_rel);
+    }
+
     void Visual::NotifyWindowOfInvalidation()
     {
         // Notify the window about this child's invalidation for background buffer
@@ -78,6 +104,28 @@ namespace xit::Drawing
         }
     }
 
+    void Visual::NotifyParentOfChildLayout()
+    {
+        // Mark the whole path up to the window, the layout pass only descends into marked elements.
+        // Do not stop at an already marked parent, it may have been skipped (e.g. collapsed) and still be marked.
+        for (ParentProperty *current = GetParent(); current != nullptr; current = current->GetParent())
+        {
+            static_cast<Visual *>(current)->SetNeedChildLayout();
+        }
+    }
+
+    void Visual::NotifyParentOfDesiredSizeChange()
+    {
+        if (GetParent() != nullptr)
+        {
+#ifdef DEBUG_VISUAL
+            std::cout << "[DEBUG] Visual::NotifyParentOfDesiredSizeChange: " << GetName()
+                      << " desired size changed to " << desiredSize.GetWidth() << "x" << desiredSize.GetHeight() << std::endl;
+#endif
+            static_cast<Visual *>(GetParent())->InvalidateMeasure();
+        }
+    }
+
     //******************************************************************************
     // Protected
     //******************************************************************************
@@ -1,9 +1,12 @@
 #include <Drawing/VisualBase/LayoutManager.h>
 #include <OpenGL/Scene2D.h>
 #include <Drawing/DebugUtils.h>
+#include <OpenGL/Profiler.h>
 
 namespace xit::Drawing::VisualBase
 {
+    size_t LayoutManager::layoutPassCount = 0;
+
     //******************************************************************************
     // Public
     //******************************************************************************
@@ -14,6 +17,7 @@ namespace xit::Drawing::VisualBase
           needHeightRecalculation(true),
           needLeftRecalculation(true),
           needTopRecalculation(true),
+          needChildLayout(false),
           clientBounds(0, 0, 0, 0),
           desiredSize(),
           renderTop(0),
@@ -37,6 +41,7 @@ namespace xit::Drawing::VisualBase
             EventArgs e;
             OnInvalidated(e);
             NotifyWindowOfInvalidation();
+            NotifyParentOfChildLayout();
         }
         else
         {
@@ -46,6 +51,16 @@ namespace xit::Drawing::VisualBase
         }
     }
 
+    void LayoutManager::InvalidateMeasure()
+    {
+        needWidthRecalculation = true;
+        needHeightRecalculation = true;
+        // a new size moves elements with center, right or bottom alignment
+        needLeftRecalculation = true;
+        needTopRecalculation = true;
+        Invalidate();
+    }
+
     void LayoutManager::NotifyWindowOfInvalidation()
     {
         // This method will be overridden by Visual class to access the parent properly
@@ -70,7 +85,8 @@ namespace xit::Drawing::VisualBase
             bool boundsChanged = (bounds != newBounds);
 
             // Set recalculation flags for layout changes (bounds changed)
-            // if (boundsChanged)
+            // Invalidated elements are measured again because their content may have changed (like text updates)
+            if (boundsChanged || invalidated)
             {
                 needWidthRecalculation = true;
                 needHeightRecalculation = true;
@@ -87,8 +103,9 @@ namespace xit::Drawing::VisualBase
             }
 #endif
 
-            // Always update if invalidated (for visual refreshes) or if layout recalculation is needed
-            needRedraw = needLeftRecalculation || needTopRecalculation || needWidthRecalculation || needHeightRecalculation || invalidated || boundsChanged;
+            // Only update if invalidated, if layout recalculation is needed or if a descendant has to be laid out.
+            // Otherwise the whole subtree is unchanged and can be skipped.
+            needRedraw = needLeftRecalculation || needTopRecalculation || needWidthRecalculation || needHeightRecalculation || invalidated || boundsChanged || needChildLayout;
 
             if (needRedraw)
             {
@@ -100,8 +117,17 @@ namespace xit::Drawing::VisualBase
                           << " needWidth=" << needWidthRecalculation
                           << " needHeight=" << needHeightRecalculation << std::endl;
 #endif
+                Size oldDesiredSize = desiredSize;
+
                 this->bounds = newBounds;
                 OnUpdate(bounds);
+                layoutPassCount++;
+                Profiler::Count(ProfileCounter::LayoutArranges);
+
+                // New bounds come from the parent, which already measured us with them.
+                // Otherwise our content changed and the parent has to measure again.
+                if (!boundsChanged && oldDesiredSize != desiredSize)
+                    NotifyParentOfDesiredSizeChange();
             }
 #ifdef DEBUG_LAYOUT_MANAGER
             else
@@ -256,6 +282,9 @@ namespace xit::Drawing::VisualBase
         needWidthRecalculation = true;
         needHeightRecalculation = true;
         Invalidate();
+
+        // collapsed elements do not take any space, the parent has to measure again
+        NotifyParentOfDesiredSizeChange();
     }
 
     void LayoutManager::OnScaleChanged(EventArgs &e)
@@ -357,6 +386,8 @@ namespace xit::Drawing::VisualBase
         // TODO needWidthRecalculation still does not work correctly for MainMenuButtons.
         if (needWidthRecalculation)
         {
+            Profiler::Count(ProfileCounter::LayoutMeasures);
+
             if (this->GetWidth() > -1)
             {
                 // width is WITHOUT margin, padding and border, so do not subtract it here
@@ -433,6 +464,8 @@ namespace xit::Drawing::VisualBase
         // TODO needHeightRecalculation still does not work correctly for ToolTip and MainMenuButtons.
         if (needHeightRecalculation)
         {
+            Profiler::Count(ProfileCounter::LayoutMeasures);
+
             if (this->GetHeight() > -1)
             {
                 // height is WITHOUT margin, padding and border, so do not subtract it here
@@ -489,6 +522,10 @@ namespace xit::Drawing::VisualBase
 
     void LayoutManager::OnUpdate(const Rectangle &bounds)
     {
+        // Reset before the children are laid out, so children invalidated while
+        // laying them out are visited again by the next layout pass
+        needChildLayout = false;
+
         // Perform the core layout calculations
         if (PerformLayout(bounds))
         {
@@ -537,6 +574,11 @@ namespace xit::Drawing::VisualBase
             Size oldDesiredSize = desiredSize;
             desiredSize = Measure(s);
 
+            // Measure overrides (like Window) do not reset the flags themselves,
+            // a flag left set would lay out this element again on every frame
+            needWidthRecalculation = false;
+            needHeightRecalculation = false;
+
             // Check if content size changed significantly (this indicates layout change needed)
             bool contentSizeChanged = (oldDesiredSize.GetWidth() != desiredSize.GetWidth() ||
                                        oldDesiredSize.GetHeight() != desiredSize.GetHeight());
@@ -606,6 +648,10 @@ namespace xit::Drawing::VisualBase
             needTopRecalculation = false; // Reset after setting position
         }
 
+        // absolute positioned elements keep their location, nothing left to recalculate
+        needLeftRecalculation = false;
+        needTopRecalculation = false;
+
         if (updateLocation)
         {
             renderTop = Scene2D::CurrentScene().GetHeight() - GetTop() - actualHeight;
@@ -620,7 +666,7 @@ namespace xit::Drawing::VisualBase
                 renderLeft += GetMargin().GetLeft();
         }
 
-        if (updateLocation || needWidthRecalculation || needHeightRecalculation)
+        if (updateLocation || layoutChanged)
             clientBounds = GetClientRectangle(GetLeft(), GetTop(), actualWidth, actualHeight);
 
 #ifdef DEBUG_LAYOUT_MANAGER
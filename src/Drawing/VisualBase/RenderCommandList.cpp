@@ -0,0 +1,182 @@
+#include <Drawing/VisualBase/RenderCommandList.h>
+#include <Drawing/VisualBase/Renderable.h>
+#include <OpenGL/Text/GlyphAtlas.h>
+
+#include <algorithm>
+
+namespace xit::Drawing::VisualBase
+{
+    RenderCommandList *RenderCommandList::recording = nullptr;
+
+    RenderCommandList::RenderCommandList()
+        : sealedCommands(0),
+          glyphAtlasEvictions(0),
+          isValid(false)
+    {
+    }
+
+    //******************************************************************************
+    // Private
+    //******************************************************************************
+
+    RenderCommand &RenderCommandList::AddCommand(RenderCommandType type)
+    {
+        RenderCommand &command = commands.emplace_back();
+        command.Type = type;
+        command.Count = 0;
+        command.First = 0;
+        command.Bounds[0] = command.Bounds[1] = command.Bounds[2] = command.Bounds[3] = 0;
+        command.Texture = 0;
+        command.Child = nullptr;
+        return command;
+    }
+
+    bool RenderCommandList::CanAppendTo(RenderCommandType type) const
+    {
+        return commands.size() > sealedCommands && commands.back().Type == type;
+    }
+
+    void RenderCommandList::SetBounds(RenderCommand &command, const Rectangle &bounds)
+    {
+        command.Bounds[0] = bounds.GetLeft();
+        command.Bounds[1] = bounds.GetTop();
+        command.Bounds[2] = bounds.GetWidth();
+        command.Bounds[3] = bounds.GetHeight();
+    }
+
+    //******************************************************************************
+    // Public
+    //******************************************************************************
+
+    void RenderCommandList::BeginRecording()
+    {
+        Clear();
+        glyphAtlasEvictions = GlyphAtlas::GetEvictionCount();
+        recording = this;
+    }
+
+    void RenderCommandList::EndRecording()
+    {
+        recording = nullptr;
+        openClips.clear();
+        isValid = true;
+    }
+
+    bool RenderCommandList::GetIsValid() const
+    {
+        // evicted glyphs are overwritten in the atlas, the recorded positions point to other glyphs
+        return isValid && glyphAtlasEvictions == GlyphAtlas::GetEvictionCount();
+    }
+
+    void RenderCommandList::Clear()
+    {
+        commands.clear();
+        quads.clear();
+        quadTextures.clear();
+        glyphs.clear();
+        visuals.clear();
+        openClips.clear();
+        sealedCommands = 0;
+        isValid = false;
+    }
+
+    void RenderCommandList::AddQuad(const QuadInstance &quad, const OpenGL::Texture *texture)
+    {
+        if (!CanAppendTo(RenderCommandType::Quads))
+            AddCommand(RenderCommandType::Quads).First = quads.size();
+
+        quads.push_back(quad);
+        quadTextures.push_back(texture);
+        commands.back().Count++;
+    }
+
+    GlyphInstance &RenderCommandList::AddGlyph(GLuint texture)
+    {
+        if (!CanAppendTo(RenderCommandType::Glyphs) || commands.back().Texture != texture)
+        {
+            RenderCommand &command = AddCommand(RenderCommandType::Glyphs);
+            command.First = glyphs.size();
+            command.Texture = texture;
+        }
+
+        commands.back().Count++;
+        return glyphs.emplace_back();
+    }
+
+    void RenderCommandList::PushClip(const Rectangle &bounds)
+    {
+        openClips.push_back(commands.size());
+        SetBounds(AddCommand(RenderCommandType::PushClip), bounds);
+    }
+
+    void RenderCommandList::PopClip()
+    {
+        size_t index = openClips.back();
+        openClips.pop_back();
+
+        // nothing was drawn inside the clip
+        if (index == commands.size() - 1)
+        {
+            commands.pop_back();
+            sealedCommands = std::min(sealedCommands, commands.size());
+            return;
+        }
+
+        commands[index].Count = (int)(commands.size() - index - 1);
+        AddCommand(RenderCommandType::PopClip);
+    }
+
+    size_t RenderCommandList::BeginCull(const Rectangle &bounds)
+    {
+        size_t index = commands.size();
+        SetBounds(AddCommand(RenderCommandType::Cull), bounds);
+        return index;
+    }
+
+    void RenderCommandList::EndCull(size_t index)
+    {
+        int count = (int)(commands.size() - index - 1);
+
+        // e.g. a label with a transparent background and no text
+        if (count == 0)
+        {
+            commands.pop_back();
+            sealedCommands = std::min(sealedCommands, commands.size());
+            return;
+        }
+
+        commands[index].Count = count;
+
+        // the next draws belong to the parent, they must not be culled with this visual
+        sealedCommands = commands.size();
+    }
+
+    void RenderCommandList::AddChild(Renderable *child)
+    {
+        AddCommand(RenderCommandType::Child).Child = child;
+    }
+
+    void RenderCommandList::AddVisual(Renderable *visual)
+    {
+        // the slot is left over from another list or an earlier recording if it does not point back to the visual
+        size_t slot = visual->renderCommandsSlot;
+        if (slot < visuals.size() && visuals[slot] == visual)
+            return;
+
+        visual->renderCommandsSlot = visuals.size();
+        visuals.push_back(visual);
+    }
+
+    void RenderCommandList::RemoveVisual(Renderable *visual)
+    {
+        size_t slot = visual->renderCommandsSlot;
+        if (slot >= visuals.size() || visuals[slot] != visual)
+            return;
+
+        // swap with the last one, tearing down a container with many recorded children stays linear
+        Renderable *last = visuals.back();
+        visuals[slot] = last;
+        last->renderCommandsSlot = slot;
+        visuals.pop_back();
+    }
+}
@@ -1,15 +1,38 @@
 #include <Drawing/VisualBase/Renderable.h>
-#ifdef DEBUG_INITIALIZATION
-#include <chrono>
-#include <iostream>
-#endif
+#include <Drawing/VisualBase/RenderCommandList.h>
+#include <OpenGL/Profiler.h>
+#include <OpenGL/RenderLayer.h>
+#include <OpenGL/Text/TextRenderer.h>
 #ifdef DEBUG_VISUAL_STATES
 #include <iostream>
 #endif
 
 namespace xit::Drawing::VisualBase
 {
-    Renderable *Renderable::firstInvalidator = nullptr;
+    std::vector<Renderable *> Renderable::textureWaiters;
+    std::vector<Rectangle> Renderable::clipStack;
+
+    // Rectangle::Intersect allocates its result, this runs for every clipping visual of a frame
+    static Rectangle IntersectBounds(const Rectangle &a, const Rectangle &b)
+    {
+        int left = std::max(a.GetLeft(), b.GetLeft());
+        int top = std::max(a.GetTop(), b.GetTop());
+        int right = std::min(a.GetRight(), b.GetRight());
+        int bottom = std::min(a.GetBottom(), b.GetBottom());
+
+        if (right <= left || bottom <= top)
+            return Rectangle();
+
+        return Rectangle(left, top, right - left, bottom - top);
+    }
+
+    // the bounds of a recorded Cull command, a width of 0 is never culled
+    static bool IntersectsBounds(const int bounds[4], const Rectangle &clip)
+    {
+        return bounds[2] <= 0 ||
+               (bounds[0] < clip.GetRight() && clip.GetLeft() < bounds[0] + bounds[2] &&
+                bounds[1] < clip.GetBottom() && clip.GetTop() < bounds[1] + bounds[3]);
+    }
 
     Renderable::Renderable()
     {
@@ -25,6 +48,10 @@ namespace xit::Drawing::VisualBase
         isLayoutGroupChanging = false;
         backgroundTexture = nullptr;
         borderTexture = nullptr;
+        isWaitingForTexture = false;
+        renderCommands = nullptr;
+        renderCommandsOwner = nullptr;
+        renderCommandsSlot = 0;
 
         ThemeManager::ThemeChanged.Add(&Renderable::OnThemeChanged, this);
     }
@@ -37,6 +64,21 @@ namespace xit::Drawing::VisualBase
             delete[] foregroundColors;
         if (borderColors)
             delete[] borderColors;
+
+        if (isWaitingForTexture)
+            std::erase(textureWaiters, this);
+
+        // the owner would replay commands pointing to this visual
+        if (renderCommandsOwner)
+        {
+            renderCommandsOwner->RemoveVisual(this);
+            renderCommandsOwner->Invalidate();
+        }
+
+        SetCacheRenderCommands(false);
+
+        if (GetCacheMode() == CacheMode::Layer)
+            RenderLayer::Release(this);
     }
 
     void Renderable::SetClipToBounds(bool value)
@@ -44,7 +86,42 @@ namespace xit::Drawing::VisualBase
         // if (clipToBounds != value)
         {
             clipToBounds = value;
+            InvalidateRenderCommands();
+        }
+    }
+
+    void Renderable::SetCacheRenderCommands(bool value)
+    {
+        if (value == (renderCommands != nullptr))
+            return;
+
+        if (value)
+        {
+            renderCommands = new RenderCommandList();
+        }
+        else
+        {
+            for (Renderable *visual : renderCommands->GetVisuals())
+            {
+                if (visual->renderCommandsOwner == renderCommands)
+                    visual->renderCommandsOwner = nullptr;
+            }
+
+            delete renderCommands;
+            renderCommands = nullptr;
         }
+
+        // the owner recorded this visual inline or as a reference to its list
+        if (renderCommandsOwner)
+            renderCommandsOwner->Invalidate();
+    }
+
+    void Renderable::InvalidateRenderCommands()
+    {
+        if (renderCommands)
+            renderCommands->Invalidate();
+        else if (renderCommandsOwner)
+            renderCommandsOwner->Invalidate();
     }
 
     void Renderable::Render()
@@ -52,98 +129,253 @@ namespace xit::Drawing::VisualBase
         int actualWidth = GetActualWidth();
         int actualHeight = GetActualHeight();
 
-        if (GetIsVisible() && actualWidth > 0 && actualHeight > 0)
+        RenderCommandList *recording = RenderCommandList::GetRecording();
+        if (recording)
         {
-            int cachedRect[4] = {0};
-            GLboolean enabled = glIsEnabled(GL_SCISSOR_TEST);
+            // invisible visuals are remembered as well, they invalidate the list when they are shown
+            if (renderCommandsOwner != recording)
+            {
+                if (renderCommandsOwner)
+                {
+                    renderCommandsOwner->RemoveVisual(this);
+                    renderCommandsOwner->Invalidate();
+                }
+                renderCommandsOwner = recording;
+            }
+            recording->AddVisual(this);
 
+            // recorded again on its own, the owner only replays it and it checks its visibility then
+            if (renderCommands)
+                recording->AddChild(this);
+            else if (GetIsVisible() && actualWidth > 0 && actualHeight > 0)
+                RecordInto(recording, actualWidth, actualHeight);
+        }
+        else if (renderCommands)
+        {
+            if (GetIsVisible() && actualWidth > 0 && actualHeight > 0)
+            {
+                // the content of a layer is only replayed when it changed
+                if (GetCacheMode() == CacheMode::Layer && CompositeLayer(actualWidth, actualHeight))
+                    return;
+
+                if (!renderCommands->GetIsValid())
+                    RecordRenderCommands(actualWidth, actualHeight);
+
+                ReplayRenderCommands();
+            }
+        }
+        else if (GetIsVisible() && actualWidth > 0 && actualHeight > 0)
+        {
             if (clipToBounds) // this should set a Geometry.ClipToBounds value
             {
-                if (enabled == 1)
+                // nothing of the content would pass the scissor
+                if (!PushClipBounds(Rectangle(GetLeft(), GetTop(), actualWidth, actualHeight)))
                 {
-                    glGetIntegerv(GL_SCISSOR_BOX, cachedRect);
+                    PopClipBounds();
+                    return;
                 }
+            }
 
-#ifdef USE_AI_SUGGESTED_FIX
-                // FIXED: Improved coordinate conversion for scissor testing
-                // Ensure we use the current scene dimensions for coordinate conversion
-                const Scene2D &currentScene = Scene2D::CurrentScene();
-                int sceneHeight = currentScene.GetHeight();
-
-                // convert bounds to screen coordinates
-                Rectangle bounds = this->bounds;
-                bounds.SetTop(sceneHeight - bounds.GetTop() - bounds.GetHeight());
-
-                // Ensure coordinates are within valid scene bounds
-                int top = std::max(0, std::max(renderTop, bounds.GetTop()));
-                int left = std::max(0, std::max(renderLeft, bounds.GetLeft()));
-
-                // Calculate width and height with proper bounds checking
-                int maxRight = std::min(currentScene.GetWidth(), bounds.GetRight());
-                int maxBottom = std::min(sceneHeight, bounds.GetBottom());
-
-                int width = (left + actualWidth > maxRight) ? std::max(0, maxRight - left) : actualWidth;
-                int height = (top + actualHeight > maxBottom) ? std::max(0, maxBottom - top) : actualHeight;
-#else
-                // TODO something here is really wrong
-                // Left and top seem to be calculated wrong because some items are cut off
-
-                // convert bounds to screen coordinates
-                Rectangle bounds = this->bounds;
-                bounds.SetTop(Scene2D::CurrentScene().GetHeight() - bounds.GetTop() - bounds.GetHeight());
-
-                int top = std::max(renderTop, bounds.GetTop());
-                int left = std::max(renderLeft, bounds.GetLeft());
-                int width = left + actualWidth > bounds.GetRight() ? bounds.GetRight() - left : actualWidth;
-                int height = top + actualHeight > bounds.GetBottom() ? bounds.GetBottom() - top : actualHeight;
-#endif
+            OnRender();
 
-                if (enabled)
-                {
-                    left = std::max(left, cachedRect[0]);
-                    top = std::max(top, cachedRect[1]);
+            if (clipToBounds)
+            {
+                PopClipBounds();
+            }
+        }
+    }
 
-                    int lastXMax = cachedRect[0] + cachedRect[2];
-                    int myXMax = renderLeft + actualWidth;
+    void Renderable::RecordInto(RenderCommandList *recording, int actualWidth, int actualHeight)
+    {
+        // rotated visuals may reach out of their bounds and are never culled
+        const glm::vec3 &rotation = GetRotation();
+        bool isRotated = rotation.x != 0.0f || rotation.y != 0.0f || rotation.z != 0.0f;
 
-#ifdef USE_AI_SUGGESTED_FIX
-                    width = std::max(0, std::min(lastXMax, myXMax) - left);
-#else
-                    width = std::min(lastXMax, myXMax) - left;
-#endif
-                    int lastYMax = cachedRect[1] + cachedRect[3];
-                    int myYMax = renderTop + actualHeight;
+        Rectangle bounds(GetLeft(), GetTop(), actualWidth, actualHeight);
+        size_t cull = recording->BeginCull(isRotated ? Rectangle() : bounds);
 
-#ifdef USE_AI_SUGGESTED_FIX
-                    height = std::max(0, std::min(lastYMax, myYMax) - top);
-#else
-                    height = std::min(lastYMax, myYMax) - top;
-#endif
-                }
+        if (clipToBounds)
+            recording->PushClip(bounds);
 
-                if (width > 0 && height > 0)
-                {
-                    glScissor(left, top, width, height);
-                    glEnable(GL_SCISSOR_TEST);
-                }
+        OnRender();
+
+        if (clipToBounds)
+            recording->PopClip();
+
+        recording->EndCull(cull);
+    }
+
+    void Renderable::RecordRenderCommands(int actualWidth, int actualHeight)
+    {
+        // a glyph atlas evicted while recording invalidates the list again, record it a second time
+        for (int attempt = 0; attempt < 2 && !renderCommands->GetIsValid(); attempt++)
+        {
+            for (Renderable *visual : renderCommands->GetVisuals())
+            {
+                if (visual->renderCommandsOwner == renderCommands)
+                    visual->renderCommandsOwner = nullptr;
             }
 
+            renderCommands->BeginRecording();
+
+            if (clipToBounds)
+                renderCommands->PushClip(Rectangle(GetLeft(), GetTop(), actualWidth, actualHeight));
+
             OnRender();
 
-            if (clipToBounds || this == firstInvalidator)
+            if (clipToBounds)
+                renderCommands->PopClip();
+
+            renderCommands->EndRecording();
+        }
+    }
+
+    void Renderable::ReplayRenderCommands()
+    {
+        const std::vector<RenderCommand> &commands = renderCommands->GetCommands();
+        const std::vector<QuadInstance> &quads = renderCommands->GetQuads();
+        const std::vector<const OpenGL::Texture *> &quadTextures = renderCommands->GetQuadTextures();
+        const std::vector<GlyphInstance> &glyphs = renderCommands->GetGlyphs();
+
+        for (size_t i = 0; i < commands.size(); i++)
+        {
+            const RenderCommand &command = commands[i];
+
+            switch (command.Type)
             {
-                if (enabled == 0 || this == firstInvalidator)
-                {
-                    glDisable(GL_SCISSOR_TEST);
-                }
-                else
-                {
-                    glScissor(cachedRect[0], cachedRect[1], cachedRect[2], cachedRect[3]);
-                }
+            case RenderCommandType::Quads:
+                Graphics::QueueQuads(quads.data() + command.First, quadTextures.data() + command.First, (size_t)command.Count);
+                break;
+            case RenderCommandType::Glyphs:
+                TextRenderer::QueueGlyphs(command.Texture, glyphs.data() + command.First, (size_t)command.Count);
+                break;
+            case RenderCommandType::PushClip:
+                // nothing of the content would pass the scissor, continue with the PopClip
+                if (!PushClipBounds(Rectangle(command.Bounds[0], command.Bounds[1], command.Bounds[2], command.Bounds[3])))
+                    i += (size_t)command.Count;
+                break;
+            case RenderCommandType::PopClip:
+                PopClipBounds();
+                break;
+            case RenderCommandType::Cull:
+                if (!clipStack.empty() && !IntersectsBounds(command.Bounds, clipStack.back()))
+                    i += (size_t)command.Count;
+                break;
+            case RenderCommandType::Child:
+                if (!command.Child->IsOutsideClipBounds())
+                    command.Child->Render();
+                break;
             }
         }
     }
 
+    bool Renderable::IsRenderCommandsValid() const
+    {
+        if (!renderCommands->GetIsValid())
+            return false;
+
+        for (const RenderCommand &command : renderCommands->GetCommands())
+        {
+            // content with its own list, it is only recorded while it is drawn
+            if (command.Type == RenderCommandType::Child && command.Child->GetIsVisible() &&
+                command.Child->GetActualWidth() > 0 && command.Child->GetActualHeight() > 0 &&
+                !command.Child->IsRenderCommandsValid())
+                return false;
+        }
+
+        return true;
+    }
+
+    bool Renderable::CompositeLayer(int actualWidth, int actualHeight)
+    {
+        // the layer is axis aligned, rotated visuals are drawn directly
+        const glm::vec3 &rotation = GetRotation();
+        if (rotation.x != 0.0f || rotation.y != 0.0f || rotation.z != 0.0f)
+            return false;
+
+        RenderLayer *layer = RenderLayer::Acquire(this, actualWidth, actualHeight);
+        if (!layer)
+            return false;
+
+        Rectangle bounds(GetLeft(), GetTop(), actualWidth, actualHeight);
+        int bottom = Scene2D::CurrentScene().GetHeight() - bounds.GetBottom();
+
+        if (!layer->GetIsContentValid() || !IsRenderCommandsValid())
+        {
+            // the layer keeps all of the content, not only the region the window redraws
+            std::vector<Rectangle> outerClipStack;
+            outerClipStack.swap(clipStack);
+
+            layer->Begin(bounds.GetLeft(), bottom);
+            SetClipBounds(bounds);
+
+            if (!renderCommands->GetIsValid())
+                RecordRenderCommands(actualWidth, actualHeight);
+
+            ReplayRenderCommands();
+
+            ResetClipBounds();
+            layer->End();
+
+            clipStack.swap(outerClipStack);
+            ApplyClipBounds();
+
+            layer->SetIsContentValid(true);
+        }
+
+        Graphics::DrawTexture(bounds.GetLeft(), bounds.GetLeft(), bounds.GetTop(), bottom, GetZIndex(), actualWidth, actualHeight, layer->GetTexture(), true);
+        return true;
+    }
+
+    bool Renderable::PushClipBounds(const Rectangle &value)
+    {
+        Rectangle bounds = clipStack.empty() ? value : IntersectBounds(clipStack.back(), value);
+        clipStack.push_back(bounds);
+        ApplyClipBounds();
+
+        return bounds.GetWidth() > 0 && bounds.GetHeight() > 0;
+    }
+
+    void Renderable::PopClipBounds()
+    {
+        clipStack.pop_back();
+        ApplyClipBounds();
+    }
+
+    void Renderable::ApplyClipBounds()
+    {
+        if (clipStack.empty())
+            Graphics::DisableScissor();
+        else
+            Graphics::SetScissor(clipStack.back());
+    }
+
+    bool Renderable::IsOutsideClipBounds() const
+    {
+        // the clip stack belongs to the replay, a recording keeps everything
+        if (clipStack.empty() || RenderCommandList::GetRecording())
+            return false;
+
+        const glm::vec3 &rotation = GetRotation();
+        if (rotation.x != 0.0f || rotation.y != 0.0f || rotation.z != 0.0f)
+            return false;
+
+        Rectangle visibleBounds(GetLeft(), GetTop(), GetActualWidth(), GetActualHeight());
+        return !visibleBounds.IntersectsWith(clipStack.back());
+    }
+
+    void Renderable::SetClipBounds(const Rectangle &value)
+    {
+        clipStack.clear();
+        PushClipBounds(value);
+    }
+
+    void Renderable::ResetClipBounds()
+    {
+        clipStack.clear();
+        ApplyClipBounds();
+    }
+
     void Renderable::UpdateState()
     {
         SetVisualState(GetEnabled() ? "Normal" : "Disabled");
@@ -171,7 +403,7 @@ namespace xit::Drawing::VisualBase
         const ImageBrush *imageBrush = dynamic_cast<const ImageBrush *>(GetBackground());
         if (imageBrush)
         {
-            backgroundTexture = Texture::FindOrCreateTexture(imageBrush->GetFileName(), imageBrush->GetWidth(), imageBrush->GetHeight());
+            backgroundTexture = FindOrCreateImageTexture(imageBrush);
         }
         else
         {
@@ -206,7 +438,7 @@ namespace xit::Drawing::VisualBase
         const ImageBrush *imageBrush = dynamic_cast<const ImageBrush *>(GetBorderBrush());
         if (imageBrush)
         {
-            borderTexture = Texture::FindOrCreateTexture(imageBrush->GetFileName(), imageBrush->GetWidth(), imageBrush->GetHeight());
+            borderTexture = FindOrCreateImageTexture(imageBrush);
         }
         else
         {
@@ -217,6 +449,20 @@ namespace xit::Drawing::VisualBase
         Invalidate();
     }
 
+    void Renderable::OnScaleChanged(EventArgs &e)
+    {
+        LayoutManager::OnScaleChanged(e);
+
+        // images are resampled to their display size, which depends on the DPI scale
+        const ImageBrush *imageBrush = dynamic_cast<const ImageBrush *>(GetBackground());
+        if (imageBrush)
+            backgroundTexture = FindOrCreateImageTexture(imageBrush);
+
+        imageBrush = dynamic_cast<const ImageBrush *>(GetBorderBrush());
+        if (imageBrush)
+            borderTexture = FindOrCreateImageTexture(imageBrush);
+    }
+
     void Renderable::OnBrushGroupChanged(EventArgs &e)
     {
         isBrushGroupChanging = true;
@@ -370,6 +616,51 @@ namespace xit::Drawing::VisualBase
         Invalidate();
     }
 
+    void Renderable::OnInvalidated(EventArgs &e)
+    {
+        LayoutManager::OnInvalidated(e);
+        InvalidateRenderCommands();
+    }
+
+    void Renderable::OnVisibilityChanged(EventArgs &e)
+    {
+        // Invalidate does nothing for collapsed visuals
+        InvalidateRenderCommands();
+        LayoutManager::OnVisibilityChanged(e);
+    }
+
+    void Renderable::OnLayoutChanged(const Rectangle &bounds)
+    {
+        LayoutManager::OnLayoutChanged(bounds);
+        InvalidateRenderCommands();
+    }
+
+    void Renderable::OnZIndexChanged(EventArgs &e)
+    {
+        ZIndexProperty::OnZIndexChanged(e);
+        InvalidateRenderCommands();
+    }
+
+    void Renderable::OnRotationChanged(EventArgs &e)
+    {
+        RotationProperty::OnRotationChanged(e);
+        InvalidateRenderCommands();
+    }
+
+    void Renderable::OnCacheModeChanged(EventArgs &e)
+    {
+        CacheModeProperty::OnCacheModeChanged(e);
+
+        // the owner has to reference the layered visual instead of recording its content, see RenderCommandList::AddChild
+        if (GetCacheMode() == CacheMode::Layer)
+            SetCacheRenderCommands(true);
+        else
+            RenderLayer::Release(this);
+
+        InvalidateRenderCommands();
+        NotifyWindowOfInvalidation();
+    }
+
     void Renderable::OnRender()
     {
         Graphics::DrawRectangle(GetLeft(), renderLeft, GetTop(), renderTop, GetZIndex(), actualWidth, actualHeight, GetRotation(), backgroundColors, foregroundColors, borderColors, backgroundTexture, borderTexture, GetBorderThickness(), GetCornerRadius());
@@ -382,11 +673,7 @@ namespace xit::Drawing::VisualBase
             return;
         }
 
-#ifdef DEBUG_INITIALIZATION
-        static int callCount = 0;
-        callCount++;
-        auto start = std::chrono::steady_clock::now();
-#endif
+        PROFILE_ZONE("Renderable::HandleBrushGroupChanged");
 
         isBrushGroupChanging = true;
 
@@ -396,16 +683,8 @@ namespace xit::Drawing::VisualBase
             brushVisualStateGroup = nullptr;
         }
 
-#ifdef DEBUG_INITIALIZATION
-        auto afterClear = std::chrono::steady_clock::now();
-#endif
-
         BrushVisualStateGroup *value = ThemeManager::Active().GetBrushVisualStateGroup(GetBrushGroup());
 
-#ifdef DEBUG_INITIALIZATION
-        auto afterLookup = std::chrono::steady_clock::now();
-#endif
-
         if (value)
         {
             brushVisualStateGroup = value;
@@ -414,36 +693,48 @@ namespace xit::Drawing::VisualBase
 
         UpdateBrushVisualState();
 
-#ifdef DEBUG_INITIALIZATION
-        auto afterUpdate = std::chrono::steady_clock::now();
-#endif
-
         isBrushGroupChanging = false;
 
         EventArgs e;
         BrushGroupChanged(*this, e);
         OnBrushGroupChanged(e);
+    }
 
-#ifdef DEBUG_INITIALIZATION
-        auto end = std::chrono::steady_clock::now();
-        auto totalDuration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
-        auto clearDuration = std::chrono::duration_cast<std::chrono::microseconds>(afterClear - start);
-        auto lookupDuration = std::chrono::duration_cast<std::chrono::microseconds>(afterLookup - afterClear);
-        auto updateDuration = std::chrono::duration_cast<std::chrono::microseconds>(afterUpdate - afterLookup);
-        auto eventDuration = std::chrono::duration_cast<std::chrono::microseconds>(end - afterUpdate);
-        
-        if (totalDuration.count() > 100 || callCount <= 10) // Log first 10 calls or any > 100μs
-        {
-            std::cout << ">>> BRUSH GROUP CHANGE #" << callCount << " for '" << GetBrushGroup() 
-                      << "': Total=" << totalDuration.count() << "μs, Clear=" << clearDuration.count() 
-                      << "μs, Lookup=" << lookupDuration.count() << "μs, Update=" 
-                      << updateDuration.count() << "μs, Events=" << eventDuration.count() << "μs <<<" << std::endl;
-        }
-        
-        if (callCount % 100 == 0) // Summary every 100 calls
+    const OpenGL::Texture *Renderable::FindOrCreateImageTexture(const ImageBrush *imageBrush)
+    {
+        // upload the image at the size it is displayed at, not at the size of the file
+        int width = imageBrush->GetWidth() > 0 ? (int)((float)imageBrush->GetWidth() * GetScaleX()) : 0;
+        int height = imageBrush->GetHeight() > 0 ? (int)((float)imageBrush->GetHeight() * GetScaleY()) : 0;
+
+        const Texture *texture = Texture::FindOrCreateTexture(imageBrush->GetFileName(), width, height);
+
+        // the texture is loaded in the background, we have to draw again when it is uploaded
+        if (!texture->GetIsDone() && !isWaitingForTexture)
         {
-            std::cout << ">>> BRUSH GROUP SUMMARY: " << callCount << " calls completed <<<" << std::endl;
+            isWaitingForTexture = true;
+            textureWaiters.push_back(this);
         }
-#endif
+
+        return texture;
+    }
+
+    bool Renderable::IsWaitingForTexture() const
+    {
+        return (backgroundTexture && !backgroundTexture->GetIsDone()) ||
+               (borderTexture && !borderTexture->GetIsDone());
+    }
+
+    void Renderable::InvalidateLoadedTextures()
+    {
+        std::erase_if(textureWaiters, [](Renderable *renderable)
+                      {
+                          if (renderable->IsWaitingForTexture())
+                              return false;
+
+                          renderable->isWaitingForTexture = false;
+
+                          // Image measures itself with the size of the texture
+                          renderable->Invalidate();
+                          return true; });
     }
 }
\ No newline at end of file
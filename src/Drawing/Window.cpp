@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <map>
 #include <chrono>
 #include <Exceptions.h>
@@ -10,6 +11,13 @@
 #include <Drawing/Window.h>
 #include <Drawing/DebugUtils.h>
 #include <Drawing/Theme/BrushPool.h>
+#include <OpenGL/TextureLoader.h>
+#include <OpenGL/Profiler.h>
+#include <OpenGL/RenderLayer.h>
+#include <OpenGL/RenderState.h>
+#include <OpenGL/Text/FontStorage.h>
+#include <OpenGL/Text/TextRenderer.h>
+#include <Drawing/UIDefaults.h>
 // #include <Drawing/Container.h>
 #include <Threading/Dispatcher.h>
 
@@ -35,6 +43,19 @@ static Point mousePosition;
 
 static std::map<GLFWwindow *, Window *> windowList;
 
+static std::string FormatProfileFrame(const ProfileFrame &frame)
+{
+    char text[256];
+    snprintf(text, sizeof(text),
+             "Frame %.2f ms\nMeasures %zu  Arranges %zu\nDraw calls %zu  State changes %zu\nGlyphs %zu  Invalidations %zu\nUploads %zu (%zu KB)",
+             (double)frame.Duration / 1000000.0,
+             frame.Get(ProfileCounter::LayoutMeasures), frame.Get(ProfileCounter::LayoutArranges),
+             frame.Get(ProfileCounter::DrawCalls), frame.Get(ProfileCounter::StateChanges),
+             frame.Get(ProfileCounter::GlyphsDrawn), frame.Get(ProfileCounter::Invalidations),
+             frame.Get(ProfileCounter::TextureUploads), frame.Get(ProfileCounter::TextureUploadBytes) / 1024);
+    return text;
+}
+
 static void WindowPositionCallback(GLFWwindow *window, int left, int top)
 {
     if (activeInstance == nullptr)
@@ -130,13 +151,35 @@ static void WindowIconifyCallback(GLFWwindow *window, int iconified)
     }
 }
 
+static void WindowRefreshCallback(GLFWwindow *glFwWindow)
+{
+    Window *window = windowList[glFwWindow];
+    if (window)
+        window->Refresh();
+}
+
 static void WindowCloseCallback(GLFWwindow *window)
 {
     // App::Close();
 }
 
+// EXT_buffer_age of EGL and GLX. The functions are resolved through GLFW, neither library is linked.
+static constexpr int EglDraw = 0x3059;
+static constexpr int EglBufferAge = 0x313D;
+static constexpr int GlxBackBufferAge = 0x20F4;
+
+static void *(*eglGetCurrentDisplayFunction)() = nullptr;
+static void *(*eglGetCurrentSurfaceFunction)(int) = nullptr;
+static unsigned int (*eglQuerySurfaceFunction)(void *, void *, int, int *) = nullptr;
+static void *(*glxGetCurrentDisplayFunction)() = nullptr;
+static unsigned long (*glxGetCurrentDrawableFunction)() = nullptr;
+static void (*glxQueryDrawableFunction)(void *, unsigned long, int, unsigned int *) = nullptr;
+
 namespace xit::Drawing
 {
+    bool Window::isHeadless = false;
+    std::atomic<std::thread::id> Window::renderThread;
+
     void Window::SetTitle(const std::string &value)
     {
         if (title != value)
@@ -148,6 +191,8 @@ namespace xit::Drawing
 
     void Window::InvalidateRegion(Visual *visual, Rectangle bounds)
     {
+        Profiler::Count(ProfileCounter::Invalidations);
+
 #ifdef DEBUG_WINDOW2
         std::cout << "InvalidateRegion: Adding region for visual '"
                   << (visual ? visual->GetName() : "null") << "' bounds("
@@ -161,51 +206,26 @@ namespace xit::Drawing
                   << "," << bounds.GetWidth() << "," << bounds.GetHeight() << ")" << std::endl;
 #endif
 
-        bool shouldScheduleRedraw = false;
+        // Only the first invalidation in an epoch queues the visual, so this is O(1) no matter how often it is called.
+        // The region of a queued visual is drawn anyway. A visual moved by a layout pass
+        // before DoRender does not need the union of both bounds, layout changes redraw everything.
+        size_t epoch = invalidationEpoch.load(std::memory_order_acquire);
+        if (std::atomic_ref<size_t>(visual->invalidationEpoch).exchange(epoch, std::memory_order_acq_rel) == epoch)
         {
-            std::lock_guard<std::mutex> lock(invalidRegionsMutex);
-
-            // Check if we already have an invalidation for this visual
-            bool foundExisting = false;
-            for (auto &region : invalidRegions)
-            {
-                if (region.first == visual)
-                {
-                    // Update existing region to union of old and new bounds
-                    Rectangle oldBounds = region.second;
-                    int left = std::min(oldBounds.GetLeft(), bounds.GetLeft());
-                    int top = std::min(oldBounds.GetTop(), bounds.GetTop());
-                    int right = std::max(oldBounds.GetRight(), bounds.GetRight());
-                    int bottom = std::max(oldBounds.GetBottom(), bounds.GetBottom());
-                    region.second = Rectangle(left, top, right - left, bottom - top);
-                    foundExisting = true;
 #ifdef DEBUG_VISUAL_STATES
-                    std::cout << "[DEBUG] Window::InvalidateRegion() - Merged with existing region for "
-                              << (visual ? visual->GetName() : "null") << std::endl;
-#endif
-                    break;
-                }
-            }
-
-            if (!foundExisting)
-            {
-                invalidRegions.push_back({visual, bounds});
-                shouldScheduleRedraw = (invalidRegions.size() == 1); // Only schedule if this is the first region
-            }
-
-#ifdef DEBUG_WINDOW2
-            std::cout << "InvalidateRegion: Total invalid regions now: " << invalidRegions.size() << std::endl;
-#endif
-#ifdef DEBUG_VISUAL_STATES
-            std::cout << "[DEBUG] Window::InvalidateRegion() - Total regions now: " << invalidRegions.size() << std::endl;
+            std::cout << "[DEBUG] Window::InvalidateRegion() - Already queued: "
+                      << (visual ? visual->GetName() : "null") << std::endl;
 #endif
+            return;
         }
 
-        // Only schedule redraw if we added the first region or if no redraw is currently scheduled
-        if (shouldScheduleRedraw || !redrawScheduled.load())
+        // lock-free push, invalidations may come from timer threads. DoRender takes the whole list at once.
+        InvalidationNode *node = new InvalidationNode{bounds, invalidations.load(std::memory_order_relaxed)};
+        while (!invalidations.compare_exchange_weak(node->Next, node, std::memory_order_release, std::memory_order_relaxed))
         {
-            ScheduleRedraw();
         }
+
+        ScheduleRedraw();
     }
 
     Window::Window()
@@ -247,14 +267,11 @@ namespace xit::Drawing
 
         backgroundTexture = 0;
 
-        // Initialize double buffering members
-        frontFramebuffer = 0;
-        backFramebuffer = 0;
-        frontColorTexture = 0;
-        backColorTexture = 0;
-        frontDepthTexture = 0;
-        backDepthTexture = 0;
+        // Initialize accumulation target members
+        framebuffer = 0;
+        colorTexture = 0;
         framebuffersInitialized = false;
+        isFullPresentNeeded = false;
 
         // Initialize timing debug variables
         firstFrameCompleted = false;
@@ -291,6 +308,11 @@ namespace xit::Drawing
 
 #ifdef DEBUG_INITIALIZATION
         auto glfwInitStart = std::chrono::steady_clock::now();
+#endif
+#ifdef GLFW_PLATFORM_NULL
+        // without a display server, the null platform has no windows but offers EGL and OSMesa contexts
+        if (isHeadless)
+            glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
 #endif
         if (!glfwInit())
         {
@@ -311,6 +333,13 @@ namespace xit::Drawing
         glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
         glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
         glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+        if (isHeadless)
+        {
+            // EGL also creates contexts without a window, e.g. surfaceless with Mesa llvmpipe
+            glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+            glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
+        }
 #ifdef DEBUG_INITIALIZATION
         auto glfwHintsEnd = std::chrono::steady_clock::now();
         auto glfwHintsDuration = std::chrono::duration_cast<std::chrono::microseconds>(
@@ -323,6 +352,7 @@ namespace xit::Drawing
         auto dispatcherStart = std::chrono::steady_clock::now();
 #endif
         Dispatcher::SetMainThreadId();
+        renderThread.store(std::this_thread::get_id(), std::memory_order_relaxed);
 #ifdef DEBUG_INITIALIZATION
         auto dispatcherEnd = std::chrono::steady_clock::now();
         auto dispatcherDuration = std::chrono::duration_cast<std::chrono::microseconds>(
@@ -336,6 +366,18 @@ namespace xit::Drawing
 #endif // OSX
     }
 
+    Window::~Window()
+    {
+        // invalidations which were not rendered anymore
+        InvalidationNode *invalidated = invalidations.exchange(nullptr, std::memory_order_acquire);
+        while (invalidated != nullptr)
+        {
+            InvalidationNode *next = invalidated->Next;
+            delete invalidated;
+            invalidated = next;
+        }
+    }
+
     //******************************************************************************
     // Private
     //******************************************************************************
@@ -343,6 +385,45 @@ namespace xit::Drawing
     void Window::App_Closing(EventArgs &e)
     {
         Close();
+
+        // the main loop may wait for events and has to see the close flag
+        WakeUp();
+    }
+
+    void Window::WakeUp()
+    {
+        // thread safe, makes a waiting glfwWaitEvents return
+        glfwPostEmptyEvent();
+    }
+
+    FrameClock::Clock::time_point Window::Now() const
+    {
+        // a synthetic clock does not advance during a frame
+        return isHeadless ? frameTime : FrameClock::Clock::now();
+    }
+
+    bool Window::IsFrameWaiting()
+    {
+        return redrawScheduled || frameClock.GetPolicy() == FramePolicy::Continuous || TextureLoader::HasStagedImages();
+    }
+
+    void Window::WaitEvents()
+    {
+        // Sleep until an input event, a wake up or the next frame of work which is waiting already.
+        // Redraws, staged images and timers on other threads wake the loop. The Dispatcher queue cannot
+        // wake it, so an idle window still wakes every MaxIdleWait to run work posted without a WakeUp.
+        if (!IsFrameWaiting())
+        {
+            glfwWaitEventsTimeout(MaxIdleWait);
+            return;
+        }
+
+        std::chrono::duration<double> timeout = frameClock.GetNextFrameTime() - std::chrono::steady_clock::now();
+
+        if (timeout.count() > 0)
+            glfwWaitEventsTimeout(timeout.count());
+        else
+            glfwPollEvents();
     }
 
     void Window::ScheduleRedraw()
@@ -358,6 +439,7 @@ namespace xit::Drawing
 
             // Signal the main loop that a redraw is needed
             mainLoopSemaphore.release();
+            WakeUp();
         }
         else
         {
@@ -386,7 +468,8 @@ namespace xit::Drawing
 
         // Also update content when window is invalidated (even if window size/position unchanged)
         // This handles cases where content invalidates and window needs to update its content layout
-        bool needContentUpdate = needClientUpdate || GetInvalidated();
+        // or when only some descendants need layout, unchanged content skips itself
+        bool needContentUpdate = needClientUpdate || GetInvalidated() || GetNeedChildLayout();
 
 #ifdef DEBUG_WINDOW2
         std::cout << "Window::OnUpdate called. needClientUpdate=" << needClientUpdate
@@ -414,7 +497,6 @@ namespace xit::Drawing
                           << "," << clientBounds.GetWidth() << "," << clientBounds.GetHeight() << ")" << std::endl;
 #endif
                 content->UpdateLayout(clientBounds);
-                ToolTip::DoUpdate(clientBounds);
             }
             else
             {
@@ -626,6 +708,12 @@ namespace xit::Drawing
         auto windowCreateStart = std::chrono::steady_clock::now();
 #endif
         window = glfwCreateWindow(windowSettings.GetWidth(), windowSettings.GetHeight(), title.c_str(), NULL, NULL);
+        if (window == NULL && isHeadless)
+        {
+            // no EGL driver, OSMesa renders on the CPU
+            glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+            window = glfwCreateWindow(windowSettings.GetWidth(), windowSettings.GetHeight(), title.c_str(), NULL, NULL);
+        }
         if (window == NULL)
         {
             ERRORT("Failed to create GLFW window");
@@ -651,6 +739,19 @@ namespace xit::Drawing
             ERRORT("Failed to initialize GLAD");
             return false;
         }
+
+        // a new context starts with the default state, whatever was cached belongs to another one
+        RenderState::Invalidate();
+
+        // the swap waits for the vertical blank, the frame clock starts frames right after it.
+        // A headless window never swaps, its frames are paced by the clock alone.
+        if (!isHeadless)
+        {
+            glfwSwapInterval(1);
+            frameClock.SetIsVSync(true);
+
+            ResolveBufferAge();
+        }
 #if defined(DEBUG_INITIALIZATION) || defined(DEBUG_WINDOW)
         auto contextSetupEnd = std::chrono::steady_clock::now();
         auto contextSetupDuration = std::chrono::duration_cast<std::chrono::microseconds>(
@@ -686,6 +787,7 @@ namespace xit::Drawing
         glfwSetWindowMaximizeCallback(window, WindowMaximizeCallback);
         glfwSetWindowIconifyCallback(window, WindowIconifyCallback);
         glfwSetWindowCloseCallback(window, WindowCloseCallback);
+        glfwSetWindowRefreshCallback(window, WindowRefreshCallback);
 
         InputHandler::Initialize(window, this);
 
@@ -762,6 +864,10 @@ namespace xit::Drawing
         auto framebufferInitStart = std::chrono::steady_clock::now();
 #endif
         InitializeFramebuffers();
+
+        // a headless window is never shown, it can render right away
+        if (isHeadless)
+            OpenGLExtensions::Initialize2D(scene);
 #if defined(DEBUG_INITIALIZATION) || defined(DEBUG_WINDOW)
         auto framebufferInitEnd = std::chrono::steady_clock::now();
         auto framebufferDuration = std::chrono::duration_cast<std::chrono::microseconds>(
@@ -818,6 +924,81 @@ namespace xit::Drawing
 
         return true;
     }
+    bool Window::RenderFrame(FrameClock::Clock::time_point now)
+    {
+        frameTime = now;
+
+        // posted work runs as soon as it arrives, only the frames are paced
+        Dispatcher::Run();
+
+        if (!IsFrameWaiting() || !frameClock.IsFrameDue(now))
+            return false;
+
+        PROFILE_ZONE("Frame");
+        Profiler::BeginFrame();
+        frameClock.BeginFrame(now);
+
+        // update phase: upload decoded images within its budget, the invalidated visuals release the semaphore below
+        if (TextureLoader::HasStagedImages())
+        {
+            PROFILE_ZONE("Update");
+
+            auto budget = std::chrono::duration_cast<std::chrono::microseconds>(
+                frameClock.GetRemainingUpdateBudget(Now()));
+
+            if (TextureLoader::ProcessUploads(budget) > 0)
+                Renderable::InvalidateLoadedTextures();
+        }
+
+        frameClock.EndUpdate(Now());
+
+        // layout and render phases
+        bool isPresented = false;
+
+        // a continuous window lays out and renders on every tick, also when nothing was invalidated
+        bool isRedrawScheduled = mainLoopSemaphore.try_acquire();
+
+        if (isRedrawScheduled || frameClock.GetPolicy() == FramePolicy::Continuous)
+        {
+            DoRender();
+            isPresented = lastFrameStatistics.IsPresented;
+        }
+
+        frameClock.EndFrame(Now(), isPresented);
+        Profiler::EndFrame();
+
+        return true;
+    }
+
+    bool Window::ReadPixels(std::vector<unsigned char> &pixels)
+    {
+        if (!framebuffersInitialized || !firstFrameCompleted)
+            return false;
+
+        int width = scene.GetWidth();
+        int height = scene.GetHeight();
+        size_t rowSize = (size_t)width * 4;
+
+        pixels.resize(rowSize * (size_t)height);
+
+        RenderState::BindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+
+        // OpenGL rows start at the bottom
+        std::vector<unsigned char> row(rowSize);
+        for (int y = 0; y < height / 2; y++)
+        {
+            unsigned char *top = &pixels[(size_t)y * rowSize];
+            unsigned char *bottom = &pixels[(size_t)(height - 1 - y) * rowSize];
+            std::copy(top, top + rowSize, row.begin());
+            std::copy(bottom, bottom + rowSize, top);
+            std::copy(row.begin(), row.end(), bottom);
+        }
+
+        return true;
+    }
+
     void Window::Show()
     {
         // Record show start time for debugging
@@ -849,51 +1030,52 @@ namespace xit::Drawing
                   << openGLExtensionsDuration.count() << "μs <<<" << std::endl;
 #endif
 
-        while (!glfwWindowShouldClose(window) && !isDestroyed)
-        {
-            using namespace std::literals;
+        // the loop sleeps in glfwWaitEvents, workers staging decoded images wake it
+        TextureLoader::SetWakeUp(&Window::WakeUp);
 
-            // Add frame rate limiting to prevent excessive rendering during resize
-            static auto lastRenderTime = std::chrono::steady_clock::now();
-            auto currentTime = std::chrono::steady_clock::now();
-            auto timeSinceLastRender = std::chrono::duration_cast<std::chrono::milliseconds>(currentTime - lastRenderTime);
-
-            // Limit to ~60 FPS (16ms between frames) to reduce resize flicker
-            bool canRender = timeSinceLastRender.count() >= 16;
+        // the window may have been moved to another monitor before it was shown
+        UpdateRefreshRate();
 
 #ifdef DEBUG_WINDOW
-            static int frameCount = 0;
-            static auto lastFpsReport = currentTime;
-            frameCount++;
-
-            auto timeSinceLastFpsReport = std::chrono::duration_cast<std::chrono::seconds>(currentTime - lastFpsReport);
-            if (timeSinceLastFpsReport.count() >= 5) // Report FPS every 5 seconds
-            {
-                double fps = frameCount / 5.0;
-                std::cout << "\n>>> PERFORMANCE REPORT: " << fps << " FPS (avg frame time: "
-                          << (5000.0 / frameCount) << "ms) <<<\n"
-                          << std::endl;
-                frameCount = 0;
-                lastFpsReport = currentTime;
-            }
+        size_t reportedFrameCount = 0;
+        auto lastFpsReport = std::chrono::steady_clock::now();
 #endif
 
-            if (canRender && mainLoopSemaphore.try_acquire_for(std::chrono::milliseconds(1)))
+        while (!glfwWindowShouldClose(window) && !isDestroyed)
+        {
+            auto currentTime = std::chrono::steady_clock::now();
+
+            if (RenderFrame(currentTime))
             {
-#ifdef DEBUG_WINDOW2
-                if (timeSinceLastRender.count() > 20) // Log if frame took longer than expected
+#ifdef DEBUG_WINDOW
+                if (frameClock.GetIsLastFrameLate())
+                {
+                    std::cout << "Late frame: " << std::chrono::duration_cast<std::chrono::microseconds>(frameClock.GetLastWorkDuration()).count()
+                              << "μs (update " << std::chrono::duration_cast<std::chrono::microseconds>(frameClock.GetLastUpdateDuration()).count()
+                              << "μs, layout " << std::chrono::duration_cast<std::chrono::microseconds>(frameClock.GetLastLayoutDuration()).count()
+                              << "μs, interval " << std::chrono::duration_cast<std::chrono::microseconds>(frameClock.GetInterval()).count()
+                              << "μs)" << std::endl;
+                }
+
+                auto timeSinceLastFpsReport = std::chrono::duration_cast<std::chrono::seconds>(currentTime - lastFpsReport);
+                if (timeSinceLastFpsReport.count() >= 5) // Report FPS every 5 seconds
                 {
-                    std::cout << "Frame gap: " << timeSinceLastRender.count() << "ms (target: 16ms)" << std::endl;
+                    size_t frameCount = frameClock.GetFrameCount() - reportedFrameCount;
+                    double fps = (double)frameCount / 5.0;
+                    std::cout << "\n>>> PERFORMANCE REPORT: " << fps << " FPS, "
+                              << frameClock.GetLateFrameCount() << " late frames in total <<<\n"
+                              << std::endl;
+                    reportedFrameCount = frameClock.GetFrameCount();
+                    lastFpsReport = currentTime;
                 }
 #endif
-                DoRender();
-                lastRenderTime = currentTime;
             }
 
-            Dispatcher::Run();
-            glfwPollEvents();
+            WaitEvents();
         }
 
+        TextureLoader::SetWakeUp(nullptr);
+
         if (lastActiveInstance != nullptr)
         {
             activeInstance = lastActiveInstance;
@@ -936,6 +1118,64 @@ namespace xit::Drawing
     void Window::SetWindowPos(int left, int top)
     {
         windowSettings.SetLocation(left, top);
+
+        // the window may be on another monitor now
+        UpdateRefreshRate();
+    }
+
+    void Window::UpdateRefreshRate()
+    {
+        // only full screen windows have a monitor, otherwise take the one containing the center of the window
+        GLFWmonitor *monitor = glfwGetWindowMonitor(window);
+
+        if (!monitor)
+        {
+            int left, top, width, height;
+            glfwGetWindowPos(window, &left, &top);
+            glfwGetWindowSize(window, &width, &height);
+
+            int centerX = left + width / 2;
+            int centerY = top + height / 2;
+
+            int count = 0;
+            GLFWmonitor **monitors = glfwGetMonitors(&count);
+
+            for (int i = 0; i < count && !monitor; i++)
+            {
+                int monitorLeft, monitorTop;
+                glfwGetMonitorPos(monitors[i], &monitorLeft, &monitorTop);
+                const GLFWvidmode *mode = glfwGetVideoMode(monitors[i]);
+
+                if (mode && centerX >= monitorLeft && centerX < monitorLeft + mode->width &&
+                    centerY >= monitorTop && centerY < monitorTop + mode->height)
+                    monitor = monitors[i];
+            }
+
+            if (!monitor)
+                monitor = glfwGetPrimaryMonitor();
+        }
+
+        const GLFWvidmode *mode = monitor ? glfwGetVideoMode(monitor) : nullptr;
+        frameClock.SetRefreshRate(mode ? mode->refreshRate : 0);
+    }
+
+    void Window::SetFramePolicy(FramePolicy value)
+    {
+        frameClock.SetPolicy(value);
+
+        // the loop may wait for an event
+        WakeUp();
+    }
+
+    void Window::SetIsProfilerOverlayVisible(bool value)
+    {
+        if (Profiler::GetIsOverlayVisible() == value)
+            return;
+
+        Profiler::SetIsOverlayVisible(value);
+
+        // the next frame draws or removes the overlay
+        ScheduleRedraw();
     }
 
     void Window::SetWindowSize(int width, int height)
@@ -1010,16 +1250,53 @@ namespace xit::Drawing
     void Window::DoRender()
     {
 #ifdef DEBUG_WINDOW2
-        auto renderStartTime = std::chrono::high_resolution_clock::now();
         std::cout << "\n=== Window::DoRender START ===" << std::endl;
 #endif
 
         // Reset the scheduled flag
         redrawScheduled = false;
+        lastFrameStatistics = FrameStatistics();
 
-        // TODO i do not want to call update every time, but only when needed
-        // find possible spots to trigger update
-        UpdateLayout(scene.SceneRect);
+        // layers drawn before this frame may be deleted to make room for new ones
+        RenderLayer::BeginFrame();
+
+        // Only lay out what changed. Invalidate marks the path from the element up to the window,
+        // an idle frame does not lay out a single element.
+        // A frame runs at least one pass, further passes stop when the layout budget of the frame is used up.
+        bool isLayoutOverBudget = false;
+
+        {
+            PROFILE_ZONE("Layout");
+
+            for (int pass = 0; layoutPass < MaxLayoutPasses && (GetNeedLayout() || GetBounds() != scene.SceneRect); pass++)
+            {
+                if (pass > 0 && frameClock.IsLayoutOverBudget(Now()))
+                {
+                    isLayoutOverBudget = true;
+                    break;
+                }
+
+                isLayoutChanged |= UpdateLayout(scene.SceneRect);
+                layoutPass++;
+            }
+        }
+
+        frameClock.EndLayout(Now());
+
+        if (isLayoutOverBudget)
+        {
+            // a half done layout is not rendered, the next frame continues it. The invalidated visuals stay queued.
+            ScheduleRedraw();
+            return;
+        }
+
+        bool layoutUpdated = isLayoutChanged;
+        isLayoutChanged = false;
+        layoutPass = 0;
+
+        // the tooltip has no parent, Invalidate does not mark the window for it.
+        // It skips itself when nothing changed.
+        ToolTip::DoUpdate(clientBounds);
 
         Scene2D::MakeCurrent(&scene);
 
@@ -1031,10 +1308,18 @@ namespace xit::Drawing
             // Fallback to traditional rendering if framebuffers aren't ready
             if (content)
             {
+                PROFILE_ZONE("Render");
+
                 OpenGLExtensions::ClearScene2D();
                 Render();
+                Graphics::Flush();
+                frameClock.EndRender(Now());
                 glfwSwapBuffers(window);
 
+                lastFrameStatistics.RenderedPixels = (size_t)scene.GetWidth() * (size_t)scene.GetHeight();
+                lastFrameStatistics.PresentedPixels = lastFrameStatistics.RenderedPixels;
+                lastFrameStatistics.IsPresented = true;
+
                 // Check if this is the first completed frame (fallback path)
                 if (!firstFrameCompleted)
                 {
@@ -1060,13 +1345,6 @@ namespace xit::Drawing
 #endif
                 }
             }
-#ifdef DEBUG_WINDOW2
-            auto renderEndTime = std::chrono::high_resolution_clock::now();
-            auto renderDuration = std::chrono::duration_cast<std::chrono::microseconds>(renderEndTime - renderStartTime);
-            std::cout << "DoRender: Fallback rendering completed in " << renderDuration.count() << "μs" << std::endl;
-            std::cout << "=== Window::DoRender END ===\n"
-                      << std::endl;
-#endif
             return;
         }
 
@@ -1082,204 +1360,150 @@ namespace xit::Drawing
 
         if (content)
         {
-#ifdef DEBUG_WINDOW2
-            auto regionExtractionStart = std::chrono::high_resolution_clock::now();
-#endif
+            // Take all queued visuals at once and coalesce their regions into a bounded set
+            if (dirtyRegions.GetArea() != scene.SceneRect)
+                dirtyRegions.SetArea(scene.SceneRect);
+            else
+                dirtyRegions.Clear();
 
-            // Storage for regions to process thread-safely
-            std::vector<std::pair<Visual *, Rectangle>> regionsToProcess;
+            // Take the stack before starting the next epoch. A visual invalidated in between is not queued again,
+            // its region was taken with the stack and is rendered by this frame.
+            InvalidationNode *invalidated = invalidations.exchange(nullptr, std::memory_order_acquire);
+            invalidationEpoch.fetch_add(1, std::memory_order_acq_rel);
 
+            while (invalidated != nullptr)
             {
-                std::lock_guard<std::mutex> lock(invalidRegionsMutex);
-                if (!invalidRegions.empty())
-                {
-                    regionsToProcess = std::move(invalidRegions);
-                    invalidRegions.clear();
-                }
+                InvalidationNode *next = invalidated->Next;
+                dirtyRegions.Add(invalidated->Bounds);
+                delete invalidated;
+                invalidated = next;
+            }
+
+            // The overlay is drawn over the content. The content below its old and its new bounds
+            // is rendered again, so the overlay follows the counters and disappears when it is hidden.
+            std::string overlayText;
+            Size overlayTextSize;
+
+            if (!profilerOverlayBounds.IsEmpty())
+                dirtyRegions.Add(profilerOverlayBounds);
+
+            profilerOverlayBounds = Rectangle();
+
+            if (Profiler::GetIsOverlayVisible())
+            {
+                overlayText = FormatProfileFrame(Profiler::GetLastFrame());
+                FontStorage::FindOrCreate(UIDefaults::DefaultFont, UIDefaults::DefaultFontSize).Measure(overlayText, overlayTextSize);
+
+                profilerOverlayBounds = Rectangle(ProfilerOverlayMargin, ProfilerOverlayMargin,
+                                                  overlayTextSize.GetWidth() + 2 * ProfilerOverlayPadding,
+                                                  overlayTextSize.GetHeight() + 2 * ProfilerOverlayPadding);
+                dirtyRegions.Add(profilerOverlayBounds);
             }
 
+            const std::vector<Rectangle> &regionsToProcess = dirtyRegions.GetRegions();
+
 #ifdef DEBUG_WINDOW2
-            auto regionExtractionEnd = std::chrono::high_resolution_clock::now();
-            auto regionExtractionDuration = std::chrono::duration_cast<std::chrono::microseconds>(regionExtractionEnd - regionExtractionStart);
-            std::cout << "DoRender: Region extraction took " << regionExtractionDuration.count() << "μs" << std::endl;
             std::cout << "DoRender: Found " << regionsToProcess.size() << " invalid regions" << std::endl;
 #endif
 
-            // Bind back framebuffer for rendering
-            glBindFramebuffer(GL_FRAMEBUFFER, backFramebuffer);
-            glViewport(0, 0, scene.GetWidth(), scene.GetHeight());
+            // The accumulation target keeps the last frame, only the damaged parts are rendered again
+            RenderState::BindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+            RenderState::SetViewport(0, 0, scene.GetWidth(), scene.GetHeight());
 
             bool hasInvalidRegions = !regionsToProcess.empty();
-            bool needsFullRedraw = GetInvalidated() || GetNeedWidthRecalculation() ||
+            // elements moved by the layout pass are not covered by the invalid regions.
+            // If most of the window is invalid one pass is cheaper than a pass per region.
+            // A continuous window renders everything on every tick, e.g. animations which do not invalidate.
+            bool needsFullRedraw = frameClock.GetPolicy() == FramePolicy::Continuous ||
+                                   layoutUpdated || GetInvalidated() || GetNeedWidthRecalculation() ||
                                    GetNeedHeightRecalculation() || GetNeedLeftRecalculation() ||
-                                   GetNeedTopRecalculation();
+                                   GetNeedTopRecalculation() ||
+                                   dirtyRegions.GetCoveredArea() * 2 > scene.GetWidth() * scene.GetHeight();
 
 #ifdef DEBUG_WINDOW2
             std::cout << "DoRender: Rendering strategy - hasInvalidRegions=" << hasInvalidRegions
                       << " needsFullRedraw=" << needsFullRedraw << std::endl;
             if (needsFullRedraw)
             {
-                std::cout << "DoRender: Full redraw reasons - invalidated=" << GetInvalidated()
+                std::cout << "DoRender: Full redraw reasons - layoutUpdated=" << layoutUpdated
+                          << " invalidated=" << GetInvalidated()
                           << " needWidth=" << GetNeedWidthRecalculation()
                           << " needHeight=" << GetNeedHeightRecalculation()
                           << " needLeft=" << GetNeedLeftRecalculation()
                           << " needTop=" << GetNeedTopRecalculation() << std::endl;
             }
-            auto renderingStart = std::chrono::high_resolution_clock::now();
 #endif
 
+            FrameStatistics statistics;
+
             if (needsFullRedraw)
             {
+                PROFILE_ZONE("Render");
+
 #ifdef DEBUG_WINDOW2
                 std::cout << "DoRender: Performing FULL REDRAW" << std::endl;
-                auto fullRedrawStart = std::chrono::high_resolution_clock::now();
 #endif
-                // Full redraw - clear and render everything
+                // Full redraw - clear and render everything, visuals outside the scene are skipped
                 OpenGLExtensions::ClearScene2D();
+                Renderable::SetClipBounds(scene.SceneRect);
                 Render();
-#ifdef DEBUG_WINDOW2
-                auto fullRedrawEnd = std::chrono::high_resolution_clock::now();
-                auto fullRedrawDuration = std::chrono::duration_cast<std::chrono::microseconds>(fullRedrawEnd - fullRedrawStart);
-                std::cout << "DoRender: Full redraw completed in " << fullRedrawDuration.count() << "μs" << std::endl;
-#endif
+                Renderable::ResetClipBounds();
+                Graphics::Flush();
+
+                // the whole window is damaged
+                dirtyRegions.Clear();
+                dirtyRegions.Add(scene.SceneRect);
+                statistics.RenderedPixels = (size_t)scene.GetWidth() * (size_t)scene.GetHeight();
             }
             else if (hasInvalidRegions)
             {
-#ifdef DEBUG_WINDOW2
-                std::cout << "DoRender: Performing PARTIAL REDRAW with " << regionsToProcess.size() << " regions" << std::endl;
-                auto partialRedrawStart = std::chrono::high_resolution_clock::now();
-#endif
-                // Partial redraw - copy unchanged regions from front buffer and render only invalid regions
-
-                // First, copy the entire front buffer to back buffer
-#ifdef DEBUG_WINDOW2
-                auto copyStart = std::chrono::high_resolution_clock::now();
-#endif
-                glBindFramebuffer(GL_READ_FRAMEBUFFER, frontFramebuffer);
-                glBindFramebuffer(GL_DRAW_FRAMEBUFFER, backFramebuffer);
-                glBlitFramebuffer(0, 0, scene.GetWidth(), scene.GetHeight(),
-                                  0, 0, scene.GetWidth(), scene.GetHeight(),
-                                  GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT, GL_NEAREST);
-#ifdef DEBUG_WINDOW2
-                auto copyEnd = std::chrono::high_resolution_clock::now();
-                auto copyDuration = std::chrono::duration_cast<std::chrono::microseconds>(copyEnd - copyStart);
-                std::cout << "DoRender: Buffer copy (" << scene.GetWidth() << "x" << scene.GetHeight()
-                          << ") took " << copyDuration.count() << "μs" << std::endl;
-#endif
-
-                // Now render only the invalidated regions
-                glBindFramebuffer(GL_FRAMEBUFFER, backFramebuffer);
+                PROFILE_ZONE("Render");
 
 #ifdef DEBUG_WINDOW2
+                std::cout << "DoRender: Performing PARTIAL REDRAW with " << regionsToProcess.size() << " regions" << std::endl;
                 int regionIndex = 0;
 #endif
-                for (const auto &region : regionsToProcess)
+                // Partial redraw - the rest of the accumulation target is still valid
+                for (const Rectangle &bounds : regionsToProcess)
                 {
-                    Visual *visual = region.first;
-                    Rectangle bounds = region.second;
-
 #ifdef DEBUG_WINDOW2
                     std::cout << "DoRender: Processing region " << regionIndex++ << " - bounds("
                               << bounds.GetLeft() << "," << bounds.GetTop()
-                              << "," << bounds.GetWidth() << "," << bounds.GetHeight() << ")"
-                              << " visual=" << (visual ? visual->GetName() : "null") << std::endl;
-                    auto regionRenderStart = std::chrono::high_resolution_clock::now();
-#endif
-
-                    if (visual)
-                    {
-                        // Set scissor test to limit rendering to the invalid region
-                        glEnable(GL_SCISSOR_TEST);
-
-                        // Convert coordinates (OpenGL uses bottom-left origin)
-                        int scissorY = scene.GetHeight() - bounds.GetTop() - bounds.GetHeight();
-                        glScissor(bounds.GetLeft(), scissorY, bounds.GetWidth(), bounds.GetHeight());
-
-#ifdef DEBUG_WINDOW2
-                        std::cout << "DoRender: Scissor region set to ("
-                                  << bounds.GetLeft() << "," << scissorY
-                                  << "," << bounds.GetWidth() << "," << bounds.GetHeight() << ")" << std::endl;
+                              << "," << bounds.GetWidth() << "," << bounds.GetHeight() << ")" << std::endl;
 #endif
 
-                        // Clear only this region
-                        glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
-                        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+                    // The region is the bottom of the clip stack, so the scissor limits rendering to it
+                    // and subtrees outside of it are skipped on the CPU
+                    Renderable::SetClipBounds(bounds);
 
-                        // Render the visual
-                        visual->Render();
+                    // Clear only this region
+                    Graphics::ApplyScissor();
+                    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+                    glClear(GL_COLOR_BUFFER_BIT);
 
-                        glDisable(GL_SCISSOR_TEST);
+                    // A region may contain several visuals and the parents behind them,
+                    // render the whole window, the scissor keeps it inside the region.
+                    Render();
+                    Renderable::ResetClipBounds();
+                    Graphics::Flush();
 
-#ifdef DEBUG_WINDOW2
-                        auto regionRenderEnd = std::chrono::high_resolution_clock::now();
-                        auto regionRenderDuration = std::chrono::duration_cast<std::chrono::microseconds>(regionRenderEnd - regionRenderStart);
-                        std::cout << "DoRender: Region render completed in " << regionRenderDuration.count() << "μs" << std::endl;
-#endif
-                    }
-#ifdef DEBUG_WINDOW2
-                    else
-                    {
-                        std::cout << "DoRender: WARNING - Null visual for region " << (regionIndex - 1) << std::endl;
-                    }
-#endif
+                    statistics.RenderedPixels += (size_t)bounds.GetWidth() * (size_t)bounds.GetHeight();
                 }
-#ifdef DEBUG_WINDOW2
-                auto partialRedrawEnd = std::chrono::high_resolution_clock::now();
-                auto partialRedrawDuration = std::chrono::duration_cast<std::chrono::microseconds>(partialRedrawEnd - partialRedrawStart);
-                std::cout << "DoRender: Partial redraw completed in " << partialRedrawDuration.count() << "μs" << std::endl;
-#endif
-            }
-            else
-            {
-#ifdef DEBUG_WINDOW2
-                std::cout << "DoRender: Performing BUFFER COPY (no changes)" << std::endl;
-                auto noCopyStart = std::chrono::high_resolution_clock::now();
-#endif
-                // No changes - just copy front buffer to back buffer
-                glBindFramebuffer(GL_READ_FRAMEBUFFER, frontFramebuffer);
-                glBindFramebuffer(GL_DRAW_FRAMEBUFFER, backFramebuffer);
-                glBlitFramebuffer(0, 0, scene.GetWidth(), scene.GetHeight(),
-                                  0, 0, scene.GetWidth(), scene.GetHeight(),
-                                  GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT, GL_NEAREST);
-#ifdef DEBUG_WINDOW2
-                auto noCopyEnd = std::chrono::high_resolution_clock::now();
-                auto noCopyDuration = std::chrono::duration_cast<std::chrono::microseconds>(noCopyEnd - noCopyStart);
-                std::cout << "DoRender: No-change buffer copy completed in " << noCopyDuration.count() << "μs" << std::endl;
-#endif
             }
 
-#ifdef DEBUG_WINDOW2
-            auto renderingEnd = std::chrono::high_resolution_clock::now();
-            auto renderingDuration = std::chrono::duration_cast<std::chrono::microseconds>(renderingEnd - renderingStart);
-            std::cout << "DoRender: Total rendering phase took " << renderingDuration.count() << "μs" << std::endl;
-
-            auto swapStart = std::chrono::high_resolution_clock::now();
-#endif
-
-            // Swap the framebuffers
-            SwapFramebuffers();
-
-#ifdef DEBUG_WINDOW2
-            auto swapEnd = std::chrono::high_resolution_clock::now();
-            auto swapDuration = std::chrono::duration_cast<std::chrono::microseconds>(swapEnd - swapStart);
-            std::cout << "DoRender: Framebuffer swap took " << swapDuration.count() << "μs" << std::endl;
-
-            auto presentStart = std::chrono::high_resolution_clock::now();
-#endif
+            if (!overlayText.empty())
+                RenderProfilerOverlay(overlayText, overlayTextSize);
 
-            // Copy the front framebuffer content to the default framebuffer for display
-            glBindFramebuffer(GL_READ_FRAMEBUFFER, frontFramebuffer);
-            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
-            glBlitFramebuffer(0, 0, scene.GetWidth(), scene.GetHeight(),
-                              0, 0, scene.GetWidth(), scene.GetHeight(),
-                              GL_COLOR_BUFFER_BIT, GL_NEAREST);
+            {
+                PROFILE_ZONE("Present");
 
-            glfwSwapBuffers(window);
+                // Copy the damaged parts to the window, nothing is presented if nothing changed
+                Present(dirtyRegions.GetRegions(), statistics);
+                lastFrameStatistics = statistics;
+            }
 
 #ifdef DEBUG_WINDOW2
-            auto presentEnd = std::chrono::high_resolution_clock::now();
-            auto presentDuration = std::chrono::duration_cast<std::chrono::microseconds>(presentEnd - presentStart);
-            std::cout << "DoRender: Present to screen took " << presentDuration.count() << "μs" << std::endl;
+            std::cout << "DoRender: Presented " << statistics.PresentedPixels << " pixels" << std::endl;
 #endif
 
             // Check if this is the first completed frame
@@ -1309,23 +1533,41 @@ namespace xit::Drawing
         }
 
 #ifdef DEBUG_WINDOW2
-        auto renderEndTime = std::chrono::high_resolution_clock::now();
-        auto totalRenderDuration = std::chrono::duration_cast<std::chrono::microseconds>(renderEndTime - renderStartTime);
-        std::cout << "DoRender: TOTAL RENDER TIME: " << totalRenderDuration.count() << "μs ("
-                  << ((double)totalRenderDuration.count() / 1000.0) << "ms)" << std::endl;
         std::cout << "=== Window::DoRender END ===\n"
                   << std::endl;
 #endif
     }
 
+    void Window::RenderProfilerOverlay(const std::string &text, const Size &textSize)
+    {
+        static float background[4] = {0.0f, 0.0f, 0.0f, 0.75f};
+        glm::vec4 color(1.0f, 1.0f, 1.0f, 1.0f);
+
+        int left = profilerOverlayBounds.GetLeft();
+        int top = profilerOverlayBounds.GetTop();
+        int width = profilerOverlayBounds.GetWidth();
+        int height = profilerOverlayBounds.GetHeight();
+
+        // OpenGL coordinates start at the bottom
+        int renderTop = scene.GetHeight() - top - height;
+        int textTop = scene.GetHeight() - top - ProfilerOverlayPadding - textSize.GetHeight();
+
+        Graphics::DrawRectangle(left, left, top, renderTop, 0, width, height, glm::vec3(0.0f),
+                                background, nullptr, nullptr, nullptr, nullptr, Thickness(), CornerRadius());
+        TextRenderer::RenderText(UIDefaults::DefaultFont, UIDefaults::DefaultFontSize, text,
+                                 left + ProfilerOverlayPadding, textTop, 0, color);
+        Graphics::Flush();
+    }
+
     //******************************************************************************
     // Double Buffering Implementation
     //******************************************************************************
 
     void Window::InitializeFramebuffers()
     {
+        PROFILE_ZONE("Window::InitializeFramebuffers");
+
 #ifdef DEBUG_WINDOW2
-        auto initStart = std::chrono::high_resolution_clock::now();
         std::cout << "InitializeFramebuffers: Starting framebuffer initialization" << std::endl;
 #endif
 
@@ -1341,7 +1583,7 @@ namespace xit::Drawing
         int height = scene.GetHeight();
 
 #ifdef DEBUG_WINDOW2
-        std::cout << "InitializeFramebuffers: Creating framebuffers with size " << width << "x" << height << std::endl;
+        std::cout << "InitializeFramebuffers: Creating framebuffer with size " << width << "x" << height << std::endl;
 #endif
 
         if (width <= 0 || height <= 0)
@@ -1352,209 +1594,207 @@ namespace xit::Drawing
             return; // Invalid dimensions
         }
 
-        // Generate framebuffers
-        glGenFramebuffers(1, &frontFramebuffer);
-        glGenFramebuffers(1, &backFramebuffer);
-
-        // Generate textures for color attachments
-        glGenTextures(1, &frontColorTexture);
-        glGenTextures(1, &backColorTexture);
-        glGenTextures(1, &frontDepthTexture);
-        glGenTextures(1, &backDepthTexture);
-
-        // Setup front framebuffer
-        glBindFramebuffer(GL_FRAMEBUFFER, frontFramebuffer);
-
-        // Front color texture
-        glBindTexture(GL_TEXTURE_2D, frontColorTexture);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, frontColorTexture, 0);
-
-        // Front depth texture
-        glBindTexture(GL_TEXTURE_2D, frontDepthTexture);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH24_STENCIL8, width, height, 0, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, nullptr);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, frontDepthTexture, 0);
-
-        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
-        {
-#ifdef DEBUG_WINDOW2
-            std::cout << "InitializeFramebuffers: ERROR - Front framebuffer is not complete! Status: "
-                      << glCheckFramebufferStatus(GL_FRAMEBUFFER) << std::endl;
-#endif
-            ERROR("Front framebuffer is not complete!");
-            CleanupFramebuffers();
-            return;
-        }
-
-#ifdef DEBUG_WINDOW2
-        std::cout << "InitializeFramebuffers: Front framebuffer setup complete" << std::endl;
-#endif
+        glGenFramebuffers(1, &framebuffer);
+        glGenTextures(1, &colorTexture);
 
-        // Setup back framebuffer
-        glBindFramebuffer(GL_FRAMEBUFFER, backFramebuffer);
+        RenderState::BindFramebuffer(GL_FRAMEBUFFER, framebuffer);
 
-        // Back color texture
-        glBindTexture(GL_TEXTURE_2D, backColorTexture);
+        // the renderers do not use depth or stencil, the color is all the window needs
+        RenderState::BindTexture(colorTexture);
         glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, backColorTexture, 0);
-
-        // Back depth texture
-        glBindTexture(GL_TEXTURE_2D, backDepthTexture);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH24_STENCIL8, width, height, 0, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, nullptr);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, backDepthTexture, 0);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture, 0);
 
         if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
         {
 #ifdef DEBUG_WINDOW2
-            std::cout << "InitializeFramebuffers: ERROR - Back framebuffer is not complete! Status: "
+            std::cout << "InitializeFramebuffers: ERROR - Framebuffer is not complete! Status: "
                       << glCheckFramebufferStatus(GL_FRAMEBUFFER) << std::endl;
 #endif
-            ERROR("Back framebuffer is not complete!");
+            ERROR("Framebuffer is not complete!");
+            RenderState::BindFramebuffer(GL_FRAMEBUFFER, 0);
             CleanupFramebuffers();
             return;
         }
 
-#ifdef DEBUG_WINDOW2
-        std::cout << "InitializeFramebuffers: Back framebuffer setup complete" << std::endl;
-#endif
-
-        // Clear both framebuffers initially
-        glBindFramebuffer(GL_FRAMEBUFFER, frontFramebuffer);
-        glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-        glBindFramebuffer(GL_FRAMEBUFFER, backFramebuffer);
         glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        glClear(GL_COLOR_BUFFER_BIT);
 
         // Restore default framebuffer
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        RenderState::BindFramebuffer(GL_FRAMEBUFFER, 0);
 
         framebuffersInitialized = true;
 
+        // the buffers of the window do not hold anything of the new target
+        InvalidatePresents();
+
 #ifdef DEBUG_WINDOW2
-        auto initEnd = std::chrono::high_resolution_clock::now();
-        auto initDuration = std::chrono::duration_cast<std::chrono::microseconds>(initEnd - initStart);
-        std::cout << "Window::InitializeFramebuffers - Framebuffers initialized with size "
-                  << width << "x" << height << " in " << initDuration.count() << "μs" << std::endl;
-
-        // Report texture memory usage
-        size_t totalMemory = width * height * 4 * 4; // 4 textures (2 color + 2 depth), 4 bytes per pixel for color
-        totalMemory += width * height * 4 * 2;       // depth textures use 4 bytes per pixel
+        std::cout << "Window::InitializeFramebuffers - Framebuffer initialized with size "
+                  << width << "x" << height << std::endl;
         std::cout << "InitializeFramebuffers: Estimated GPU memory usage: "
-                  << ((double)totalMemory / 1024.0 / 1024.0) << " MB" << std::endl;
+                  << ((double)width * height * 4 / 1024.0 / 1024.0) << " MB" << std::endl;
 #endif
     }
 
     void Window::CleanupFramebuffers()
     {
-        if (!framebuffersInitialized)
+        // also called by a failed InitializeFramebuffers
+        if (framebuffer != 0)
         {
-            return;
+            RenderState::DeleteFramebuffer(framebuffer);
+            framebuffer = 0;
         }
 
-        if (frontFramebuffer != 0)
+        if (colorTexture != 0)
         {
-            glDeleteFramebuffers(1, &frontFramebuffer);
-            frontFramebuffer = 0;
+            RenderState::DeleteTexture(colorTexture);
+            colorTexture = 0;
         }
 
-        if (backFramebuffer != 0)
-        {
-            glDeleteFramebuffers(1, &backFramebuffer);
-            backFramebuffer = 0;
-        }
+        framebuffersInitialized = false;
+
+#ifdef DEBUG_WINDOW2
+        std::cout << "Window::CleanupFramebuffers - Framebuffers cleaned up" << std::endl;
+#endif
+    }
+
+    void Window::Present(const std::vector<Rectangle> &damage, FrameStatistics &statistics)
+    {
+        // the window still shows the last presented frame
+        if (damage.empty() && !isFullPresentNeeded)
+            return;
 
-        if (frontColorTexture != 0)
+        // without a window the accumulation target is the image, see ReadPixels
+        if (isHeadless)
         {
-            glDeleteTextures(1, &frontColorTexture);
-            frontColorTexture = 0;
+            statistics.IsPresented = true;
+            return;
         }
 
-        if (backColorTexture != 0)
+        // The back buffer holds the frame presented bufferAge presents ago, it misses the damage of the presents since.
+        // The whole target is copied if the content of the back buffer is unknown, copying is cheap, rendering is not.
+        int bufferAge = GetBufferAge();
+        bool isFullPresent = isFullPresentNeeded || bufferAge <= 0 || bufferAge - 1 > damageHistoryCount;
+
+        if (presentRegions.GetArea() != scene.SceneRect)
+            presentRegions.SetArea(scene.SceneRect);
+        else
+            presentRegions.Clear();
+
+        if (isFullPresent)
         {
-            glDeleteTextures(1, &backColorTexture);
-            backColorTexture = 0;
+            presentRegions.Add(scene.SceneRect);
         }
-
-        if (frontDepthTexture != 0)
+        else
         {
-            glDeleteTextures(1, &frontDepthTexture);
-            frontDepthTexture = 0;
+            for (const Rectangle &region : damage)
+                presentRegions.Add(region);
+
+            for (int i = 0; i < bufferAge - 1; i++)
+            {
+                for (const Rectangle &region : damageHistory[(damageHistoryStart + (size_t)i) % damageHistory.size()])
+                    presentRegions.Add(region);
+            }
         }
 
-        if (backDepthTexture != 0)
+        // the newest damage comes first, the other buffers of the window miss it. After InvalidatePresents they miss everything.
+        damageHistoryStart = (damageHistoryStart + damageHistory.size() - 1) % damageHistory.size();
+        std::vector<Rectangle> &history = damageHistory[damageHistoryStart];
+
+        if (isFullPresentNeeded)
+            history.assign(1, scene.SceneRect);
+        else
+            history.assign(damage.begin(), damage.end());
+
+        damageHistoryCount = std::min(damageHistoryCount + 1, (int)damageHistory.size());
+        isFullPresentNeeded = false;
+
+        // the blits use the scissor as well
+        Graphics::DisableScissor();
+        Graphics::ApplyScissor();
+
+        RenderState::BindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+        RenderState::BindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+
+        for (const Rectangle &region : presentRegions.GetRegions())
         {
-            glDeleteTextures(1, &backDepthTexture);
-            backDepthTexture = 0;
-        }
+            // OpenGL window coordinates start at the bottom
+            int bottom = scene.GetHeight() - region.GetBottom();
 
-        framebuffersInitialized = false;
+            glBlitFramebuffer(region.GetLeft(), bottom, region.GetRight(), bottom + region.GetHeight(),
+                              region.GetLeft(), bottom, region.GetRight(), bottom + region.GetHeight(),
+                              GL_COLOR_BUFFER_BIT, GL_NEAREST);
 
-#ifdef DEBUG_WINDOW2
-        std::cout << "Window::CleanupFramebuffers - Framebuffers cleaned up" << std::endl;
-#endif
+            statistics.PresentedPixels += (size_t)region.GetWidth() * (size_t)region.GetHeight();
+        }
+
+        // the swap may wait for the vertical blank, that is not work of the frame
+        frameClock.EndRender(Now());
+        glfwSwapBuffers(window);
+        statistics.IsPresented = true;
     }
 
-    void Window::SwapFramebuffers()
+    void Window::ResolveBufferAge()
     {
-#ifdef DEBUG_WINDOW2
-        auto swapStart = std::chrono::high_resolution_clock::now();
-        GLuint oldFront = frontFramebuffer;
-        GLuint oldBack = backFramebuffer;
-#endif
+        // the extension strings of the context API are checked by GLFW, only one of them is supported
+        bufferAgeSource = BufferAgeSource::None;
 
-        // Swap the framebuffer IDs and texture IDs
-        std::swap(frontFramebuffer, backFramebuffer);
-        std::swap(frontColorTexture, backColorTexture);
-        std::swap(frontDepthTexture, backDepthTexture);
+        if (glfwExtensionSupported("EGL_EXT_buffer_age"))
+        {
+            eglGetCurrentDisplayFunction = (void *(*)())glfwGetProcAddress("eglGetCurrentDisplay");
+            eglGetCurrentSurfaceFunction = (void *(*)(int))glfwGetProcAddress("eglGetCurrentSurface");
+            eglQuerySurfaceFunction = (unsigned int (*)(void *, void *, int, int *))glfwGetProcAddress("eglQuerySurface");
 
-#ifdef DEBUG_WINDOW2
-        auto swapEnd = std::chrono::high_resolution_clock::now();
-        auto swapDuration = std::chrono::duration_cast<std::chrono::nanoseconds>(swapEnd - swapStart);
-        std::cout << "Window::SwapFramebuffers - Framebuffers swapped in " << swapDuration.count() << "ns" << std::endl;
-        std::cout << "SwapFramebuffers: Front " << oldFront << " -> " << frontFramebuffer
-                  << ", Back " << oldBack << " -> " << backFramebuffer << std::endl;
-#endif
+            if (eglGetCurrentDisplayFunction && eglGetCurrentSurfaceFunction && eglQuerySurfaceFunction)
+                bufferAgeSource = BufferAgeSource::EGL;
+        }
+        else if (glfwExtensionSupported("GLX_EXT_buffer_age"))
+        {
+            glxGetCurrentDisplayFunction = (void *(*)())glfwGetProcAddress("glXGetCurrentDisplay");
+            glxGetCurrentDrawableFunction = (unsigned long (*)())glfwGetProcAddress("glXGetCurrentDrawable");
+            glxQueryDrawableFunction = (void (*)(void *, unsigned long, int, unsigned int *))glfwGetProcAddress("glXQueryDrawable");
+
+            if (glxGetCurrentDisplayFunction && glxGetCurrentDrawableFunction && glxQueryDrawableFunction)
+                bufferAgeSource = BufferAgeSource::GLX;
+        }
     }
 
-    void Window::CopyRegionBetweenFramebuffers(const Rectangle &region)
+    int Window::GetBufferAge()
     {
-        // Convert region coordinates for OpenGL (bottom-left origin)
-        int sourceY = scene.GetHeight() - region.GetTop() - region.GetHeight();
-        int destY = sourceY;
-
-        glBindFramebuffer(GL_READ_FRAMEBUFFER, frontFramebuffer);
-        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, backFramebuffer);
+        // 0 if the content of the back buffer is unknown
+        switch (bufferAgeSource)
+        {
+        case BufferAgeSource::EGL:
+        {
+            int age = 0;
+            if (!eglQuerySurfaceFunction(eglGetCurrentDisplayFunction(), eglGetCurrentSurfaceFunction(EglDraw), EglBufferAge, &age))
+                return 0;
+            return age;
+        }
+        case BufferAgeSource::GLX:
+        {
+            unsigned int age = 0;
+            glxQueryDrawableFunction(glxGetCurrentDisplayFunction(), glxGetCurrentDrawableFunction(), GlxBackBufferAge, &age);
+            return (int)age;
+        }
+        default:
+            return 0;
+        }
+    }
 
-        glBlitFramebuffer(
-            region.GetLeft(), sourceY,
-            region.GetLeft() + region.GetWidth(), sourceY + region.GetHeight(),
-            region.GetLeft(), destY,
-            region.GetLeft() + region.GetWidth(), destY + region.GetHeight(),
-            GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT,
-            GL_NEAREST);
+    void Window::InvalidatePresents()
+    {
+        isFullPresentNeeded = true;
+        damageHistoryCount = 0;
+    }
 
-#ifdef DEBUG_WINDOW2
-        std::cout << "Window::CopyRegionBetweenFramebuffers - Copied region ("
-                  << region.GetLeft() << "," << region.GetTop()
-                  << "," << region.GetWidth() << "," << region.GetHeight() << ")" << std::endl;
-#endif
+    void Window::Refresh()
+    {
+        // e.g. the window was covered, the system lost its content
+        InvalidatePresents();
+        ScheduleRedraw();
     }
 }
\ No newline at end of file
@@ -1,8 +1,12 @@
 #include <OpenGL/Graphics.h>
 #include <OpenGL/OpenGLExtensions.h>
+#include <OpenGL/Profiler.h>
 #include <OpenGL/Texture.h>
+#include <OpenGL/Text/TextRenderer.h>
 #include <Drawing/Brushes/SolidColorBrush.h>
+#include <Drawing/VisualBase/RenderCommandList.h>
 
+#include <cstddef>
 #include <gtc/type_ptr.hpp>
 
 #ifdef USE_AI_SUGGESTED_FIX
@@ -11,14 +15,42 @@
 
 namespace xit::OpenGL
 {
+    // unit quad, two triangles in the same order as OpenGLExtensions::UpdateRectangle
+    static const float QuadCorners[] =
+        {
+            0.0f, 1.0f, // top left
+            0.0f, 0.0f, // bottom left
+            1.0f, 0.0f, // bottom right
+
+            1.0f, 1.0f, // top right
+            0.0f, 1.0f, // top left
+            1.0f, 0.0f, // bottom right
+    };
+
+    // texture coordinates of rectangles without an image in an atlas page
+    static const float FullTextureRect[] = {0.0f, 0.0f, 1.0f, 1.0f};
+
     bool Graphics::isInitialized = false;
     ShaderProgram *Graphics::shaderProgram = nullptr;
-    AttributeBufferList *Graphics::attributeBufferList = nullptr;
-    AttributeBuffer *Graphics::vertexDataBuffer = nullptr;
-    AttributeBuffer *Graphics::texCoordsDataBuffer = nullptr;
-    AttributeBuffer *Graphics::colorDataBuffer = nullptr;
-    AttributeBuffer *Graphics::foregroundColorDataBuffer = nullptr;
-    AttributeBuffer *Graphics::borderColorDataBuffer = nullptr;
+    VertexBufferArray *Graphics::vertexBufferArray = nullptr;
+    VertexBuffer *Graphics::cornerDataBuffer = nullptr;
+    InstanceBuffer *Graphics::instanceDataBuffer = nullptr;
+    int Graphics::projectionUniform = -1;
+    int Graphics::resolutionUniform = -1;
+    int Graphics::targetOriginUniform = -1;
+    int Graphics::timeUniform = -1;
+    std::vector<QuadInstance> Graphics::instances;
+    const Texture *Graphics::textureSlots[Graphics::MaxTextureSlots] = {nullptr};
+    int Graphics::textureSlotCount = 0;
+    size_t Graphics::drawCallCount = 0;
+    bool Graphics::isScissorEnabled = false;
+    Rectangle Graphics::scissorBounds;
+    int Graphics::targetOriginX = 0;
+    int Graphics::targetOriginY = 0;
+
+    //******************************************************************************
+    // Private
+    //******************************************************************************
 
     void Graphics::InitShader()
     {
@@ -27,14 +59,13 @@ namespace xit::OpenGL
             isInitialized = true;
 
             shaderProgram = new ShaderProgram();
-            attributeBufferList = new AttributeBufferList();
 
             std::string vertexShaderSource = File::ReadAllText("Resources/Shaders/Shader.vert");
             std::string fragmentShaderSource = File::ReadAllText("Resources/Shaders/Shader.frag");
 
             if (vertexShaderSource.empty() || !shaderProgram->CreateVertexShader(vertexShaderSource))
             {
-                vertexShaderSource = "#version 330 core\nuniform mat4 projection;\nlayout(location = 0) in vec3 iPosition;\nlayout(location = 2) in vec4 iColor;out vec4 Color;void main(void){Color = iColor;gl_Position = projection * vec4(iPosition, 1.0);}";
+                vertexShaderSource = "#version 330 core\nuniform mat4 projection;\nlayout(location = 0) in vec2 iCorner;\nlayout(location = 1) in vec4 iRect;\nlayout(location = 2) in vec4 iLocation;\nlayout(location = 5) in vec4 iBackgroundColor;out vec4 Color;void main(void){Color = iBackgroundColor;gl_Position = projection * vec4(iRect.xy + iCorner * iRect.zw, iLocation.z, 1.0);}";
                 shaderProgram->CreateVertexShader(vertexShaderSource);
             }
 
@@ -46,26 +77,75 @@ namespace xit::OpenGL
 
             if (shaderProgram->Link())
             {
-                vertexDataBuffer = attributeBufferList->CreateAttributeBuffer("iPosition");
-                vertexDataBuffer->BindShader(shaderProgram);
-
-                texCoordsDataBuffer = attributeBufferList->CreateAttributeBuffer("iTexCoord");
-                texCoordsDataBuffer->BindShader(shaderProgram);
+                shaderProgram->AssertValid();
 
-                colorDataBuffer = attributeBufferList->CreateAttributeBuffer("iBackgroundColor");
-                colorDataBuffer->BindShader(shaderProgram);
+                instances.reserve(MaxInstances);
+
+                vertexBufferArray = new VertexBufferArray();
+                vertexBufferArray->Create();
+                vertexBufferArray->Bind();
+
+                // per vertex: the corners of the unit quad
+                cornerDataBuffer = new VertexBuffer();
+                cornerDataBuffer->Create();
+                cornerDataBuffer->Bind();
+                cornerDataBuffer->SetData(0, 12, QuadCorners, false, 2);
+
+                // per instance: everything else
+                const int stride = sizeof(QuadInstance);
+
+                instanceDataBuffer = new InstanceBuffer();
+                instanceDataBuffer->Create();
+                instanceDataBuffer->Bind();
+                instanceDataBuffer->Allocate(MaxInstances * stride);
+                instanceDataBuffer->SetAttribute(1, 4, stride, offsetof(QuadInstance, Rect));
+                instanceDataBuffer->SetAttribute(2, 4, stride, offsetof(QuadInstance, Location));
+                instanceDataBuffer->SetAttribute(3, 4, stride, offsetof(QuadInstance, CornerRadius));
+                instanceDataBuffer->SetAttribute(4, 4, stride, offsetof(QuadInstance, BorderThickness));
+                instanceDataBuffer->SetAttribute(5, 4, stride, offsetof(QuadInstance, BackgroundColor));
+                instanceDataBuffer->SetAttribute(6, 4, stride, offsetof(QuadInstance, BorderColor));
+                instanceDataBuffer->SetAttribute(7, 4, stride, offsetof(QuadInstance, TextureParams));
+                instanceDataBuffer->SetAttribute(8, 4, stride, offsetof(QuadInstance, TextureRect));
+                instanceDataBuffer->Unbind();
+
+                vertexBufferArray->Unbind();
+
+                // the sampler array always maps slot n to texture unit n
+                int samplers[MaxTextureSlots];
+                for (int i = 0; i < MaxTextureSlots; i++)
+                    samplers[i] = i;
+
+                shaderProgram->Bind();
+                shaderProgram->SetUniform1("textures", MaxTextureSlots, samplers);
+
+                projectionUniform = shaderProgram->GetUniformHandle("projection");
+                resolutionUniform = shaderProgram->GetUniformHandle("iResolution");
+                targetOriginUniform = shaderProgram->GetUniformHandle("iOrigin");
+                timeUniform = shaderProgram->GetUniformHandle("iTime");
+            }
+        }
+    }
 
-                borderColorDataBuffer = attributeBufferList->CreateAttributeBuffer("iBorderColor");
-                borderColorDataBuffer->BindShader(shaderProgram);
+    float Graphics::GetTextureSlot(const Texture *texture)
+    {
+        for (int i = 0; i < textureSlotCount; i++)
+        {
+            if (textureSlots[i] == texture)
+                return (float)i;
+        }
 
-                foregroundColorDataBuffer = attributeBufferList->CreateAttributeBuffer("iTextColor");
-                foregroundColorDataBuffer->BindShader(shaderProgram);
+        // all texture units are in use, draw what we have and start over
+        if (textureSlotCount == MaxTextureSlots)
+            FlushRectangles();
 
-                shaderProgram->AssertValid();
-            }
-        }
+        textureSlots[textureSlotCount] = texture;
+        return (float)textureSlotCount++;
     }
 
+    //******************************************************************************
+    // Public
+    //******************************************************************************
+
     float *Graphics::GetBrushColor(const BrushBase *brush)
     {
         const SolidColorBrush *solidColorBrush = dynamic_cast<const SolidColorBrush *>(brush);
@@ -79,13 +159,12 @@ namespace xit::OpenGL
 
     void Graphics::DrawRectangle(int x, int renderX, int y, int renderY, int z, int width, int height, glm::vec3 rotation, float *backgroundBrush, float *foregroundBrush, float *borderBrush, const Texture *backgroundTexture, const Texture *borderTexture, const Thickness &borderThickness, const CornerRadius &cornerRadius)
     {
-        static int vertexRect[18] = {0};
-        if (!isInitialized)
-            InitShader();
+        // a recorded rectangle is put into the batch when it is replayed, see QueueQuads
+        RenderCommandList *recording = RenderCommandList::GetRecording();
 
+#ifdef USE_AI_SUGGESTED_FIX
         const Scene2D &currentScene = Scene2D::CurrentScene();
 
-#ifdef USE_AI_SUGGESTED_FIX
         // Ensure we have valid scene dimensions to prevent rendering issues during resize
         int sceneWidth = currentScene.GetWidth();
         int sceneHeight = currentScene.GetHeight();
@@ -104,90 +183,227 @@ namespace xit::OpenGL
 
 #endif
 
-        shaderProgram->Bind();
-        shaderProgram->SetUniformMatrix4("projection", glm::value_ptr(currentScene.ProjectionMatrix));
-        // TODO shaderProgram->SetUniformMatrix4(gl, "model", modelMatrix.to_array());
-
-        shaderProgram->SetUniform4("iCornerRadius",
-                                   (float)cornerRadius.TopLeft,
-                                   (float)cornerRadius.TopRight,
-                                   (float)cornerRadius.BottomRight,
-                                   (float)cornerRadius.BottomLeft);
-        shaderProgram->SetUniform4("iBorderThickness",
-                                   (float)borderThickness.GetLeft(),
-                                   (float)borderThickness.GetTop(),
-                                   (float)borderThickness.GetRight(),
-                                   (float)borderThickness.GetBottom());
-        shaderProgram->SetUniform2("iLocation", (float)x, (float)y);
-        shaderProgram->SetUniform3("iRotation", rotation.x, rotation.y, rotation.z);
-        shaderProgram->SetUniform2("iSize", (float)width, (float)height);
-#ifdef USE_AI_SUGGESTED_FIX
-        shaderProgram->SetUniform2("iResolution", (float)sceneWidth, (float)sceneHeight);
-#else
-        shaderProgram->SetUniform2("iResolution", (float)currentScene.GetWidth(), (float)currentScene.GetHeight());
-#endif
-        shaderProgram->SetUniform1("iTime", (float)currentScene.GetFrameTime());
+        bool hasTexture = backgroundTexture && backgroundTexture->GetIsCreated();
+        bool hasBackground = backgroundBrush && backgroundBrush[3] > 0.0f;
+        bool hasBorder = borderBrush && borderBrush[3] > 0.0f &&
+                         (borderThickness.GetLeft() > 0 || borderThickness.GetTop() > 0 ||
+                          borderThickness.GetRight() > 0 || borderThickness.GetBottom() > 0);
+
+        // nothing visible, e.g. the transparent background of a label, do not break the text batch for it
+        if (!hasTexture && !hasBackground && !hasBorder)
+            return;
+
+        QuadInstance instance;
 
-        attributeBufferList->Bind();
+        instance.Rect[0] = (float)renderX;
+        instance.Rect[1] = (float)renderY;
+        instance.Rect[2] = (float)width;
+        instance.Rect[3] = (float)height;
 
-        OpenGLExtensions::UpdateRectangle(vertexRect, renderX, renderY, z, width, height);
-        vertexDataBuffer->SetData(18, vertexRect, 3);
-        texCoordsDataBuffer->SetData(12, OpenGLExtensions::RectangleTexCoords, false, 2);
+        instance.Location[0] = (float)x;
+        instance.Location[1] = (float)y;
+        instance.Location[2] = (float)z;
+        instance.Location[3] = rotation.x;
 
-        if (!backgroundTexture && !backgroundBrush)
+        instance.CornerRadius[0] = (float)cornerRadius.TopLeft;
+        instance.CornerRadius[1] = (float)cornerRadius.TopRight;
+        instance.CornerRadius[2] = (float)cornerRadius.BottomRight;
+        instance.CornerRadius[3] = (float)cornerRadius.BottomLeft;
+
+        instance.BorderThickness[0] = (float)borderThickness.GetLeft();
+        instance.BorderThickness[1] = (float)borderThickness.GetTop();
+        instance.BorderThickness[2] = (float)borderThickness.GetRight();
+        instance.BorderThickness[3] = (float)borderThickness.GetBottom();
+
+        // brushes are solid colors, the first vertex color is the color of the whole rectangle
+        const float *background = backgroundBrush ? backgroundBrush : OpenGLExtensions::TransparentBrush;
+        const float *border = borderBrush ? borderBrush : OpenGLExtensions::TransparentBrush;
+
+        for (int i = 0; i < 4; i++)
         {
-            shaderProgram->SetUniform1("iIsTexture", 0);
-            colorDataBuffer->SetData(24, OpenGLExtensions::TransparentBrush, false, 4);
+            instance.BackgroundColor[i] = background[i];
+            instance.BorderColor[i] = border[i];
         }
+
+        // foregroundBrush and borderTexture are not used by Shader.frag, the slot is resolved by QueueQuads
+        instance.TextureParams[0] = -1.0f;
+        instance.TextureParams[1] = hasTexture ? static_cast<float>(backgroundTexture->GetChannels()) : 0.0f;
+        instance.TextureParams[2] = 0.0f;
+        instance.TextureParams[3] = 0.0f;
+
+        const float *textureRect = hasTexture ? backgroundTexture->GetTextureRect() : FullTextureRect;
+
+        for (int i = 0; i < 4; i++)
+            instance.TextureRect[i] = textureRect[i];
+
+        // images of the same atlas page share the slot
+        const Texture *texture = hasTexture ? backgroundTexture->GetStorage() : nullptr;
+
+        if (recording)
+            recording->AddQuad(instance, texture);
+        else
+            QueueQuads(&instance, &texture, 1);
+    }
+
+    void Graphics::DrawTexture(int x, int renderX, int y, int renderY, int z, int width, int height, const Texture *texture, bool isPremultiplied)
+    {
+        QuadInstance instance = {};
+
+        instance.Rect[0] = (float)renderX;
+        instance.Rect[1] = (float)renderY;
+        instance.Rect[2] = (float)width;
+        instance.Rect[3] = (float)height;
+
+        instance.Location[0] = (float)x;
+        instance.Location[1] = (float)y;
+        instance.Location[2] = (float)z;
+
+        instance.TextureParams[0] = -1.0f;
+        instance.TextureParams[1] = static_cast<float>(texture->GetChannels());
+        instance.TextureParams[2] = isPremultiplied ? 1.0f : 0.0f;
+
+        const float *textureRect = texture->GetTextureRect();
+
+        for (int i = 0; i < 4; i++)
+            instance.TextureRect[i] = textureRect[i];
+
+        const Texture *storage = texture->GetStorage();
+
+        RenderCommandList *recording = RenderCommandList::GetRecording();
+        if (recording)
+            recording->AddQuad(instance, storage);
         else
+            QueueQuads(&instance, &storage, 1);
+    }
+
+    void Graphics::QueueQuads(const QuadInstance *quads, const Texture *const *textures, size_t count)
+    {
+        if (!isInitialized)
+            InitShader();
+
+        // the queued text is in front of everything queued before and behind these rectangles
+        TextRenderer::Flush();
+
+        size_t i = 0;
+
+        while (i < count)
         {
-            if (backgroundTexture && backgroundTexture->GetIsCreated())
-            {
-                shaderProgram->SetUniform1("iIsTexture", 1);
-                shaderProgram->SetUniform1("iTextureChannels", static_cast<float>(backgroundTexture->GetChannels()));
-                backgroundTexture->Bind();
-            }
-            else if (backgroundBrush)
-            {
-                shaderProgram->SetUniform1("iIsTexture", 0);
-                colorDataBuffer->SetData(24, backgroundBrush, false, 4);
-            }
-            else
+            if (instances.size() >= MaxInstances)
+                FlushRectangles();
+
+            if (textures[i])
             {
-                shaderProgram->SetUniform1("iIsTexture", 0);
+                // the slot has to be resolved before the instance is added, it may flush the batch
+                float textureSlot = GetTextureSlot(textures[i]);
+
+                QuadInstance &instance = instances.emplace_back(quads[i]);
+                instance.TextureParams[0] = textureSlot;
+                i++;
+                continue;
             }
-        }
 
-        if (foregroundBrush)
-        {
-            shaderProgram->SetUniform1("iIsColoredTexture", 1);
-            foregroundColorDataBuffer->SetData(24, foregroundBrush, false, 4);
-        }
-        else
-        {
-            shaderProgram->SetUniform1("iIsColoredTexture", 0);
+            // rectangles without texture are copied as they are, as many as fit into the batch
+            size_t end = i;
+            size_t space = MaxInstances - instances.size();
+
+            while (end < count && !textures[end] && end - i < space)
+                end++;
+
+            instances.insert(instances.end(), quads + i, quads + end);
+            i = end;
         }
+    }
+
+    void Graphics::Flush()
+    {
+        // only one of both is not empty, see DrawRectangle and TextRenderer::RenderText
+        TextRenderer::Flush();
+        FlushRectangles();
+    }
+
+    void Graphics::FlushRectangles()
+    {
+        if (instances.empty())
+            return;
+
+        PROFILE_ZONE("Graphics::FlushRectangles");
+
+        const Scene2D &currentScene = Scene2D::CurrentScene();
+
+        // nothing is unbound after the draw call, unchanged bindings and uniforms are skipped by the next flush
+        shaderProgram->Bind();
+        shaderProgram->SetUniformMatrix4(projectionUniform, glm::value_ptr(currentScene.ProjectionMatrix));
+        shaderProgram->SetUniform2(resolutionUniform, (float)currentScene.GetWidth(), (float)currentScene.GetHeight());
+        shaderProgram->SetUniform1(timeUniform, (float)currentScene.GetFrameTime());
+        shaderProgram->SetUniform2(targetOriginUniform, (float)targetOriginX, (float)targetOriginY);
 
-        if (borderTexture && borderTexture->GetIsCreated())
+        for (int i = 0; i < textureSlotCount; i++)
         {
-            shaderProgram->SetUniform1("iIsBorderTexture", 1);
-            shaderProgram->SetUniform1("iBorderTextureChannels", static_cast<float>(borderTexture->GetChannels()));
-            borderTexture->Bind();
+            textureSlots[i]->Bind(i);
+            textureSlots[i] = nullptr;
         }
-        else if (borderBrush && borderBrush != OpenGLExtensions::TransparentBrush)
+
+        vertexBufferArray->Bind();
+
+        instanceDataBuffer->Bind();
+        instanceDataBuffer->Stream(instances.data(), (GLsizeiptr)(instances.size() * sizeof(QuadInstance)));
+
+        ApplyScissor();
+        glDrawArraysInstanced(GL_TRIANGLES, 0, 6, (GLsizei)instances.size());
+        drawCallCount++;
+        Profiler::Count(ProfileCounter::DrawCalls);
+
+        instances.clear();
+        textureSlotCount = 0;
+    }
+
+    void Graphics::SetScissor(const Rectangle &bounds)
+    {
+        if (isScissorEnabled && scissorBounds == bounds)
+            return;
+
+        // the queued draws belong to the previous clip region
+        Flush();
+
+        isScissorEnabled = true;
+        scissorBounds = bounds;
+    }
+
+    void Graphics::DisableScissor()
+    {
+        if (!isScissorEnabled)
+            return;
+
+        Flush();
+
+        isScissorEnabled = false;
+    }
+
+    void Graphics::ApplyScissor()
+    {
+        if (isScissorEnabled)
         {
-            shaderProgram->SetUniform1("iIsBorderTexture", 0);
+            // OpenGL window coordinates start at the bottom, the scissor is relative to the render target
+            RenderState::SetScissorBox(scissorBounds.GetLeft() - targetOriginX,
+                                       Scene2D::CurrentScene().GetHeight() - scissorBounds.GetBottom() - targetOriginY,
+                                       scissorBounds.GetWidth(),
+                                       scissorBounds.GetHeight());
+            RenderState::SetScissorTest(true);
         }
-        else if (borderBrush)
+        else
         {
-            borderColorDataBuffer->SetData(24, borderBrush, false, 4);
-            shaderProgram->SetUniform1("iIsBorderTexture", 0);
+            RenderState::SetScissorTest(false);
         }
+    }
+
+    void Graphics::SetTargetOrigin(int x, int y)
+    {
+        if (targetOriginX == x && targetOriginY == y)
+            return;
 
-        //  Draw the square.
-        glDrawArrays(GL_TRIANGLES, 0, 6);
+        Flush();
 
-        attributeBufferList->Unbind();
-        shaderProgram->Unbind();
+        targetOriginX = x;
+        targetOriginY = y;
     }
 }
@@ -1,4 +1,5 @@
 #include <OpenGL/OpenGLExtensions.h>
+#include <OpenGL/RenderState.h>
 
 namespace xit::OpenGL
 {
@@ -248,8 +249,8 @@ namespace xit::OpenGL
         glClearColor(0, 0, 0, 0);
 
         // glEnable(GL_DEPTH_TEST);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-        glEnable(GL_BLEND);
+        RenderState::SetBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        RenderState::SetBlend(true);
 
         return Resize2D(width, height);
     }
@@ -261,7 +262,7 @@ namespace xit::OpenGL
 
     mat4 OpenGLExtensions::Resize2D(int width, int height, float zNear, float zFar)
     {
-        glViewport(0, 0, width, height);
+        RenderState::SetViewport(0, 0, width, height);
 
         return ortho<float>(0, (float)width, 0, (float)height, zNear, zFar);
     }
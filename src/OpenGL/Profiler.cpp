@@ -0,0 +1,239 @@
+#include <OpenGL/Profiler.h>
+#include <OpenGL/RenderState.h>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+
+namespace xit::OpenGL
+{
+    std::atomic<bool> Profiler::isEnabled{false};
+    std::atomic<bool> Profiler::isOverlayVisible{false};
+    std::atomic<size_t> Profiler::counters[(size_t)ProfileCounter::Count];
+
+    std::array<ProfileFrame, Profiler::FrameCapacity> Profiler::frames;
+    size_t Profiler::frameCount = 0;
+    int64_t Profiler::frameStart = -1;
+    size_t Profiler::frameStateChanges = 0;
+
+    static const char *const CounterNames[(size_t)ProfileCounter::Count] =
+        {
+            "LayoutMeasures",
+            "LayoutArranges",
+            "DrawCalls",
+            "StateChanges",
+            "GlyphsDrawn",
+            "TextureUploads",
+            "TextureUploadBytes",
+            "Invalidations"};
+
+    static const std::chrono::steady_clock::time_point Epoch = std::chrono::steady_clock::now();
+
+    static void WriteJsonString(std::ostream &stream, const char *value)
+    {
+        stream << '"';
+
+        for (const char *c = value; *c; c++)
+        {
+            if (*c == '"' || *c == '\\')
+                stream << '\\' << *c;
+            else if ((unsigned char)*c < 0x20)
+                stream << ' ';
+            else
+                stream << *c;
+        }
+
+        stream << '"';
+    }
+
+    //******************************************************************************
+    // Private
+    //******************************************************************************
+
+    std::mutex &Profiler::GetMutex()
+    {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+    std::vector<std::shared_ptr<Profiler::ThreadBuffer>> &Profiler::GetThreadBuffers()
+    {
+        static std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+        return buffers;
+    }
+
+    Profiler::ThreadBuffer &Profiler::GetThreadBuffer()
+    {
+        // registered with the first zone of the thread, the list keeps it after the thread ended
+        thread_local std::shared_ptr<ThreadBuffer> buffer;
+
+        if (!buffer)
+        {
+            buffer = std::make_shared<ThreadBuffer>();
+
+            std::lock_guard<std::mutex> lock(GetMutex());
+            std::vector<std::shared_ptr<ThreadBuffer>> &buffers = GetThreadBuffers();
+            buffer->ThreadId = (unsigned int)buffers.size() + 1;
+            buffers.push_back(buffer);
+        }
+
+        return *buffer;
+    }
+
+    //******************************************************************************
+    // Public
+    //******************************************************************************
+
+    int64_t Profiler::Now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - Epoch).count();
+    }
+
+    void Profiler::SetIsEnabled(bool value)
+    {
+        isEnabled.store(value, std::memory_order_relaxed);
+    }
+
+    void Profiler::AddZone(const char *name, int64_t start, int64_t end)
+    {
+        ThreadBuffer &buffer = GetThreadBuffer();
+
+        std::lock_guard<std::mutex> lock(buffer.Mutex);
+        buffer.Events[buffer.Written % ZoneCapacity] = {name, start, end - start};
+        buffer.Written++;
+    }
+
+    void Profiler::BeginFrame()
+    {
+        std::lock_guard<std::mutex> lock(GetMutex());
+
+        // work between two frames, e.g. input, is counted for the next one
+        frameStart = Now();
+        frameStateChanges = RenderState::GetStateChangeCount();
+    }
+
+    void Profiler::EndFrame()
+    {
+        std::lock_guard<std::mutex> lock(GetMutex());
+
+        if (frameStart < 0)
+            return;
+
+        ProfileFrame &frame = frames[frameCount % FrameCapacity];
+        frame.Start = frameStart;
+        frame.Duration = Now() - frameStart;
+
+        for (size_t i = 0; i < (size_t)ProfileCounter::Count; i++)
+            frame.Counters[i] = counters[i].exchange(0, std::memory_order_relaxed);
+
+        // RenderState counts on its own, it is too hot for an atomic per call
+        frame.Counters[(size_t)ProfileCounter::StateChanges] = RenderState::GetStateChangeCount() - frameStateChanges;
+
+        frameCount++;
+        frameStart = -1;
+    }
+
+    ProfileFrame Profiler::GetLastFrame()
+    {
+        std::lock_guard<std::mutex> lock(GetMutex());
+
+        if (frameCount == 0)
+            return ProfileFrame();
+
+        return frames[(frameCount - 1) % FrameCapacity];
+    }
+
+    size_t Profiler::GetFrameCount()
+    {
+        std::lock_guard<std::mutex> lock(GetMutex());
+        return frameCount;
+    }
+
+    void Profiler::Clear()
+    {
+        std::lock_guard<std::mutex> lock(GetMutex());
+
+        for (std::shared_ptr<ThreadBuffer> &buffer : GetThreadBuffers())
+        {
+            std::lock_guard<std::mutex> bufferLock(buffer->Mutex);
+            buffer->Written = 0;
+        }
+
+        frameCount = 0;
+    }
+
+    void Profiler::WriteChromeTrace(std::ostream &stream)
+    {
+        std::lock_guard<std::mutex> lock(GetMutex());
+
+        // Chrome trace times are microseconds, keep the nanoseconds as decimals
+        std::ios::fmtflags flags = stream.flags();
+        std::streamsize precision = stream.precision();
+        stream << std::fixed << std::setprecision(3);
+
+        stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        bool isFirst = true;
+
+        auto writeSeparator = [&]()
+        {
+            if (!isFirst)
+                stream << ",";
+            isFirst = false;
+        };
+
+        for (std::shared_ptr<ThreadBuffer> &buffer : GetThreadBuffers())
+        {
+            std::lock_guard<std::mutex> bufferLock(buffer->Mutex);
+
+            size_t count = std::min(buffer->Written, ZoneCapacity);
+
+            for (size_t i = buffer->Written - count; i < buffer->Written; i++)
+            {
+                const ProfileZoneEvent &event = buffer->Events[i % ZoneCapacity];
+
+                writeSeparator();
+                stream << "{\"name\":";
+                WriteJsonString(stream, event.Name);
+                stream << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->ThreadId
+                       << ",\"ts\":" << (double)event.Start / 1000.0
+                       << ",\"dur\":" << (double)event.Duration / 1000.0 << "}";
+            }
+        }
+
+        size_t count = std::min(frameCount, FrameCapacity);
+
+        for (size_t i = frameCount - count; i < frameCount; i++)
+        {
+            const ProfileFrame &frame = frames[i % FrameCapacity];
+
+            writeSeparator();
+            stream << "{\"name\":\"Frame\",\"ph\":\"C\",\"pid\":1,\"ts\":" << (double)frame.Start / 1000.0 << ",\"args\":{";
+
+            for (size_t c = 0; c < (size_t)ProfileCounter::Count; c++)
+            {
+                if (c > 0)
+                    stream << ",";
+                stream << "\"" << CounterNames[c] << "\":" << frame.Counters[c];
+            }
+
+            stream << "}}";
+        }
+
+        stream << "]}";
+
+        stream.flags(flags);
+        stream.precision(precision);
+    }
+
+    bool Profiler::WriteChromeTrace(const std::string &path)
+    {
+        std::ofstream file(path);
+
+        if (!file)
+            return false;
+
+        WriteChromeTrace(file);
+        return (bool)file;
+    }
+}
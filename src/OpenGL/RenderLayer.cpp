@@ -0,0 +1,213 @@
+#include <OpenGL/RenderLayer.h>
+#include <OpenGL/Graphics.h>
+#include <OpenGL/RenderState.h>
+#include <OpenGL/Scene2D.h>
+
+namespace xit::OpenGL
+{
+    size_t RenderLayer::budget = RenderLayer::DefaultBudget;
+    size_t RenderLayer::usedBytes = 0;
+    size_t RenderLayer::frame = 0;
+    RenderLayer *RenderLayer::current = nullptr;
+
+    RenderLayer::RenderLayer(const void *owner)
+        : owner(owner),
+          framebuffer(0),
+          lastUsedFrame(0),
+          isContentValid(false),
+          parent(nullptr),
+          previousFramebuffer(0),
+          previousViewport{0, 0, 0, 0},
+          originX(0),
+          originY(0)
+    {
+    }
+
+    RenderLayer::~RenderLayer()
+    {
+        if (framebuffer != 0)
+            RenderState::DeleteFramebuffer(framebuffer);
+
+        texture.Destroy();
+    }
+
+    //******************************************************************************
+    // Private
+    //******************************************************************************
+
+    std::list<RenderLayer *> &RenderLayer::GetLayers()
+    {
+        static std::list<RenderLayer *> layers;
+        return layers;
+    }
+
+    bool RenderLayer::Create(int width, int height)
+    {
+        texture.Create();
+        texture.Bind();
+
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+        texture.width = width;
+        texture.height = height;
+        texture.numberOfChannels = 4;
+
+        // the first row of a framebuffer is the bottom, texture coordinates of images start at the top
+        texture.textureRect[1] = 1.0f;
+        texture.textureRect[3] = 0.0f;
+
+        glGenFramebuffers(1, &framebuffer);
+
+        GLuint drawFramebuffer = RenderState::GetDrawFramebuffer();
+        RenderState::BindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture.TextureName(), 0);
+        bool isComplete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+        RenderState::BindFramebuffer(GL_FRAMEBUFFER, drawFramebuffer);
+
+        // e.g. larger than GL_MAX_TEXTURE_SIZE
+        if (!isComplete)
+            return false;
+
+        texture.created = true;
+        texture.done = true;
+        return true;
+    }
+
+    void RenderLayer::Delete(std::list<RenderLayer *>::iterator layer)
+    {
+        usedBytes -= (*layer)->GetByteSize();
+        delete *layer;
+        GetLayers().erase(layer);
+    }
+
+    //******************************************************************************
+    // Public
+    //******************************************************************************
+
+    RenderLayer *RenderLayer::Acquire(const void *owner, int width, int height)
+    {
+        std::list<RenderLayer *> &layers = GetLayers();
+
+        for (auto it = layers.begin(); it != layers.end(); ++it)
+        {
+            if ((*it)->owner != owner)
+                continue;
+
+            if ((*it)->GetWidth() == width && (*it)->GetHeight() == height)
+            {
+                layers.splice(layers.begin(), layers, it);
+                (*it)->lastUsedFrame = frame;
+                return *it;
+            }
+
+            Delete(it);
+            break;
+        }
+
+        size_t bytes = (size_t)width * (size_t)height * 4;
+        if (width <= 0 || height <= 0 || bytes > budget)
+            return nullptr;
+
+        // layers drawn in this frame are kept, deleting them would render them again in every frame
+        while (usedBytes + bytes > budget && !layers.empty() && layers.back()->lastUsedFrame != frame)
+            Delete(std::prev(layers.end()));
+
+        if (usedBytes + bytes > budget)
+            return nullptr;
+
+        RenderLayer *layer = new RenderLayer(owner);
+        if (!layer->Create(width, height))
+        {
+            delete layer;
+            return nullptr;
+        }
+
+        layer->lastUsedFrame = frame;
+        layers.push_front(layer);
+        usedBytes += bytes;
+
+        return layer;
+    }
+
+    void RenderLayer::Release(const void *owner)
+    {
+        std::list<RenderLayer *> &layers = GetLayers();
+
+        for (auto it = layers.begin(); it != layers.end(); ++it)
+        {
+            if ((*it)->owner == owner)
+            {
+                Delete(it);
+                return;
+            }
+        }
+    }
+
+    void RenderLayer::BeginFrame()
+    {
+        frame++;
+    }
+
+    void RenderLayer::SetBudget(size_t bytes)
+    {
+        budget = bytes;
+
+        std::list<RenderLayer *> &layers = GetLayers();
+        while (usedBytes > budget && !layers.empty())
+            Delete(std::prev(layers.end()));
+    }
+
+    void RenderLayer::Begin(int x, int y)
+    {
+        // the queued draws belong to the previous target
+        Graphics::Flush();
+
+        parent = current;
+        current = this;
+        previousFramebuffer = RenderState::GetDrawFramebuffer();
+        for (int i = 0; i < 4; i++)
+            previousViewport[i] = RenderState::GetViewport()[i];
+        originX = x;
+        originY = y;
+
+        // the projection stays the one of the scene, the viewport moves the layer under it
+        const Scene2D &scene = Scene2D::CurrentScene();
+        RenderState::BindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        RenderState::SetViewport(-x, -y, scene.GetWidth(), scene.GetHeight());
+        Graphics::SetTargetOrigin(x, y);
+
+        // colors are multiplied with their alpha, the alpha channel adds up the coverage
+        RenderState::SetBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+        // the next flush sets the scissor of Graphics again
+        RenderState::SetScissorTest(false);
+        glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+    }
+
+    void RenderLayer::End()
+    {
+        Graphics::Flush();
+
+        current = parent;
+        parent = nullptr;
+
+        RenderState::BindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+        RenderState::SetViewport(previousViewport[0], previousViewport[1], previousViewport[2], previousViewport[3]);
+
+        if (current)
+        {
+            Graphics::SetTargetOrigin(current->originX, current->originY);
+            RenderState::SetBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+        }
+        else
+        {
+            Graphics::SetTargetOrigin(0, 0);
+            RenderState::SetBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        }
+    }
+}
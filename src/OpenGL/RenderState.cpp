@@ -0,0 +1,275 @@
+#include <OpenGL/RenderState.h>
+
+#include <algorithm>
+
+namespace xit::OpenGL
+{
+    GLuint RenderState::program = RenderState::Unknown;
+    GLuint RenderState::vertexArray = RenderState::Unknown;
+    GLuint RenderState::arrayBuffer = RenderState::Unknown;
+    int RenderState::activeTextureUnit = -1;
+    GLuint RenderState::textures[RenderState::MaxTextureUnits];
+    int RenderState::isBlendEnabled = -1;
+    GLenum RenderState::blendSource = RenderState::Unknown;
+    GLenum RenderState::blendDestination = RenderState::Unknown;
+    GLenum RenderState::blendSourceAlpha = RenderState::Unknown;
+    GLenum RenderState::blendDestinationAlpha = RenderState::Unknown;
+    int RenderState::isScissorEnabled = -1;
+    int RenderState::scissorBox[4] = {-1, -1, -1, -1};
+    GLuint RenderState::drawFramebuffer = 0;
+    int RenderState::viewport[4] = {-1, -1, -1, -1};
+    size_t RenderState::stateChangeCount = 0;
+    size_t RenderState::skippedChangeCount = 0;
+
+    // textures holds zeros before the first Invalidate, make it unknown as well
+    static const bool IsInitialized = (RenderState::Invalidate(), true);
+
+    void RenderState::Invalidate()
+    {
+        program = Unknown;
+        vertexArray = Unknown;
+        arrayBuffer = Unknown;
+        activeTextureUnit = -1;
+        std::fill(textures, textures + MaxTextureUnits, Unknown);
+        isBlendEnabled = -1;
+        blendSource = Unknown;
+        blendDestination = Unknown;
+        blendSourceAlpha = Unknown;
+        blendDestinationAlpha = Unknown;
+        isScissorEnabled = -1;
+        std::fill(scissorBox, scissorBox + 4, -1);
+        std::fill(viewport, viewport + 4, -1);
+
+        // a new context draws to its default framebuffer
+        drawFramebuffer = 0;
+    }
+
+    void RenderState::UseProgram(GLuint programId)
+    {
+        if (program == programId)
+        {
+            skippedChangeCount++;
+            return;
+        }
+
+        glUseProgram(programId);
+        program = programId;
+        stateChangeCount++;
+    }
+
+    void RenderState::BindVertexArray(GLuint vertexArrayId)
+    {
+        if (vertexArray == vertexArrayId)
+        {
+            skippedChangeCount++;
+            return;
+        }
+
+        glBindVertexArray(vertexArrayId);
+        vertexArray = vertexArrayId;
+        stateChangeCount++;
+    }
+
+    void RenderState::BindBuffer(GLenum target, GLuint bufferId)
+    {
+        if (target == GL_ARRAY_BUFFER)
+        {
+            if (arrayBuffer == bufferId)
+            {
+                skippedChangeCount++;
+                return;
+            }
+
+            arrayBuffer = bufferId;
+        }
+
+        glBindBuffer(target, bufferId);
+        stateChangeCount++;
+    }
+
+    void RenderState::ActiveTexture(int unit)
+    {
+        if (activeTextureUnit == unit)
+        {
+            skippedChangeCount++;
+            return;
+        }
+
+        glActiveTexture(GL_TEXTURE0 + (GLenum)unit);
+        activeTextureUnit = unit;
+        stateChangeCount++;
+    }
+
+    void RenderState::BindTexture(GLuint textureId)
+    {
+        // the unit is unknown, so is its texture
+        if (activeTextureUnit < 0 || activeTextureUnit >= MaxTextureUnits)
+        {
+            glBindTexture(GL_TEXTURE_2D, textureId);
+            stateChangeCount++;
+            return;
+        }
+
+        BindTexture(activeTextureUnit, textureId);
+    }
+
+    void RenderState::BindTexture(int unit, GLuint textureId)
+    {
+        bool isCached = unit >= 0 && unit < MaxTextureUnits;
+
+        if (isCached && textures[unit] == textureId)
+        {
+            skippedChangeCount++;
+            return;
+        }
+
+        ActiveTexture(unit);
+        glBindTexture(GL_TEXTURE_2D, textureId);
+        stateChangeCount++;
+
+        if (isCached)
+            textures[unit] = textureId;
+    }
+
+    void RenderState::SetBlend(bool enabled)
+    {
+        if (isBlendEnabled == (int)enabled)
+        {
+            skippedChangeCount++;
+            return;
+        }
+
+        if (enabled)
+            glEnable(GL_BLEND);
+        else
+            glDisable(GL_BLEND);
+
+        isBlendEnabled = enabled;
+        stateChangeCount++;
+    }
+
+    void RenderState::SetBlendFunc(GLenum source, GLenum destination)
+    {
+        SetBlendFuncSeparate(source, destination, source, destination);
+    }
+
+    void RenderState::SetBlendFuncSeparate(GLenum source, GLenum destination, GLenum sourceAlpha, GLenum destinationAlpha)
+    {
+        if (blendSource == source && blendDestination == destination &&
+            blendSourceAlpha == sourceAlpha && blendDestinationAlpha == destinationAlpha)
+        {
+            skippedChangeCount++;
+            return;
+        }
+
+        glBlendFuncSeparate(source, destination, sourceAlpha, destinationAlpha);
+        blendSource = source;
+        blendDestination = destination;
+        blendSourceAlpha = sourceAlpha;
+        blendDestinationAlpha = destinationAlpha;
+        stateChangeCount++;
+    }
+
+    void RenderState::SetScissorTest(bool enabled)
+    {
+        if (isScissorEnabled == (int)enabled)
+        {
+            skippedChangeCount++;
+            return;
+        }
+
+        if (enabled)
+            glEnable(GL_SCISSOR_TEST);
+        else
+            glDisable(GL_SCISSOR_TEST);
+
+        isScissorEnabled = enabled;
+        stateChangeCount++;
+    }
+
+    void RenderState::SetScissorBox(int x, int y, int width, int height)
+    {
+        if (scissorBox[0] == x && scissorBox[1] == y && scissorBox[2] == width && scissorBox[3] == height)
+        {
+            skippedChangeCount++;
+            return;
+        }
+
+        glScissor(x, y, width, height);
+        scissorBox[0] = x;
+        scissorBox[1] = y;
+        scissorBox[2] = width;
+        scissorBox[3] = height;
+        stateChangeCount++;
+    }
+
+    void RenderState::BindFramebuffer(GLenum target, GLuint framebufferId)
+    {
+        glBindFramebuffer(target, framebufferId);
+        stateChangeCount++;
+
+        if (target != GL_READ_FRAMEBUFFER)
+            drawFramebuffer = framebufferId;
+    }
+
+    void RenderState::SetViewport(int x, int y, int width, int height)
+    {
+        if (viewport[0] == x && viewport[1] == y && viewport[2] == width && viewport[3] == height)
+        {
+            skippedChangeCount++;
+            return;
+        }
+
+        glViewport(x, y, width, height);
+        viewport[0] = x;
+        viewport[1] = y;
+        viewport[2] = width;
+        viewport[3] = height;
+        stateChangeCount++;
+    }
+
+    void RenderState::DeleteProgram(GLuint programId)
+    {
+        glDeleteProgram(programId);
+
+        // a program in use stays alive until another one is used, but its id may be handed out again
+        if (program == programId)
+            program = Unknown;
+    }
+
+    void RenderState::DeleteVertexArray(GLuint vertexArrayId)
+    {
+        glDeleteVertexArrays(1, &vertexArrayId);
+
+        if (vertexArray == vertexArrayId)
+            vertexArray = 0;
+    }
+
+    void RenderState::DeleteBuffer(GLuint bufferId)
+    {
+        glDeleteBuffers(1, &bufferId);
+
+        if (arrayBuffer == bufferId)
+            arrayBuffer = 0;
+    }
+
+    void RenderState::DeleteTexture(GLuint textureId)
+    {
+        glDeleteTextures(1, &textureId);
+
+        for (GLuint &texture : textures)
+        {
+            if (texture == textureId)
+                texture = 0;
+        }
+    }
+
+    void RenderState::DeleteFramebuffer(GLuint framebufferId)
+    {
+        glDeleteFramebuffers(1, &framebufferId);
+
+        // deleting the bound framebuffer binds the default one
+        if (drawFramebuffer == framebufferId)
+            drawFramebuffer = 0;
+    }
+}
@@ -0,0 +1,115 @@
+#include <OpenGL/Text/FontFace.h>
+#include <IO/IO.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace xit::OpenGL
+{
+    FontFace::FontFace()
+        : data(nullptr),
+          dataSize(0),
+          face(nullptr)
+    {
+    }
+
+    FontFace::~FontFace()
+    {
+        Close();
+    }
+
+    //******************************************************************************
+    // Private
+    //******************************************************************************
+
+    void FontFace::Close()
+    {
+        // frees the sizes of the face too
+        if (face)
+        {
+            FT_Done_Face(face);
+            face = nullptr;
+        }
+
+        // the face reads from the mapping until it is done
+        if (data)
+        {
+            munmap(data, dataSize);
+            data = nullptr;
+            dataSize = 0;
+        }
+    }
+
+    //******************************************************************************
+    // Public
+    //******************************************************************************
+
+    bool FontFace::Open(FT_Library library, const std::string &fileName)
+    {
+        Close();
+
+        if (!library)
+            return false;
+
+        int file = open(fileName.c_str(), O_RDONLY | O_CLOEXEC);
+        if (file < 0)
+        {
+            Logger::Log(LogLevel::Error, "FontFace.Open", "Could not open font file %s", fileName.c_str());
+            return false;
+        }
+
+        struct stat status;
+        if (fstat(file, &status) != 0 || status.st_size <= 0)
+        {
+            Logger::Log(LogLevel::Error, "FontFace.Open", "Font file %s is empty", fileName.c_str());
+            close(file);
+            return false;
+        }
+
+        // the mapping is shared by all processes using the font and its pages can be dropped at any time
+        void *mapped = mmap(nullptr, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+        close(file);
+
+        if (mapped == MAP_FAILED)
+        {
+            Logger::Log(LogLevel::Error, "FontFace.Open", "Could not map font file %s", fileName.c_str());
+            return false;
+        }
+
+        data = mapped;
+        dataSize = (size_t)status.st_size;
+
+        FT_Error result = FT_New_Memory_Face(library, (const FT_Byte *)data, (FT_Long)dataSize, 0, &face);
+        if (result != FT_Err_Ok)
+        {
+            Logger::Log(LogLevel::Error, "FontFace.Open", "Failed to load font. Error code: %d", result);
+            face = nullptr;
+            Close();
+            return false;
+        }
+
+        return true;
+    }
+
+    FT_Size FontFace::CreateSize(int pixelSize)
+    {
+        if (!face)
+            return nullptr;
+
+        FT_Size size = nullptr;
+        if (FT_New_Size(face, &size) != FT_Err_Ok)
+            return nullptr;
+
+        // a size is set on the active size of its face
+        FT_Activate_Size(size);
+        if (FT_Set_Pixel_Sizes(face, 0, (FT_UInt)pixelSize) != FT_Err_Ok)
+        {
+            FT_Done_Size(size);
+            return nullptr;
+        }
+
+        return size;
+    }
+}
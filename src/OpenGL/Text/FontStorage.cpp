@@ -1,82 +1,94 @@
 #include <OpenGL/Text/FontStorage.h>
-
-#ifdef DEBUG_FONT_PERFORMANCE
-#include <chrono>
-#include <iostream>
-#endif
+#include <OpenGL/Profiler.h>
 
 namespace xit::OpenGL
 {
+    size_t FontStorage::generation = 1;
+
     FontStorage::FontSizeCharacterList::FontSizeCharacterList()
     {
     }
 
-    FontStorage::FontSizeCharacterList::FontSizeCharacterList(const FontSizeCharacterList &other)
+    // Use Meyer's singleton pattern to avoid static destruction order issues
+    std::map<std::string, FontStorage::FontSizeCharacterList> &FontStorage::GetFontStorageMap()
     {
+        static std::map<std::string, FontStorage::FontSizeCharacterList> fontStorage;
+        return fontStorage;
     }
 
-    FontStorage::FontSizeCharacterList &FontStorage::FontSizeCharacterList::operator=(const FontSizeCharacterList &other)
+    std::map<std::string, FontFace> &FontStorage::GetFontFaceMap()
     {
-        for (std::pair<int, CharacterList> value : other)
-        {
-            emplace(value);
-        }
+        // constructed after the library, so the faces are done before it
+        GetLibrary();
 
-        return *this;
+        static std::map<std::string, FontFace> fontFaces;
+        return fontFaces;
     }
 
-    // Use Meyer's singleton pattern to avoid static destruction order issues
-    std::map<std::string, FontStorage::FontSizeCharacterList> &FontStorage::GetFontStorageMap()
+    FT_Library FontStorage::GetLibrary()
     {
-        static std::map<std::string, FontStorage::FontSizeCharacterList> fontStorage;
-        return fontStorage;
+        struct Library
+        {
+            FT_Library Value = nullptr;
+
+            Library()
+            {
+                if (FT_Init_FreeType(&Value) != FT_Err_Ok)
+                {
+                    Logger::Log(LogLevel::Error, "FontStorage.GetLibrary", "Could not init FreeType Library");
+                    Value = nullptr;
+                }
+            }
+
+            ~Library()
+            {
+                if (Value)
+                    FT_Done_FreeType(Value);
+            }
+        };
+
+        static Library library;
+        return library.Value;
     }
 
-    CharacterList &FontStorage::FindOrCreate(const std::string &fontName, int fontSize)
+    FontFace &FontStorage::FindOrOpenFace(const std::string &fontName)
     {
-#ifdef DEBUG_FONT_PERFORMANCE
-        auto start = std::chrono::high_resolution_clock::now();
-        std::cout << "FontStorage::FindOrCreate - Looking for font '" << fontName
-                  << "' size " << fontSize << std::endl;
-#endif
+        auto [it, inserted] = GetFontFaceMap().try_emplace(fontName);
+
+        if (inserted)
+            it->second.Open(GetLibrary(), fontName);
 
+        return it->second;
+    }
+
+    FontHandle FontStorage::Resolve(const std::string &fontName, int fontSize)
+    {
         FontSizeCharacterList &fontSizeCharacterList = GetFontStorageMap()[fontName];
         CharacterList &characterList = fontSizeCharacterList[fontSize];
 
-        if (characterList.empty())
+        // characters are loaded lazily, a loaded list may still be empty
+        if (characterList.GetLoadState() == FontLoadState::NotLoaded)
         {
-#ifdef DEBUG_FONT_PERFORMANCE
-            std::cout << "FontStorage::FindOrCreate - Character list empty, creating new one" << std::endl;
-            auto createStart = std::chrono::high_resolution_clock::now();
-#endif
-
-            CharacterList::Create(fontName, fontSize, characterList); // TODO if we make characterList a parameter we do not need to copy, we can use it directly
-
-#ifdef DEBUG_FONT_PERFORMANCE
-            auto createEnd = std::chrono::high_resolution_clock::now();
-            auto createDuration = std::chrono::duration_cast<std::chrono::microseconds>(createEnd - createStart);
-            std::cout << "FontStorage::FindOrCreate - CharacterList::Create() took " << createDuration.count()
-                      << "μs" << std::endl;
-#endif
-        }
-#ifdef DEBUG_FONT_PERFORMANCE
-        else
-        {
-            std::cout << "FontStorage::FindOrCreate - Using cached character list" << std::endl;
+            PROFILE_ZONE("FontStorage::Create");
+
+            // the font file is mapped and parsed once, every size only adds an FT_Size to the face
+            CharacterList::Create(FindOrOpenFace(fontName), fontName, fontSize, characterList);
         }
-#endif
 
-#ifdef DEBUG_FONT_PERFORMANCE
-        auto end = std::chrono::high_resolution_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
-        std::cout << "FontStorage::FindOrCreate - Total operation took " << duration.count() << "μs" << std::endl;
-#endif
+        // map nodes are stable, the pointer stays valid until Clear
+        return FontHandle(&characterList, generation);
+    }
 
-        return characterList;
+    CharacterList &FontStorage::FindOrCreate(const std::string &fontName, int fontSize)
+    {
+        return Resolve(fontName, fontSize).GetCharacterList();
     }
 
     void FontStorage::Clear()
     {
+        // the character lists point into the faces
         GetFontStorageMap().clear();
+        GetFontFaceMap().clear();
+        generation++;
     }
 }
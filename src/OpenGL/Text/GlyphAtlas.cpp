@@ -0,0 +1,186 @@
+#include <OpenGL/Text/GlyphAtlas.h>
+#include <OpenGL/Text/TextRenderer.h>
+#include <OpenGL/RenderState.h>
+#include <OpenGL/Profiler.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace xit::OpenGL
+{
+    size_t GlyphAtlas::evictionCount = 0;
+
+    GlyphAtlas::GlyphAtlas()
+        : textureId(0),
+          height(InitialHeight),
+          usedHeight(0),
+          generation(0)
+    {
+    }
+
+    GlyphAtlas::~GlyphAtlas()
+    {
+        Destroy();
+    }
+
+    //******************************************************************************
+    // Private
+    //******************************************************************************
+
+    void GlyphAtlas::CreateTexture()
+    {
+        if (textureId == 0)
+        {
+            glGenTextures(1, &textureId);
+        }
+
+        pixels.resize((size_t)(Width * height), 0);
+
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        RenderState::BindTexture(textureId);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, Width, height, 0, GL_RED, GL_UNSIGNED_BYTE, pixels.data());
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, (int)GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, (int)GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, (int)GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, (int)GL_LINEAR);
+        RenderState::BindTexture(0);
+    }
+
+    bool GlyphAtlas::Allocate(int glyphWidth, int glyphHeight, int &x, int &y)
+    {
+        int paddedWidth = glyphWidth + Padding;
+        int paddedHeight = glyphHeight + Padding;
+
+        // use the lowest shelf the glyph fits into without wasting more than a quarter of the shelf
+        Shelf *best = nullptr;
+
+        for (Shelf &shelf : shelves)
+        {
+            if (shelf.Height >= paddedHeight &&
+                shelf.Height * 3 <= paddedHeight * 4 &&
+                shelf.Used + paddedWidth <= Width &&
+                (!best || shelf.Height < best->Height))
+            {
+                best = &shelf;
+            }
+        }
+
+        if (!best)
+        {
+            if (usedHeight + paddedHeight > height || paddedWidth > Width)
+                return false;
+
+            shelves.push_back({usedHeight, paddedHeight, 0});
+            usedHeight += paddedHeight;
+            best = &shelves.back();
+        }
+
+        x = best->Used;
+        y = best->Top;
+        best->Used += paddedWidth;
+
+        return true;
+    }
+
+    bool GlyphAtlas::Grow()
+    {
+        GLint maxTextureSize = 0;
+        glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+
+        int maxHeight = maxTextureSize > 0 && maxTextureSize < MaxHeight ? maxTextureSize : MaxHeight;
+
+        if (height * 2 > maxHeight)
+            return false;
+
+        // the texture keeps its id and all glyphs keep their pixel positions,
+        // texture coordinates are normalized in the shader with the current texture size
+        height *= 2;
+        CreateTexture();
+
+        return true;
+    }
+
+    void GlyphAtlas::Reset()
+    {
+        // pending text still references the glyphs we are about to overwrite
+        TextRenderer::Flush();
+
+        shelves.clear();
+        usedHeight = 0;
+        std::fill(pixels.begin(), pixels.end(), 0);
+        generation++;
+        evictionCount++;
+
+        // clear the texture too, otherwise old glyphs bleed into the padding of new ones
+        CreateTexture();
+    }
+
+    //******************************************************************************
+    // Public
+    //******************************************************************************
+
+    bool GlyphAtlas::Add(const unsigned char *bitmap, int glyphWidth, int glyphHeight, int pitch, Point &position)
+    {
+        position.X = 0;
+        position.Y = 0;
+
+        // nothing to store for whitespace
+        if (glyphWidth <= 0 || glyphHeight <= 0)
+            return true;
+
+        if (textureId == 0)
+            CreateTexture();
+
+        int x = 0;
+        int y = 0;
+
+        bool allocated = Allocate(glyphWidth, glyphHeight, x, y);
+
+        while (!allocated && Grow())
+        {
+            allocated = Allocate(glyphWidth, glyphHeight, x, y);
+        }
+
+        if (!allocated)
+        {
+            Reset();
+
+            if (!Allocate(glyphWidth, glyphHeight, x, y))
+                return false;
+        }
+
+        for (int row = 0; row < glyphHeight; row++)
+        {
+            std::memcpy(&pixels[(size_t)((y + row) * Width + x)], bitmap + row * pitch, (size_t)glyphWidth);
+        }
+
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, Width);
+        RenderState::BindTexture(textureId);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, glyphWidth, glyphHeight, GL_RED, GL_UNSIGNED_BYTE, &pixels[(size_t)(y * Width + x)]);
+        RenderState::BindTexture(0);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+
+        Profiler::Count(ProfileCounter::TextureUploads);
+        Profiler::Count(ProfileCounter::TextureUploadBytes, (size_t)(glyphWidth * glyphHeight));
+
+        position.X = x;
+        position.Y = y;
+
+        return true;
+    }
+
+    void GlyphAtlas::Destroy()
+    {
+        if (textureId != 0)
+        {
+            RenderState::DeleteTexture(textureId);
+            textureId = 0;
+        }
+
+        shelves.clear();
+        pixels.clear();
+        usedHeight = 0;
+        height = InitialHeight;
+    }
+}
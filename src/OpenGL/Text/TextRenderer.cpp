@@ -1,46 +1,79 @@
 #include <OpenGL/Text/TextRenderer.h>
 #include <OpenGL/Text/FontStorage.h>
 #include <OpenGL/Scene2D.h>
-#include <OpenGL/OpenGLExtensions.h>
+#include <OpenGL/Graphics.h>
+#include <OpenGL/Profiler.h>
+#include <Drawing/VisualBase/RenderCommandList.h>
 
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
 #include <gtc/type_ptr.hpp>
 
-#ifdef DEBUG_TEXT_RENDERER_PERFORMANCE
-#include <chrono>
-#include <iostream>
-#endif
-
 namespace xit::OpenGL
 {
+    // unit quad, two triangles in the same order as OpenGLExtensions::UpdateRectangle
+    static const float GlyphCorners[] =
+        {
+            0.0f, 1.0f, // top left
+            0.0f, 0.0f, // bottom left
+            1.0f, 0.0f, // bottom right
+
+            1.0f, 1.0f, // top right
+            0.0f, 1.0f, // top left
+            1.0f, 0.0f, // bottom right
+    };
+
     bool TextRenderer::isInitialized = false;
     ShaderProgram *TextRenderer::textShader = nullptr;
-    AttributeBufferList *TextRenderer::attributeBufferList = nullptr;
-    AttributeBuffer *TextRenderer::vertexDataBuffer = nullptr;
-    AttributeBuffer *TextRenderer::texCoordsDataBuffer = nullptr;
+    VertexBufferArray *TextRenderer::vertexBufferArray = nullptr;
+    VertexBuffer *TextRenderer::cornerDataBuffer = nullptr;
+    InstanceBuffer *TextRenderer::instanceDataBuffer = nullptr;
+    int TextRenderer::projectionUniform = -1;
+    std::vector<GlyphInstance> TextRenderer::glyphs;
+    GLuint TextRenderer::atlasTexture = 0;
 
     void TextRenderer::Initialize()
     {
         if (!isInitialized)
         {
             textShader = new ShaderProgram();
-            attributeBufferList = new AttributeBufferList();
 
-            //std::string vertexShaderSource = "#version 330 core\nuniform mat4 projection;layout(location = 0) in vec3 iPosition;layout(location = 1) in vec2 iTexCoord;out vec2 TexCoord;void main(){gl_Position = projection * vec4(iPosition, 1.0);TexCoord = iTexCoord;}";
             std::string vertexShaderSource = File::ReadAllText("Resources/Shaders/TextShader.vert");
-            //std::string fragmentShaderSource = "#version 330 core\nuniform sampler2D text;uniform vec4 textColor;in vec2 TexCoord;out vec4 fragColor;void main(){vec4 sampled = vec4(1.0, 1.0, 1.0, texture(text, TexCoord).r);fragColor = textColor * sampled;}";
             std::string fragmentShaderSource = File::ReadAllText("Resources/Shaders/TextShader.frag");
 
             if (textShader->Create(vertexShaderSource, fragmentShaderSource, nullptr))
             {
-                // configure VAO/VBO for texture quads
-                // -----------------------------------
-                vertexDataBuffer = attributeBufferList->CreateAttributeBuffer("iPosition");
-                vertexDataBuffer->BindShader(textShader);
+                textShader->AssertValid();
 
-                texCoordsDataBuffer = attributeBufferList->CreateAttributeBuffer("iTexCoord");
-                texCoordsDataBuffer->BindShader(textShader);
+                projectionUniform = textShader->GetUniformHandle("projection");
 
-                textShader->AssertValid();
+                glyphs.reserve(MaxGlyphs);
+
+                vertexBufferArray = new VertexBufferArray();
+                vertexBufferArray->Create();
+                vertexBufferArray->Bind();
+
+                // per vertex: the corners of the unit quad
+                cornerDataBuffer = new VertexBuffer();
+                cornerDataBuffer->Create();
+                cornerDataBuffer->Bind();
+                cornerDataBuffer->SetData(0, 12, GlyphCorners, false, 2);
+
+                // per instance: glyph rectangle, atlas rectangle, color and depth
+                const int stride = sizeof(GlyphInstance);
+
+                instanceDataBuffer = new InstanceBuffer();
+                instanceDataBuffer->Create();
+                instanceDataBuffer->Bind();
+                instanceDataBuffer->Allocate(MaxGlyphs * stride);
+                instanceDataBuffer->SetAttribute(1, 4, stride, offsetof(GlyphInstance, Rect));
+                instanceDataBuffer->SetAttribute(2, 4, stride, offsetof(GlyphInstance, AtlasRect));
+                instanceDataBuffer->SetAttribute(3, 4, stride, offsetof(GlyphInstance, Color));
+                instanceDataBuffer->SetAttribute(4, 1, stride, offsetof(GlyphInstance, Z));
+                instanceDataBuffer->Unbind();
+
+                vertexBufferArray->Unbind();
             }
 
             isInitialized = true;
@@ -49,48 +82,53 @@ namespace xit::OpenGL
 
     void TextRenderer::RenderText(const std::string &fontName, int fontSize, const std::string &text, int x, int y, int z, glm::vec4 &color)
     {
-#ifdef DEBUG_TEXT_RENDERER_PERFORMANCE
-        auto totalStart = std::chrono::high_resolution_clock::now();
-        std::cout << "TextRenderer::RenderText - Rendering text '" << text << "' at (" << x << "," << y << ")" << std::endl;
-#endif
+        RenderText(FontStorage::Resolve(fontName, fontSize), text, x, y, z, color);
+    }
 
-        Initialize();
+    void TextRenderer::RenderText(const FontHandle &font, const std::string &text, int x, int y, int z, glm::vec4 &color)
+    {
+        PROFILE_ZONE("TextRenderer::RenderText");
 
-#ifdef DEBUG_TEXT_RENDERER_PERFORMANCE
-        auto initEnd = std::chrono::high_resolution_clock::now();
-        auto initDuration = std::chrono::duration_cast<std::chrono::microseconds>(initEnd - totalStart);
-        std::cout << "TextRenderer::RenderText - Initialize() took " << initDuration.count() << "μs" << std::endl;
-#endif
+        Initialize();
 
-        CharacterList &characterList = FontStorage::FindOrCreate(fontName, fontSize);
-        if (characterList.empty())
+        if (!instanceDataBuffer || !font.IsInitialized())
             return;
 
-#ifdef DEBUG_TEXT_RENDERER_PERFORMANCE
-        auto fontEnd = std::chrono::high_resolution_clock::now();
-        auto fontDuration = std::chrono::duration_cast<std::chrono::microseconds>(fontEnd - initEnd);
-        std::cout << "TextRenderer::RenderText - FontStorage::FindOrCreate() took " << fontDuration.count() << "μs" << std::endl;
-#endif
+        CharacterList &characterList = font.GetCharacterList();
 
-        // activate corresponding render state
-        textShader->Bind();
-        textShader->SetUniformMatrix4("projection", glm::value_ptr(Scene2D::CurrentScene().ProjectionMatrix));
-        textShader->SetUniform4("textColor", color.r, color.g, color.b, color.a);
-        glActiveTexture(GL_TEXTURE0);
-        attributeBufferList->Bind();
+        // a recorded run is put into the batches when it is replayed, see QueueGlyphs
+        RenderCommandList *recording = RenderCommandList::GetRecording();
 
-#ifdef DEBUG_TEXT_RENDERER_PERFORMANCE
-        auto setupEnd = std::chrono::high_resolution_clock::now();
-        auto setupDuration = std::chrono::duration_cast<std::chrono::microseconds>(setupEnd - fontEnd);
-        std::cout << "TextRenderer::RenderText - OpenGL setup took " << setupDuration.count() << "μs" << std::endl;
-#endif
+        // draw the queued rectangles first, they are behind the text
+        if (!recording)
+            Graphics::FlushRectangles();
 
-        const float *texCoords = OpenGLExtensions::RectangleTexCoords;
+        size_t textLength = text.length();
 
-        // moved from loop below to avoid setting this value
-        texCoordsDataBuffer->SetData(12, texCoords, false, 2);
+        // load all missing characters before the first glyph of this run is queued,
+        // loading may evict the atlas and that would invalidate glyphs we already queued
+        for (int pass = 0; pass < 2; pass++)
+        {
+            size_t generation = characterList.GetAtlas().GetGeneration();
 
-        size_t textLength = text.length();
+            for (size_t i = 0; i < textLength; i++)
+            {
+                char c = text[i];
+                if (c != '\n' && characterList.NeedsLoad(c))
+                    characterList.LoadSingleCharacter(c);
+            }
+
+            if (generation == characterList.GetAtlas().GetGeneration())
+                break;
+        }
+
+        // one batch uses one atlas
+        GLuint texture = characterList.GetAtlas().GetTextureId();
+        if (!recording && texture != atlasTexture)
+        {
+            Flush();
+            atlasTexture = texture;
+        }
 
         int rows = 0;
 
@@ -101,87 +139,135 @@ namespace xit::OpenGL
                 rows++;
         }
 
+        int fontHeight = characterList.GetFontHeight();
+        int ascent = characterList.GetAscent();
+        int descent = characterList.GetDescent();
+
         int xStart = x;
-        y += rows * characterList.FontHeight;
+        y += rows * fontHeight;
 
-#ifdef DEBUG_TEXT_RENDERER_PERFORMANCE
-        auto preprocessEnd = std::chrono::high_resolution_clock::now();
-        auto preprocessDuration = std::chrono::duration_cast<std::chrono::microseconds>(preprocessEnd - setupEnd);
-        std::cout << "TextRenderer::RenderText - Text preprocessing took " << preprocessDuration.count() << "μs for " << textLength << " characters" << std::endl;
-        auto renderStart = std::chrono::high_resolution_clock::now();
-        int drawCalls = 0;
-#endif
+        // lines outside of the scene are not queued, long texts only cost their visible lines.
+        // a line reaches from its baseline down by the descent and up by the ascent
+        int sceneHeight = Scene2D::CurrentScene().GetHeight();
 
         // iterate through all characters
         for (size_t i = 0; i < textLength; i++)
         {
+            if ((i == 0 || text[i - 1] == '\n') &&
+                (y - descent > sceneHeight || y + ascent < 0))
+            {
+                const char *newLine = (const char *)memchr(text.data() + i, '\n', textLength - i);
+                if (!newLine)
+                    break;
+
+                // continue at the line break
+                i = (size_t)(newLine - text.data());
+            }
+
             char c = text[i];
 
             if (c == '\n')
             {
-                y -= characterList.FontHeight;
+                y -= fontHeight;
                 x = xStart;
                 continue;
             }
 
-            Character character = characterList[c];
-
-            // if (characterList.TryGetValue(c, character))
+            // a missing glyph leaves its space if the font knows its advance
+            const Character *found = characterList.Find(c);
+            if (!found)
             {
-                int left = x + character.Bearing.X;
-                int top = y - (character.GlyphSize.GetHeight() - character.Bearing.Y);
+                x += characterList.GetAdvance(c);
+                continue;
+            }
 
-                int width = character.GlyphSize.GetWidth();
-                int height = character.GlyphSize.GetHeight();
+            const Character &character = *found;
 
-                // update VBO for each character
-                int vertices[] =
-                    {
-                    left, top + height, z,
-                    left, top, z,
-                    left + width, top, z,
+            int width = character.GlyphSize.GetWidth();
+            int height = character.GlyphSize.GetHeight();
 
-                    left + width, top + height, z,
-                    left, top + height, z,
-                    left + width, top, z,
-                    };
+            if (width > 0 && height > 0)
+            {
+                if (!recording && glyphs.size() >= MaxGlyphs)
+                    Flush();
 
-                // render glyph texture over quad
-                glBindTexture(GL_TEXTURE_2D, character.TextureID);
+                GlyphInstance &glyph = recording ? recording->AddGlyph(texture) : glyphs.emplace_back();
 
-                // update content of VBO memory
-                vertexDataBuffer->SetData(18, vertices, 3);
+                glyph.Rect[0] = (float)(x + character.Bearing.X);
+                glyph.Rect[1] = (float)(y - (height - character.Bearing.Y));
+                glyph.Rect[2] = (float)width;
+                glyph.Rect[3] = (float)height;
 
-                // render quad
-                glDrawArrays(GL_TRIANGLES, 0, 6);
+                glyph.AtlasRect[0] = (float)character.AtlasPosition.X;
+                glyph.AtlasRect[1] = (float)character.AtlasPosition.Y;
+                glyph.AtlasRect[2] = (float)width;
+                glyph.AtlasRect[3] = (float)height;
 
-#ifdef DEBUG_TEXT_RENDERER_PERFORMANCE
-                drawCalls++;
-#endif
+                glyph.Color[0] = color.r;
+                glyph.Color[1] = color.g;
+                glyph.Color[2] = color.b;
+                glyph.Color[3] = color.a;
 
-                // now advance cursors for next glyph (note that advance is number of 1/64 pixels)
-                x += character.Advance;
+                glyph.Z = (float)z;
             }
-            // else
-            // {
-            //     Logger::Log(LogLevel::Error, "TextRenderer.RenderText", "Specified character not found %c", c);
-            // }
+
+            // now advance cursors for next glyph
+            x += character.Advance;
+        }
+    }
+
+    void TextRenderer::QueueGlyphs(GLuint texture, const GlyphInstance *instances, size_t count)
+    {
+        Initialize();
+
+        if (!instanceDataBuffer)
+            return;
+
+        Graphics::FlushRectangles();
+
+        if (texture != atlasTexture)
+        {
+            Flush();
+            atlasTexture = texture;
+        }
+
+        while (count > 0)
+        {
+            if (glyphs.size() >= MaxGlyphs)
+                Flush();
+
+            size_t part = std::min(count, (size_t)MaxGlyphs - glyphs.size());
+            glyphs.insert(glyphs.end(), instances, instances + part);
+
+            instances += part;
+            count -= part;
         }
+    }
+
+    void TextRenderer::Flush()
+    {
+        if (glyphs.empty())
+            return;
+
+        PROFILE_ZONE("TextRenderer::Flush");
+
+        // like Graphics::FlushRectangles nothing is unbound, switching between text and rectangles only swaps program and vertex array
+        textShader->Bind();
+        textShader->SetUniformMatrix4(projectionUniform, glm::value_ptr(Scene2D::CurrentScene().ProjectionMatrix));
+
+        RenderState::BindTexture(0, atlasTexture);
+
+        vertexBufferArray->Bind();
 
-#ifdef DEBUG_TEXT_RENDERER_PERFORMANCE
-        auto renderEnd = std::chrono::high_resolution_clock::now();
-        auto renderDuration = std::chrono::duration_cast<std::chrono::microseconds>(renderEnd - renderStart);
-        std::cout << "TextRenderer::RenderText - Character rendering took " << renderDuration.count() << "μs for " << drawCalls << " draw calls" << std::endl;
-#endif
+        instanceDataBuffer->Bind();
+        instanceDataBuffer->Stream(glyphs.data(), (GLsizeiptr)(glyphs.size() * sizeof(GlyphInstance)));
 
-        attributeBufferList->Unbind();
+        Graphics::ApplyScissor();
+        glDrawArraysInstanced(GL_TRIANGLES, 0, 6, (GLsizei)glyphs.size());
 
-        glBindTexture(GL_TEXTURE_2D, 0);
+        Profiler::Count(ProfileCounter::DrawCalls);
+        Profiler::Count(ProfileCounter::GlyphsDrawn, glyphs.size());
 
-#ifdef DEBUG_TEXT_RENDERER_PERFORMANCE
-        auto totalEnd = std::chrono::high_resolution_clock::now();
-        auto totalDuration = std::chrono::duration_cast<std::chrono::microseconds>(totalEnd - totalStart);
-        std::cout << "TextRenderer::RenderText - Total rendering took " << totalDuration.count() << "μs" << std::endl;
-#endif
+        glyphs.clear();
     }
 }
@@ -0,0 +1,236 @@
+#include <OpenGL/Text/TextRun.h>
+
+#include <algorithm>
+
+namespace xit::OpenGL
+{
+    TextRun::TextRun()
+        : isValid(false),
+          offsets(1, 0),
+          lineStarts(1, 0),
+          width(0),
+          widestLineCount(1)
+    {
+    }
+
+    //******************************************************************************
+    // Private
+    //******************************************************************************
+
+    size_t TextRun::GetLineEnd(size_t line) const
+    {
+        // the index of the line break, or the length for the last line
+        return line + 1 < lineStarts.size() ? lineStarts[line + 1] - 1 : GetLength();
+    }
+
+    void TextRun::UpdateWidth()
+    {
+        width = 0;
+        widestLineCount = 0;
+
+        for (size_t line = 0; line < lineStarts.size(); line++)
+            AddLineWidth(offsets[GetLineEnd(line)]);
+    }
+
+    void TextRun::AddLineWidth(int lineWidth)
+    {
+        if (lineWidth > width)
+        {
+            width = lineWidth;
+            widestLineCount = 1;
+        }
+        else if (lineWidth == width)
+        {
+            widestLineCount++;
+        }
+    }
+
+    //******************************************************************************
+    // Public
+    //******************************************************************************
+
+    void TextRun::Update(const FontHandle &value, const std::string &text)
+    {
+        if (IsValid(value))
+            return;
+
+        PROFILE_ZONE("TextRun::Update");
+
+        font = value;
+
+        if (font.IsInitialized())
+        {
+            font.GetCharacterList().LoadAdvances(text);
+            Build(text, font.GetCharacterList().GetAdvances());
+        }
+        else
+        {
+            static const std::array<int, CharacterList::GlyphCount> NoAdvances{};
+            Build(text, NoAdvances);
+        }
+
+        isValid = true;
+    }
+
+    void TextRun::Build(const std::string &text, const std::array<int, CharacterList::GlyphCount> &advances)
+    {
+        size_t length = text.length();
+
+        offsets.resize(length + 1);
+        lineStarts.assign(1, 0);
+        width = 0;
+        widestLineCount = 0;
+
+        int x = 0;
+
+        for (size_t i = 0; i < length; i++)
+        {
+            offsets[i] = x;
+
+            if (text[i] == '\n')
+            {
+                AddLineWidth(x);
+                lineStarts.push_back(i + 1);
+                x = 0;
+            }
+            else
+            {
+                x += advances[(unsigned char)text[i]];
+            }
+        }
+
+        offsets[length] = x;
+        AddLineWidth(x);
+    }
+
+    void TextRun::Edit(const FontHandle &value, const std::string &text, size_t index, size_t removedLength, size_t insertedLength)
+    {
+        if (!IsValid(value))
+        {
+            Update(value, text);
+            return;
+        }
+
+        PROFILE_ZONE("TextRun::Edit");
+
+        if (font.IsInitialized())
+        {
+            font.GetCharacterList().LoadAdvances(text.data() + index, insertedLength);
+            Edit(text, index, removedLength, insertedLength, font.GetCharacterList().GetAdvances());
+        }
+        else
+        {
+            static const std::array<int, CharacterList::GlyphCount> NoAdvances{};
+            Edit(text, index, removedLength, insertedLength, NoAdvances);
+        }
+    }
+
+    void TextRun::Edit(const std::string &text, size_t index, size_t removedLength, size_t insertedLength,
+                       const std::array<int, CharacterList::GlyphCount> &advances)
+    {
+        size_t oldLength = GetLength();
+
+        index = std::min(index, oldLength);
+        removedLength = std::min(removedLength, oldLength - index);
+
+        // the lines touched by the removed characters, in positions before the edit
+        size_t firstLine = GetLine(index);
+        size_t lastLine = GetLine(index + removedLength);
+        size_t start = lineStarts[firstLine];
+        size_t end = GetLineEnd(lastLine) - removedLength + insertedLength;
+
+        // the widest lines which are measured again
+        size_t editedWidestLineCount = 0;
+        for (size_t line = firstLine; line <= lastLine; line++)
+        {
+            if (offsets[GetLineEnd(line)] == width)
+                editedWidestLineCount++;
+        }
+        widestLineCount -= editedWidestLineCount;
+
+        // the offsets are relative to their line, the lines behind the edit only move
+        if (insertedLength > removedLength)
+            offsets.insert(offsets.begin() + (std::ptrdiff_t)index, insertedLength - removedLength, 0);
+        else
+            offsets.erase(offsets.begin() + (std::ptrdiff_t)index, offsets.begin() + (std::ptrdiff_t)(index + removedLength - insertedLength));
+
+        std::ptrdiff_t delta = (std::ptrdiff_t)insertedLength - (std::ptrdiff_t)removedLength;
+        for (size_t line = lastLine + 1; line < lineStarts.size(); line++)
+            lineStarts[line] = (size_t)((std::ptrdiff_t)lineStarts[line] + delta);
+
+        // measure the lines of the edit again, they may have been split or joined
+        std::vector<size_t> editedStarts;
+        int x = 0;
+
+        for (size_t i = start; i < end; i++)
+        {
+            offsets[i] = x;
+
+            if (text[i] == '\n')
+            {
+                AddLineWidth(x);
+                editedStarts.push_back(i + 1);
+                x = 0;
+            }
+            else
+            {
+                x += advances[(unsigned char)text[i]];
+            }
+        }
+
+        offsets[end] = x;
+        AddLineWidth(x);
+
+        lineStarts.erase(lineStarts.begin() + (std::ptrdiff_t)firstLine + 1, lineStarts.begin() + (std::ptrdiff_t)lastLine + 1);
+        lineStarts.insert(lineStarts.begin() + (std::ptrdiff_t)firstLine + 1, editedStarts.begin(), editedStarts.end());
+
+        // only if all widest lines were edited and became narrower the widest of the others is unknown
+        if (widestLineCount == 0)
+            UpdateWidth();
+    }
+
+    size_t TextRun::GetLine(size_t index) const
+    {
+        return (size_t)(std::upper_bound(lineStarts.begin(), lineStarts.end(), index) - lineStarts.begin()) - 1;
+    }
+
+    int TextRun::GetWidth(size_t start, size_t length) const
+    {
+        size_t end = std::min(start + length, GetLength());
+        start = std::min(start, end);
+
+        size_t firstLine = GetLine(start);
+        size_t lastLine = GetLine(end);
+
+        if (firstLine == lastLine)
+            return offsets[end] - offsets[start];
+
+        // the first line from start, the lines in between and the last line up to end
+        int result = offsets[GetLineEnd(firstLine)] - offsets[start];
+
+        for (size_t line = firstLine + 1; line < lastLine; line++)
+            result = std::max(result, offsets[GetLineEnd(line)]);
+
+        return std::max(result, offsets[end]);
+    }
+
+    size_t TextRun::GetIndex(int x, size_t line) const
+    {
+        line = std::min(line, lineStarts.size() - 1);
+
+        auto first = offsets.begin() + (std::ptrdiff_t)lineStarts[line];
+        auto last = offsets.begin() + (std::ptrdiff_t)GetLineEnd(line) + 1;
+
+        // the first caret position at or behind x
+        auto found = std::lower_bound(first, last, x);
+
+        if (found == last)
+            return GetLineEnd(line);
+
+        if (found == first)
+            return lineStarts[line];
+
+        size_t index = (size_t)(found - offsets.begin());
+        return *found - x < x - *(found - 1) ? index : index - 1;
+    }
+}
@@ -1,5 +1,8 @@
 #include <OpenGL/Texture.h>
-#include <Threading/Dispatcher.h>
+#include <OpenGL/TextureAtlas.h>
+#include <OpenGL/TextureLoader.h>
+#include <OpenGL/RenderState.h>
+#include <OpenGL/Profiler.h>
 #include <Security/Cryptography.h>
 #include <Application/App.h>
 
@@ -8,6 +11,13 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include <OpenGL/stb_image.h>
 
+#define STB_IMAGE_RESIZE_IMPLEMENTATION
+#include <OpenGL/stb_image_resize2.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
 namespace xit::OpenGL
 {
     int Texture::textureMaxSize = 0;
@@ -38,13 +48,18 @@ namespace xit::OpenGL
     void Texture::Bind() const
     {
         //	Bind our texture object (make it the current texture).
-        glBindTexture(GL_TEXTURE_2D, textureId);
+        RenderState::BindTexture(GetStorage()->textureId);
+    }
+
+    void Texture::Bind(int unit) const
+    {
+        RenderState::BindTexture(unit, GetStorage()->textureId);
     }
 
     void Texture::Unbind() const
     {
         //	Bind our texture object (make it the current texture).
-        glBindTexture(GL_TEXTURE_2D, 0);
+        RenderState::BindTexture(0);
     }
 
     bool Texture::Create()
@@ -79,7 +94,8 @@ namespace xit::OpenGL
 
         numberOfChannels = nrChannels;
 
-        //  Set the image data.
+        //  Set the image data. Rows of RGB and single channel images are not 4 byte aligned.
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
         glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
 
         //  Set linear filtering mode.
@@ -92,13 +108,14 @@ namespace xit::OpenGL
 
     bool Texture::Create(const std::string &path, int width, int height)
     {
-        //  Store path for async loading and dispatch entire loading process to background thread
+        //  Store path for async loading, the file is decoded by a worker and uploaded by the OpenGL thread
         try
         {
             this->filePath = path;
+            this->displayWidth = width;
+            this->displayHeight = height;
 
-            // Dispatch entire loading process to background thread
-            Dispatcher::Invoke(std::bind(&Texture::CreateFromFileAsync, this));
+            TextureLoader::Load(this);
 
             return true; // Optimistic return, check done flag later
         }
@@ -115,12 +132,9 @@ namespace xit::OpenGL
         if (textureId != 0)
         {
             //	Delete the texture object.
-            glDeleteTextures(1, &textureId);
+            RenderState::DeleteTexture(textureId);
             textureId = 0;
 
-            //  Destroy the pixel data.
-            pixelData = nullptr;
-
             //  Reset width and height.
             width = height = 0;
         }
@@ -131,15 +145,21 @@ namespace xit::OpenGL
         static std::mutex texturesMutex;
         std::unique_lock<std::mutex> lock(texturesMutex);
 
+        // the same file displayed at different sizes is resampled to each of them
+        std::string key = file;
+
+        if (width > 0 || height > 0)
+            key += "@" + std::to_string(std::max(width, 0)) + "x" + std::to_string(std::max(height, 0));
+
         // Check if the texture already exists.
-        auto it = GetTexturesMap().find(file);
+        auto it = GetTexturesMap().find(key);
         if (it != GetTexturesMap().end())
         {
             return &it->second;
         }
 
         // Create a new texture entry in the map and keep the lock
-        Texture &texture = GetTexturesMap()[file];
+        Texture &texture = GetTexturesMap()[key];
 
         // Create the texture while holding the lock to prevent race conditions
         texture.Create(file, width, height);
@@ -147,64 +167,135 @@ namespace xit::OpenGL
         return &texture;
     }
 
-    void Texture::CreateAsync()
+    void Texture::GetResampledSize(int imageWidth, int imageHeight, int displayWidth, int displayHeight, int &resampledWidth, int &resampledHeight)
     {
-        try
-        {
-            created = Create(pixelData, width, height, numberOfChannels);
-            done = true;
-        }
-        catch (const std::exception &e)
-        {
-            std::cerr << "Fuck: " << e.what() << '\n';
-        }
+        resampledWidth = imageWidth;
+        resampledHeight = imageHeight;
 
-        stbi_image_free(pixelData);
-        pixelData = nullptr;
+        // cover the display size in both directions, the aspect ratio is kept
+        float scale = 0.0f;
+
+        if (displayWidth > 0)
+            scale = (float)displayWidth / (float)imageWidth;
+
+        if (displayHeight > 0)
+            scale = std::max(scale, (float)displayHeight / (float)imageHeight);
+
+        // unknown display size or an image smaller than displayed, never scale up
+        if (scale <= 0.0f || scale >= 1.0f)
+            return;
+
+        resampledWidth = std::max(1, (int)std::lround((float)imageWidth * scale));
+        resampledHeight = std::max(1, (int)std::lround((float)imageHeight * scale));
     }
 
-    void Texture::CreateFromFileAsync()
+    void Texture::Decode(DecodedImage &image) const
     {
+        // runs on the workers of the TextureLoader, each has its own track in the trace
+        PROFILE_ZONE("Texture::Decode");
+
         try
         {
             std::string fileName = filePath; // TODO File::Find(filePath);
 
-            if (!fileName.empty())
+            if (fileName.empty())
+                return;
+
+            int imageWidth, imageHeight, nrChannels;
+            unsigned char *pixelData;
+
+            // Optimize: Load directly from file instead of loading to memory first
+            if (fileName.ends_with(".enc"))
             {
-                int imageWidth, imageHeight, nrChannels;
+                // For encrypted files, we still need to decrypt first
+                std::vector<char> bytes = Security::Cryptography::DecryptFromFile(fileName, App::GetPassword());
+                pixelData = stbi_load_from_memory(reinterpret_cast<unsigned char *>(bytes.data()), static_cast<int>(bytes.size()), &imageWidth, &imageHeight, &nrChannels, 0);
+            }
+            else
+            {
+                // Direct file loading - much faster than loading to memory first
+                pixelData = stbi_load(fileName.c_str(), &imageWidth, &imageHeight, &nrChannels, 0);
+            }
 
-                // Optimize: Load directly from file instead of loading to memory first
-                if (fileName.ends_with(".enc"))
-                {
-                    // For encrypted files, we still need to decrypt first
-                    std::vector<char> bytes = Security::Cryptography::DecryptFromFile(fileName, App::GetPassword());
-                    pixelData = stbi_load_from_memory(reinterpret_cast<unsigned char *>(bytes.data()), static_cast<int>(bytes.size()), &imageWidth, &imageHeight, &nrChannels, 0);
-                }
-                else
-                {
-                    // Direct file loading - much faster than loading to memory first
-                    pixelData = stbi_load(fileName.c_str(), &imageWidth, &imageHeight, &nrChannels, 0);
-                }
+            if (!pixelData)
+                return;
 
-                if (pixelData)
-                {
-                    this->width = imageWidth;
-                    this->height = imageHeight;
-                    this->numberOfChannels = nrChannels;
+            int resampledWidth, resampledHeight;
+            GetResampledSize(imageWidth, imageHeight, displayWidth, displayHeight, resampledWidth, resampledHeight);
 
-                    created = Create(pixelData, width, height, numberOfChannels);
+            image.Pixels.resize((size_t)resampledWidth * (size_t)resampledHeight * (size_t)nrChannels);
 
-                    stbi_image_free(pixelData);
-                    pixelData = nullptr;
-                }
+            bool isResampled = false;
+
+            // do not upload (and sample) more pixels than we are going to display
+            if (resampledWidth != imageWidth || resampledHeight != imageHeight)
+            {
+                stbir_pixel_layout layout = nrChannels == 1   ? STBIR_1CHANNEL
+                                            : nrChannels == 2 ? STBIR_RA
+                                            : nrChannels == 3 ? STBIR_RGB
+                                                              : STBIR_RGBA;
+
+                isResampled = stbir_resize_uint8_srgb(pixelData, imageWidth, imageHeight, 0, image.Pixels.data(), resampledWidth, resampledHeight, 0, layout) != nullptr;
             }
 
-            done = true;
+            if (!isResampled)
+            {
+                resampledWidth = imageWidth;
+                resampledHeight = imageHeight;
+
+                image.Pixels.assign(pixelData, pixelData + (size_t)imageWidth * (size_t)imageHeight * (size_t)nrChannels);
+            }
+
+            stbi_image_free(pixelData);
+
+            image.Width = resampledWidth;
+            image.Height = resampledHeight;
+            image.Channels = nrChannels;
+            image.ImageWidth = imageWidth;
+            image.ImageHeight = imageHeight;
         }
         catch (const std::exception &e)
         {
             std::cerr << "Texture loading failed: " << e.what() << std::endl;
-            done = true; // Mark as done even on failure
+            image.Pixels.clear();
+        }
+    }
+
+    void Texture::Upload(const DecodedImage &image)
+    {
+        bool isCreated = false;
+
+        if (!image.Pixels.empty())
+        {
+            PROFILE_ZONE("Texture::Upload");
+            Profiler::Count(ProfileCounter::TextureUploads);
+            Profiler::Count(ProfileCounter::TextureUploadBytes, image.Pixels.size());
+
+            // small images share the pages of the atlas, so they can be drawn in one batch
+            isCreated = TextureAtlas::Add(image.Pixels.data(), image.Width, image.Height, image.Channels, *this);
+
+            if (!isCreated)
+            {
+                const unsigned char *pixels = TextureLoader::BeginPixelUpload(image.Pixels.data(), image.Pixels.size());
+                isCreated = Create(const_cast<unsigned char *>(pixels), image.Width, image.Height, image.Channels);
+                TextureLoader::EndPixelUpload();
+
+                // without a display size the image is scaled down at draw time
+                if (isCreated && displayWidth <= 0 && displayHeight <= 0)
+                {
+                    Bind();
+                    glGenerateMipmap(GL_TEXTURE_2D);
+                    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+                    Unbind();
+                }
+            }
+
+            // layout uses the size of the image, not the size of the uploaded pixels
+            this->width = image.ImageWidth;
+            this->height = image.ImageHeight;
         }
+
+        created.store(isCreated, std::memory_order_release);
+        done.store(true, std::memory_order_release);
     }
 }
@@ -0,0 +1,171 @@
+#include <OpenGL/TextureAtlas.h>
+
+namespace xit::OpenGL
+{
+    // Use Meyer's singleton pattern to avoid static destruction order issues
+    std::list<TextureAtlas::Page> &TextureAtlas::GetPages()
+    {
+        static std::list<Page> pages;
+        return pages;
+    }
+
+    //******************************************************************************
+    // Private
+    //******************************************************************************
+
+    void TextureAtlas::CreatePage(Page &page)
+    {
+        Texture &storage = page.Storage;
+
+        // the padding between the images has to be transparent
+        std::vector<unsigned char> clear((size_t)PageSize * (size_t)PageSize * 4, 0);
+
+        storage.Create();
+        storage.Bind();
+
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, PageSize, PageSize, 0, GL_RGBA, GL_UNSIGNED_BYTE, clear.data());
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+        storage.Unbind();
+
+        storage.width = PageSize;
+        storage.height = PageSize;
+        storage.numberOfChannels = 4;
+        storage.created = true;
+        storage.done = true;
+    }
+
+    bool TextureAtlas::Allocate(Page &page, int imageWidth, int imageHeight, int &x, int &y)
+    {
+        int paddedWidth = imageWidth + Padding;
+        int paddedHeight = imageHeight + Padding;
+
+        // use the lowest shelf the image fits into without wasting more than a quarter of the shelf
+        Shelf *best = nullptr;
+
+        for (Shelf &shelf : page.Shelves)
+        {
+            if (shelf.Height >= paddedHeight &&
+                shelf.Height * 3 <= paddedHeight * 4 &&
+                shelf.Used + paddedWidth <= PageSize &&
+                (!best || shelf.Height < best->Height))
+            {
+                best = &shelf;
+            }
+        }
+
+        if (!best)
+        {
+            if (page.UsedHeight + paddedHeight > PageSize)
+                return false;
+
+            page.Shelves.push_back({page.UsedHeight, paddedHeight, 0});
+            page.UsedHeight += paddedHeight;
+            best = &page.Shelves.back();
+        }
+
+        x = best->Used;
+        y = best->Top;
+        best->Used += paddedWidth;
+
+        return true;
+    }
+
+    //******************************************************************************
+    // Public
+    //******************************************************************************
+
+    bool TextureAtlas::Add(const unsigned char *pixels, int imageWidth, int imageHeight, int channels, Texture &texture)
+    {
+        if (imageWidth <= 0 || imageHeight <= 0 || imageWidth > MaxImageSize || imageHeight > MaxImageSize)
+            return false;
+
+        if (channels < 1 || channels > 4)
+            return false;
+
+        std::list<Page> &pages = GetPages();
+
+        Page *target = nullptr;
+        int x = 0;
+        int y = 0;
+
+        for (Page &page : pages)
+        {
+            if (Allocate(page, imageWidth, imageHeight, x, y))
+            {
+                target = &page;
+                break;
+            }
+        }
+
+        if (!target)
+        {
+            target = &pages.emplace_back();
+            CreatePage(*target);
+
+            if (!Allocate(*target, imageWidth, imageHeight, x, y))
+                return false;
+        }
+
+        // all pages are RGBA. Single channel images are drawn as vec4(r) by Shader.frag, keep that look
+        std::vector<unsigned char> rgba((size_t)imageWidth * (size_t)imageHeight * 4);
+
+        for (size_t i = 0, count = (size_t)imageWidth * (size_t)imageHeight; i < count; i++)
+        {
+            const unsigned char *source = pixels + i * (size_t)channels;
+            unsigned char *destination = &rgba[i * 4];
+
+            switch (channels)
+            {
+            case 1:
+                destination[0] = destination[1] = destination[2] = destination[3] = source[0];
+                break;
+            case 2:
+                destination[0] = destination[1] = destination[2] = source[0];
+                destination[3] = source[1];
+                break;
+            case 3:
+                destination[0] = source[0];
+                destination[1] = source[1];
+                destination[2] = source[2];
+                destination[3] = 255;
+                break;
+            default:
+                destination[0] = source[0];
+                destination[1] = source[1];
+                destination[2] = source[2];
+                destination[3] = source[3];
+                break;
+            }
+        }
+
+        target->Storage.Bind();
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, imageWidth, imageHeight, GL_RGBA, GL_UNSIGNED_BYTE, rgba.data());
+        target->Storage.Unbind();
+
+        // sample texel centers only, linear filtering must not reach into the padding
+        texture.page = &target->Storage;
+        texture.textureRect[0] = ((float)x + 0.5f) / (float)PageSize;
+        texture.textureRect[1] = ((float)y + 0.5f) / (float)PageSize;
+        texture.textureRect[2] = ((float)(x + imageWidth) - 0.5f) / (float)PageSize;
+        texture.textureRect[3] = ((float)(y + imageHeight) - 0.5f) / (float)PageSize;
+        texture.numberOfChannels = 4;
+
+        return true;
+    }
+
+    void TextureAtlas::Destroy()
+    {
+        for (Page &page : GetPages())
+        {
+            page.Storage.Destroy();
+        }
+
+        GetPages().clear();
+    }
+}
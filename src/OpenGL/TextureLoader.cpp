@@ -0,0 +1,189 @@
+#include <OpenGL/TextureLoader.h>
+#include <OpenGL/Texture.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace xit::OpenGL
+{
+    GLuint TextureLoader::pixelBuffer = 0;
+    std::atomic<void (*)()> TextureLoader::wakeUp{nullptr};
+
+    TextureLoader::Pool::~Pool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(Mutex);
+            IsStopping = true;
+        }
+
+        JobAvailable.notify_all();
+        StagingAvailable.notify_all();
+
+        for (std::thread &worker : Workers)
+        {
+            if (worker.joinable())
+                worker.join();
+        }
+    }
+
+    // Use Meyer's singleton pattern to avoid static destruction order issues
+    TextureLoader::Pool &TextureLoader::GetPool()
+    {
+        static Pool pool;
+        return pool;
+    }
+
+    //******************************************************************************
+    // Private
+    //******************************************************************************
+
+    void TextureLoader::Work(Pool &pool)
+    {
+        std::unique_lock<std::mutex> lock(pool.Mutex);
+
+        while (true)
+        {
+            pool.JobAvailable.wait(lock, [&pool]
+                                   { return pool.IsStopping || !pool.Jobs.empty(); });
+
+            if (pool.IsStopping)
+                return;
+
+            Texture *texture = pool.Jobs.front();
+            pool.Jobs.pop_front();
+
+            // reading, decrypting, decoding and resampling do not need the lock
+            lock.unlock();
+
+            DecodedImage image;
+            image.Target = texture;
+            texture->Decode(image);
+
+            lock.lock();
+
+            // keeps the memory of decoded images bounded when the OpenGL thread falls behind
+            pool.StagingAvailable.wait(lock, [&pool]
+                                       { return pool.IsStopping || pool.Staged.size() < MaxStagedImages; });
+
+            if (pool.IsStopping)
+                return;
+
+            pool.Staged.push_back(std::move(image));
+
+            // the OpenGL thread may sleep until the next event
+            if (void (*function)() = wakeUp.load())
+            {
+                lock.unlock();
+                function();
+                lock.lock();
+            }
+        }
+    }
+
+    //******************************************************************************
+    // Public
+    //******************************************************************************
+
+    void TextureLoader::Load(Texture *texture)
+    {
+        Pool &pool = GetPool();
+
+        {
+            std::lock_guard<std::mutex> lock(pool.Mutex);
+
+            if (pool.Workers.empty())
+            {
+                // leave cores for the OpenGL thread and the rest of the application
+                unsigned int count = std::clamp(std::thread::hardware_concurrency() / 2, 1u, MaxWorkers);
+
+                for (unsigned int i = 0; i < count; i++)
+                    pool.Workers.emplace_back(&TextureLoader::Work, std::ref(pool));
+            }
+
+            pool.Jobs.push_back(texture);
+            pool.Pending++;
+        }
+
+        pool.JobAvailable.notify_one();
+    }
+
+    size_t TextureLoader::ProcessUploads(std::chrono::microseconds budget)
+    {
+        Pool &pool = GetPool();
+
+        auto start = std::chrono::steady_clock::now();
+        size_t count = 0;
+
+        while (true)
+        {
+            DecodedImage image;
+
+            {
+                std::lock_guard<std::mutex> lock(pool.Mutex);
+
+                if (pool.Staged.empty())
+                    break;
+
+                image = std::move(pool.Staged.front());
+                pool.Staged.pop_front();
+                pool.Pending--;
+            }
+
+            pool.StagingAvailable.notify_one();
+
+            image.Target->Upload(image);
+            count++;
+
+            if (std::chrono::steady_clock::now() - start >= budget)
+                break;
+        }
+
+        return count;
+    }
+
+    size_t TextureLoader::GetPendingLoadCount()
+    {
+        Pool &pool = GetPool();
+
+        std::lock_guard<std::mutex> lock(pool.Mutex);
+        return pool.Pending;
+    }
+
+    bool TextureLoader::HasStagedImages()
+    {
+        Pool &pool = GetPool();
+
+        std::lock_guard<std::mutex> lock(pool.Mutex);
+        return !pool.Staged.empty();
+    }
+
+    const unsigned char *TextureLoader::BeginPixelUpload(const unsigned char *pixels, size_t size)
+    {
+        if (pixelBuffer == 0)
+            glGenBuffers(1, &pixelBuffer);
+
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixelBuffer);
+
+        // orphan the storage of the previous upload, the driver may still be copying from it
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, (GLsizeiptr)size, nullptr, GL_STREAM_DRAW);
+
+        void *target = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, (GLsizeiptr)size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+
+        if (target)
+        {
+            std::memcpy(target, pixels, size);
+
+            // the buffer content is undefined if unmapping fails, upload from client memory then
+            if (glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_TRUE)
+                return nullptr; // offset 0 into the bound buffer
+        }
+
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        return pixels;
+    }
+
+    void TextureLoader::EndPixelUpload()
+    {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+}
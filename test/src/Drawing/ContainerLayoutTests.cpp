@@ -295,3 +295,53 @@ TEST(ContainerLayoutTest, BasicContainerWithLabel_NoUpdate)
     // Cleanup
     delete label;
 }
+
+TEST(ContainerLayoutTest, IncrementalLayout_IdleUpdateTouchesNoNodes)
+{
+    // children first, they have to outlive the container
+    Visual first;
+    first.SetName("First");
+    first.SetHeight(20);
+    first.SetRow(0);
+
+    Visual second;
+    second.SetName("Second");
+    second.SetRow(1);
+
+    Container container;
+    container.SetName("TestContainer");
+    container.SetRows("50,50");
+    container.AddChild(&first);
+    container.AddChild(&second);
+
+    scene.Resize(400, 300);
+    Scene2D::MakeCurrent(&scene);
+
+    Rectangle containerBounds(0, 0, 400, 300);
+    container.UpdateLayout(containerBounds);
+
+    // nothing changed, nothing is laid out
+    Visual::ResetLayoutPassCount();
+    bool needsRedraw = container.UpdateLayout(containerBounds);
+
+    ASSERT_FALSE(needsRedraw) << "Unchanged layout should not need a redraw";
+    ASSERT_EQ(Visual::GetLayoutPassCount(), 0u) << "Idle update should not lay out any element";
+
+    // a changed child marks the path to it, its sibling is skipped
+    first.SetHeight(30);
+    ASSERT_TRUE(container.GetNeedChildLayout()) << "Parent should be marked for the changed child";
+    ASSERT_FALSE(second.GetNeedLayout()) << "Sibling should not be marked";
+
+    // the new desired size of the child is handed to the parent by a second pass, like Window::DoRender does
+    Visual::ResetLayoutPassCount();
+    for (int pass = 0; pass < 8 && container.GetNeedLayout(); pass++)
+        container.UpdateLayout(containerBounds);
+
+    ASSERT_FALSE(container.GetNeedLayout()) << "Layout should settle within a few passes";
+    ASSERT_EQ(first.GetActualHeight(), 30) << "Changed child should be laid out again";
+    ASSERT_GT(Visual::GetLayoutPassCount(), 0u);
+
+    Visual::ResetLayoutPassCount();
+    container.UpdateLayout(containerBounds);
+    ASSERT_EQ(Visual::GetLayoutPassCount(), 0u) << "Layout should be idle again after the change";
+}
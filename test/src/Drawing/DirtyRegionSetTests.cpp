@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+#include <Drawing/DirtyRegionSet.h>
+
+using namespace xit::Drawing;
+
+TEST(DirtyRegionSetTest, EmptyAfterSetArea)
+{
+    DirtyRegionSet regions;
+    regions.SetArea(Rectangle(0, 0, 400, 300));
+
+    ASSERT_TRUE(regions.IsEmpty());
+    ASSERT_TRUE(regions.GetRegions().empty());
+    ASSERT_EQ(regions.GetCoveredArea(), 0);
+}
+
+TEST(DirtyRegionSetTest, RegionsOutsideOfAreaAreIgnored)
+{
+    DirtyRegionSet regions;
+    regions.SetArea(Rectangle(0, 0, 400, 300));
+
+    regions.Add(Rectangle(500, 500, 10, 10));
+    regions.Add(Rectangle(-20, 10, 10, 10));
+
+    ASSERT_TRUE(regions.IsEmpty());
+}
+
+TEST(DirtyRegionSetTest, RegionsAreClippedToArea)
+{
+    DirtyRegionSet regions;
+    regions.SetArea(Rectangle(0, 0, 400, 300));
+
+    regions.Add(Rectangle(390, 290, 20, 20));
+
+    const std::vector<Rectangle> &result = regions.GetRegions();
+    ASSERT_EQ(result.size(), 1u);
+    ASSERT_EQ(result[0].GetLeft(), 390);
+    ASSERT_EQ(result[0].GetTop(), 290);
+    ASSERT_EQ(result[0].GetWidth(), 10);
+    ASSERT_EQ(result[0].GetHeight(), 10);
+}
+
+TEST(DirtyRegionSetTest, OverlappingRegionsAreMerged)
+{
+    DirtyRegionSet regions;
+    regions.SetArea(Rectangle(0, 0, 400, 400));
+
+    // both centers are in different buckets, the buckets overlap afterwards
+    regions.Add(Rectangle(60, 60, 30, 30));
+    regions.Add(Rectangle(80, 80, 40, 40));
+
+    const std::vector<Rectangle> &result = regions.GetRegions();
+    ASSERT_EQ(result.size(), 1u);
+    ASSERT_EQ(result[0].GetLeft(), 60);
+    ASSERT_EQ(result[0].GetTop(), 60);
+    ASSERT_EQ(result[0].GetRight(), 120);
+    ASSERT_EQ(result[0].GetBottom(), 120);
+}
+
+TEST(DirtyRegionSetTest, SeparateRegionsAreKept)
+{
+    DirtyRegionSet regions;
+    regions.SetArea(Rectangle(0, 0, 400, 400));
+
+    regions.Add(Rectangle(10, 10, 20, 20));
+    regions.Add(Rectangle(300, 300, 20, 20));
+
+    ASSERT_EQ(regions.GetRegions().size(), 2u);
+    ASSERT_EQ(regions.GetCoveredArea(), 800);
+}
+
+TEST(DirtyRegionSetTest, NumberOfRegionsIsBounded)
+{
+    DirtyRegionSet regions;
+    regions.SetArea(Rectangle(0, 0, 400, 400));
+
+    for (int i = 0; i < 1000; i++)
+        regions.Add(Rectangle((i * 37) % 390, (i * 91) % 390, 10, 10));
+
+    ASSERT_LE(regions.GetRegions().size(), (size_t)DirtyRegionSet::MaxRegions);
+    ASSERT_LE(regions.GetCoveredArea(), 400 * 400);
+
+    regions.Clear();
+    ASSERT_TRUE(regions.IsEmpty());
+}
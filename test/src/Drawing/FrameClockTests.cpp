@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+#include <Drawing/FrameClock.h>
+
+using namespace xit::Drawing;
+using namespace std::chrono_literals;
+
+TEST(FrameClockTest, IntervalFollowsTheRefreshRate)
+{
+    FrameClock clock;
+    EXPECT_EQ(clock.GetRefreshRate(), FrameClock::DefaultRefreshRate);
+
+    clock.SetRefreshRate(144);
+    EXPECT_EQ(clock.GetRefreshRate(), 144);
+    EXPECT_EQ(std::chrono::duration_cast<std::chrono::microseconds>(clock.GetInterval()).count(), 6944);
+
+    clock.SetRefreshRate(0);
+    EXPECT_EQ(clock.GetRefreshRate(), FrameClock::DefaultRefreshRate);
+}
+
+TEST(FrameClockTest, FirstFrameIsDueImmediately)
+{
+    FrameClock clock;
+    EXPECT_TRUE(clock.IsFrameDue(FrameClock::Clock::now()));
+}
+
+TEST(FrameClockTest, NextFrameStartsOnTheNextTick)
+{
+    FrameClock clock;
+    clock.SetRefreshRate(100);
+
+    FrameClock::Clock::time_point start{1s};
+    clock.BeginFrame(start);
+    clock.EndFrame(start + 2ms, false);
+
+    EXPECT_FALSE(clock.GetIsLastFrameLate());
+    EXPECT_EQ(clock.GetNextFrameTime(), start + 10ms);
+    EXPECT_FALSE(clock.IsFrameDue(start + 9ms));
+    EXPECT_TRUE(clock.IsFrameDue(start + 10ms));
+}
+
+TEST(FrameClockTest, LateFrameIsCountedAndSkipsATick)
+{
+    FrameClock clock;
+    clock.SetRefreshRate(100);
+
+    FrameClock::Clock::time_point start{1s};
+    clock.BeginFrame(start);
+    clock.EndFrame(start + 15ms, false);
+
+    EXPECT_TRUE(clock.GetIsLastFrameLate());
+    EXPECT_EQ(clock.GetLateFrameCount(), 1u);
+    EXPECT_EQ(clock.GetFrameCount(), 1u);
+    EXPECT_EQ(clock.GetNextFrameTime(), start + 20ms);
+}
+
+TEST(FrameClockTest, PresentWithVSyncMovesTheTicks)
+{
+    FrameClock clock;
+    clock.SetRefreshRate(100);
+    clock.SetIsVSync(true);
+
+    FrameClock::Clock::time_point start{1s};
+    clock.BeginFrame(start);
+    clock.EndFrame(start + 7ms, true);
+
+    // the swap waited for the blank already
+    EXPECT_EQ(clock.GetNextFrameTime(), start + 7ms);
+
+    clock.BeginFrame(start + 7ms);
+    clock.EndFrame(start + 8ms, false);
+    EXPECT_EQ(clock.GetNextFrameTime(), start + 17ms);
+}
+
+TEST(FrameClockTest, PhasesShareTheBudget)
+{
+    FrameClock clock;
+    clock.SetRefreshRate(100);
+
+    FrameClock::Clock::time_point start{1s};
+    EXPECT_FALSE(clock.IsLayoutOverBudget(start + 1h));
+
+    clock.BeginFrame(start);
+    EXPECT_EQ(clock.GetRemainingUpdateBudget(start + 1ms), 1500us);
+    EXPECT_EQ(clock.GetRemainingUpdateBudget(start + 5ms), 0ms);
+
+    clock.EndUpdate(start + 1ms);
+    EXPECT_FALSE(clock.IsLayoutOverBudget(start + 3ms));
+    EXPECT_TRUE(clock.IsLayoutOverBudget(start + 4ms));
+
+    clock.EndLayout(start + 4ms);
+    EXPECT_EQ(clock.GetLastUpdateDuration(), 1ms);
+    EXPECT_EQ(clock.GetLastLayoutDuration(), 3ms);
+}
+
+TEST(FrameClockTest, SwapWaitIsNotLate)
+{
+    FrameClock clock;
+    clock.SetRefreshRate(100);
+    clock.SetIsVSync(true);
+
+    // the work took 4ms, the swap waited for the blank a whole interval later
+    FrameClock::Clock::time_point start{1s};
+    clock.BeginFrame(start);
+    clock.EndRender(start + 4ms);
+    clock.EndFrame(start + 11ms, true);
+
+    EXPECT_FALSE(clock.GetIsLastFrameLate());
+    EXPECT_EQ(clock.GetLastWorkDuration(), 4ms);
+    EXPECT_EQ(clock.GetLastFrameDuration(), 11ms);
+
+    // work past the interval before the swap is late
+    clock.BeginFrame(start + 11ms);
+    clock.EndRender(start + 23ms);
+    clock.EndFrame(start + 31ms, true);
+
+    EXPECT_TRUE(clock.GetIsLastFrameLate());
+    EXPECT_EQ(clock.GetLateFrameCount(), 1u);
+}
@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+#include <Drawing/Window.h>
+#include <Drawing/Visual.h>
+#include <Drawing/Container.h>
+#include <Drawing/Brushes/SolidColorBrush.h>
+
+using namespace xit::Drawing;
+
+namespace
+{
+    class HeadlessWindow : public Window
+    {
+    protected:
+        void OnInitializeComponent() override {}
+    };
+
+    class HeadlessWindowTest : public ::testing::Test
+    {
+    protected:
+        static constexpr int Width = 64;
+        static constexpr int Height = 48;
+
+        HeadlessWindow *window = nullptr;
+        Visual content;
+        SolidColorBrush red{glm::vec4(1.0f, 0.0f, 0.0f, 1.0f)};
+
+        void SetUp() override
+        {
+            Window::SetIsHeadless(true);
+
+            window = new HeadlessWindow();
+            if (!window->Initialize(WindowSettings("HeadlessWindowTest", Width, Height, WindowState::Normal), "HeadlessWindowTest"))
+                GTEST_SKIP() << "no EGL or OSMesa context available";
+
+            content.SetBackground(&red);
+            window->SetContent(&content);
+        }
+
+        void TearDown() override
+        {
+            // the GLFW window is left to glfwTerminate, the visuals must not outlive the window
+            if (window)
+                window->SetContent(nullptr);
+        }
+    };
+}
+
+TEST_F(HeadlessWindowTest, RendersContentIntoReadablePixels)
+{
+    ASSERT_TRUE(window->RenderFrame(FrameClock::Clock::time_point()));
+
+    std::vector<unsigned char> pixels;
+    ASSERT_TRUE(window->ReadPixels(pixels));
+    ASSERT_EQ(pixels.size(), (size_t)(Width * Height * 4));
+
+    const unsigned char *center = &pixels[((size_t)(Height / 2) * Width + Width / 2) * 4];
+    EXPECT_EQ(center[0], 255);
+    EXPECT_EQ(center[1], 0);
+    EXPECT_EQ(center[2], 0);
+    EXPECT_EQ(center[3], 255);
+
+    // the first frame renders the whole window
+    EXPECT_EQ(window->GetLastFrameStatistics().RenderedPixels, (size_t)(Width * Height));
+    EXPECT_TRUE(window->GetLastFrameStatistics().IsPresented);
+}
+
+TEST_F(HeadlessWindowTest, SyntheticClockPacesFrames)
+{
+    FrameClock::Clock::time_point time;
+    ASSERT_TRUE(window->RenderFrame(time));
+
+    // nothing changed
+    EXPECT_FALSE(window->RenderFrame(time + window->GetFrameClock().GetInterval()));
+
+    // a change waits for the next tick of the synthetic clock
+    content.Invalidate();
+    EXPECT_FALSE(window->RenderFrame(time + window->GetFrameClock().GetInterval() / 2));
+    EXPECT_TRUE(window->RenderFrame(time + window->GetFrameClock().GetInterval()));
+    EXPECT_EQ(window->GetFrameClock().GetFrameCount(), 2u);
+    EXPECT_FALSE(window->GetFrameClock().GetIsLastFrameLate());
+}
+
+TEST_F(HeadlessWindowTest, VisualDestroyedWhileQueuedIsNotRead)
+{
+    Container container;
+    Visual *child = new Visual();
+    child->SetBackground(&red);
+    container.AddChild(child);
+    window->SetContent(&container);
+
+    FrameClock::Clock::time_point time;
+    ASSERT_TRUE(window->RenderFrame(time));
+
+    // the queued invalidation keeps the bounds, not the visual
+    child->Invalidate();
+    container.RemoveChild(child);
+    delete child;
+
+    EXPECT_TRUE(window->RenderFrame(time + window->GetFrameClock().GetInterval()));
+
+    window->SetContent(&content);
+}
+
+TEST_F(HeadlessWindowTest, ContinuousRendersEveryTick)
+{
+    window->SetFramePolicy(FramePolicy::Continuous);
+
+    FrameClock::Clock::time_point time;
+    ASSERT_TRUE(window->RenderFrame(time));
+
+    // nothing was invalidated, the frame is rendered anyway
+    ASSERT_TRUE(window->RenderFrame(time + window->GetFrameClock().GetInterval()));
+    EXPECT_EQ(window->GetLastFrameStatistics().RenderedPixels, (size_t)(Width * Height));
+    EXPECT_TRUE(window->GetLastFrameStatistics().IsPresented);
+
+    window->SetFramePolicy(FramePolicy::OnDemand);
+}
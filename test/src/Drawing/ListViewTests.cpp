@@ -0,0 +1,236 @@
+#include <gtest/gtest.h>
+#include <Drawing/ListView.h>
+#include <Drawing/Window.h>
+
+#include <list>
+#include <string>
+
+using namespace xit::Drawing;
+
+class ListViewTest : public ::testing::Test
+{
+protected:
+    static constexpr int ItemHeight = 20;
+
+    std::list<std::string> items;
+
+    void SetUp() override
+    {
+        for (int i = 0; i < 100000; i++)
+        {
+            items.push_back("Item " + std::to_string(i));
+        }
+    }
+};
+
+TEST_F(ListViewTest, VirtualizingListCreatesContainersForViewportOnly)
+{
+    ListView listView;
+    listView.SetIsVirtualizing(true);
+    listView.SetRowSpacing(0);
+    listView.SetItemHeight(ItemHeight);
+    listView.SetItems(&items);
+
+    // nothing is laid out yet, so only the overscan rows (and the two partly visible ones) are realized
+    EXPECT_EQ(listView.GetChildCount(), 2 + 2 * ListView::VirtualizationOverscan);
+
+    // the extent still covers all items, so the scroll bars are correct
+    EXPECT_EQ(listView.GetExtentHeight(), static_cast<int>(items.size()) * ItemHeight);
+}
+
+TEST_F(ListViewTest, VirtualizingListRealizesTheRowsAtTheScrollOffset)
+{
+    const size_t middle = items.size() / 2;
+
+    ListView listView;
+    listView.SetIsVirtualizing(true);
+    listView.SetRowSpacing(0);
+    listView.SetItemHeight(ItemHeight);
+    listView.ScrollToVerticalOffset(static_cast<int>(middle) * ItemHeight);
+    listView.SetItems(&items);
+
+    // the realized rows start VirtualizationOverscan rows above the offset
+    size_t first = middle - ListView::VirtualizationOverscan;
+    EXPECT_EQ(static_cast<ListItem *>(listView.GetChildAt(0))->GetText(), "Item " + std::to_string(first));
+    EXPECT_EQ(static_cast<ListItem *>(listView.GetChildAt(ListView::VirtualizationOverscan))->GetText(), "Item " + std::to_string(middle));
+
+    // a fixed row stands in for the items above, so the first realized row sits at their height
+    std::string rows = listView.GetRows();
+    EXPECT_EQ(rows.substr(0, rows.find(',')), std::to_string(static_cast<int>(first) * ItemHeight));
+
+    EXPECT_EQ(listView.GetExtentHeight(), static_cast<int>(items.size()) * ItemHeight);
+}
+
+TEST_F(ListViewTest, VirtualizingListSelectsItemsWhichAreNotRealized)
+{
+    ListView listView;
+    listView.SetIsVirtualizing(true);
+    listView.SetItems(&items);
+
+    listView.SetSelectedIndex(50000);
+
+    EXPECT_EQ(listView.GetSelectedIndex(), 50000);
+    EXPECT_EQ(listView.GetSelectedValue(), "Item 50000");
+    EXPECT_EQ(listView.GetChildCount(), 2 + 2 * ListView::VirtualizationOverscan);
+}
+
+TEST_F(ListViewTest, VirtualizingListAppliesFilter)
+{
+    std::vector<std::string> filter = {"Item 99999"};
+
+    ListView listView;
+    listView.SetIsVirtualizing(true);
+    listView.SetItems(&items);
+    listView.SetFilter(&filter);
+
+    // the containers are kept for later, but only the one of the matching item is shown
+    EXPECT_EQ(listView.GetChildAt(0)->GetVisibility(), Visibility::Visible);
+    EXPECT_EQ(listView.GetChildAt(1)->GetVisibility(), Visibility::Collapsed);
+}
+
+TEST_F(ListViewTest, NonVirtualizingListHasARowPerItem)
+{
+    std::list<std::string> fewItems(items.begin(), std::next(items.begin(), 1000));
+
+    ListView listView;
+    listView.SetIsVirtualizing(false);
+    listView.SetItems(&fewItems);
+
+    EXPECT_EQ(listView.GetChildCount(), fewItems.size());
+    EXPECT_EQ(listView.GetNumberOfRows(), fewItems.size());
+}
+
+namespace
+{
+    class HeadlessWindow : public Window
+    {
+    protected:
+        void OnInitializeComponent() override {}
+    };
+
+    // rows of a fixed height and a chosen number of loads in flight instead of the ones of the TextureLoader
+    class ImageListView : public ListView
+    {
+    public:
+        static constexpr int ItemHeight = 20;
+
+        size_t PendingLoads = 0;
+
+    protected:
+        ListItem *GetContainerForItemOverride() override
+        {
+            ListItem *listItem = new ListItem();
+            listItem->SetHeight(ItemHeight);
+            return listItem;
+        }
+
+        size_t GetPendingImageLoadCount() const override { return PendingLoads; }
+    };
+
+    class ListViewImageTest : public ::testing::Test
+    {
+    protected:
+        static constexpr int Width = 200;
+        static constexpr int Height = 100;
+        static constexpr size_t ItemCount = 200;
+
+        HeadlessWindow *window = nullptr;
+        // the files do not exist, so requesting an image sets the source without loading a texture
+        std::list<std::string> items;
+        std::list<std::string> otherItems;
+        ImageListView listView;
+
+        void SetUp() override
+        {
+            Window::SetIsHeadless(true);
+
+            window = new HeadlessWindow();
+            if (!window->Initialize(WindowSettings("ListViewImageTest", Width, Height, WindowState::Normal), "ListViewImageTest"))
+                GTEST_SKIP() << "no EGL or OSMesa context available";
+
+            for (size_t i = 0; i < ItemCount; i++)
+                items.push_back("ListViewImageTest/missing" + std::to_string(i) + ".png");
+
+            listView.SetListViewType(ListViewType::ImageText);
+            listView.SetItems(&items);
+        }
+
+        // lays the list out again, which requests the next images
+        void Update()
+        {
+            listView.Invalidate();
+            listView.UpdateLayout(Rectangle(0, 0, Width, Height));
+        }
+
+        const std::string &GetImageSource(size_t index)
+        {
+            return ((ListItem *)listView.GetChildAt(index))->GetImageSource();
+        }
+
+        size_t CountRequested()
+        {
+            size_t count = 0;
+            for (size_t i = 0; i < listView.GetChildCount(); i++)
+            {
+                if (!GetImageSource(i).empty())
+                    count++;
+            }
+            return count;
+        }
+    };
+}
+
+TEST_F(ListViewImageTest, RequestsAtMostMaxImagesPerUpdate)
+{
+    Update();
+    EXPECT_EQ(CountRequested(), ListView::MaxImagesPerUpdate);
+
+    Update();
+    EXPECT_EQ(CountRequested(), 2 * ListView::MaxImagesPerUpdate);
+}
+
+TEST_F(ListViewImageTest, StopsWhileTooManyLoadsArePending)
+{
+    listView.PendingLoads = ListView::MaxPendingImageLoads;
+    Update();
+    EXPECT_EQ(CountRequested(), 0u);
+
+    // the requests continue once the loader caught up
+    listView.PendingLoads = ListView::MaxPendingImageLoads - 1;
+    Update();
+    EXPECT_EQ(CountRequested(), ListView::MaxImagesPerUpdate);
+}
+
+TEST_F(ListViewImageTest, RequestsRowsInTheViewportFirst)
+{
+    // lay out without requesting anything, then show the last rows
+    listView.PendingLoads = ListView::MaxPendingImageLoads;
+    Update();
+    listView.ScrollToBottom();
+
+    listView.PendingLoads = 0;
+    Update();
+
+    // the visible rows are behind the rows the rest of the update goes to
+    EXPECT_EQ(GetImageSource(ItemCount - 1), items.back());
+    EXPECT_EQ(CountRequested(), ListView::MaxImagesPerUpdate);
+    EXPECT_TRUE(GetImageSource(ItemCount / 2).empty());
+}
+
+TEST_F(ListViewImageTest, UpdateListDropsRequestsNotIssuedYet)
+{
+    Update();
+    ASSERT_EQ(GetImageSource(0), items.front());
+    ASSERT_TRUE(GetImageSource(ListView::MaxImagesPerUpdate).empty());
+
+    for (size_t i = 0; i < ItemCount; i++)
+        otherItems.push_back("ListViewImageTest/other" + std::to_string(i) + ".png");
+
+    listView.SetItems(&otherItems);
+    Update();
+
+    // the update went to the rows of the new list, the rows left over from the old one were dropped
+    EXPECT_EQ(GetImageSource(0), otherItems.front());
+    EXPECT_EQ(GetImageSource(ListView::MaxImagesPerUpdate - 1), *std::next(otherItems.begin(), ListView::MaxImagesPerUpdate - 1));
+    EXPECT_TRUE(GetImageSource(ListView::MaxImagesPerUpdate).empty());
+}
@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+#include <Drawing/VisualBase/RenderCommandList.h>
+#include <Drawing/Visual.h>
+
+using namespace xit::Drawing;
+using namespace xit::Drawing::VisualBase;
+
+TEST(RenderCommandListTest, RecordingIsActiveBetweenBeginAndEnd)
+{
+    RenderCommandList list;
+    EXPECT_FALSE(list.GetIsValid());
+
+    list.BeginRecording();
+    EXPECT_EQ(RenderCommandList::GetRecording(), &list);
+
+    list.EndRecording();
+    EXPECT_EQ(RenderCommandList::GetRecording(), nullptr);
+    EXPECT_TRUE(list.GetIsValid());
+
+    list.Invalidate();
+    EXPECT_FALSE(list.GetIsValid());
+}
+
+TEST(RenderCommandListTest, ConsecutiveQuadsShareOneCommand)
+{
+    QuadInstance quad{};
+
+    RenderCommandList list;
+    list.BeginRecording();
+    list.AddQuad(quad, nullptr);
+    list.AddQuad(quad, nullptr);
+    list.AddQuad(quad, nullptr);
+    list.EndRecording();
+
+    ASSERT_EQ(list.GetCommands().size(), 1u);
+    EXPECT_EQ(list.GetCommands()[0].Type, RenderCommandType::Quads);
+    EXPECT_EQ(list.GetCommands()[0].Count, 3);
+    EXPECT_EQ(list.GetQuads().size(), 3u);
+    EXPECT_EQ(list.GetQuadTextures().size(), 3u);
+}
+
+TEST(RenderCommandListTest, GlyphsOfAnotherAtlasStartANewCommand)
+{
+    RenderCommandList list;
+    list.BeginRecording();
+    list.AddGlyph(1);
+    list.AddGlyph(1);
+    list.AddGlyph(2);
+    list.EndRecording();
+
+    ASSERT_EQ(list.GetCommands().size(), 2u);
+    EXPECT_EQ(list.GetCommands()[0].Count, 2);
+    EXPECT_EQ(list.GetCommands()[1].Texture, 2u);
+    EXPECT_EQ(list.GetCommands()[1].First, 2u);
+}
+
+TEST(RenderCommandListTest, EmptyCullAndClipAreRemoved)
+{
+    RenderCommandList list;
+    list.BeginRecording();
+    size_t cull = list.BeginCull(Rectangle(0, 0, 10, 10));
+    list.PushClip(Rectangle(0, 0, 10, 10));
+    list.PopClip();
+    list.EndCull(cull);
+    list.EndRecording();
+
+    EXPECT_TRUE(list.GetCommands().empty());
+}
+
+TEST(RenderCommandListTest, CullCountsTheCommandsOfTheVisual)
+{
+    QuadInstance quad{};
+
+    RenderCommandList list;
+    list.BeginRecording();
+    size_t cull = list.BeginCull(Rectangle(0, 0, 10, 10));
+    list.PushClip(Rectangle(0, 0, 10, 10));
+    list.AddQuad(quad, nullptr);
+    list.PopClip();
+    list.EndCull(cull);
+    list.EndRecording();
+
+    const std::vector<RenderCommand> &commands = list.GetCommands();
+    ASSERT_EQ(commands.size(), 4u);
+    EXPECT_EQ(commands[0].Type, RenderCommandType::Cull);
+    EXPECT_EQ(commands[0].Count, 3);
+    EXPECT_EQ(commands[1].Type, RenderCommandType::PushClip);
+    EXPECT_EQ(commands[1].Count, 1);
+    EXPECT_EQ(commands[3].Type, RenderCommandType::PopClip);
+}
+
+TEST(RenderCommandListTest, QuadsAfterACullAreNotMergedIntoIt)
+{
+    QuadInstance quad{};
+
+    RenderCommandList list;
+    list.BeginRecording();
+    size_t cull = list.BeginCull(Rectangle(0, 0, 10, 10));
+    list.AddQuad(quad, nullptr);
+    list.EndCull(cull);
+
+    // drawn by the parent after the child, must not be culled with the child
+    list.AddQuad(quad, nullptr);
+    list.EndRecording();
+
+    const std::vector<RenderCommand> &commands = list.GetCommands();
+    ASSERT_EQ(commands.size(), 3u);
+    EXPECT_EQ(commands[0].Count, 1);
+    EXPECT_EQ(commands[1].Count, 1);
+    EXPECT_EQ(commands[2].Type, RenderCommandType::Quads);
+    EXPECT_EQ(commands[2].Count, 1);
+}
+
+TEST(RenderCommandListTest, VisualsAreRemovedBySwappingWithTheLast)
+{
+    Visual first, second, third;
+
+    RenderCommandList list;
+    list.AddVisual(&first);
+    list.AddVisual(&second);
+    list.AddVisual(&third);
+
+    // a visual is only remembered once
+    list.AddVisual(&second);
+    ASSERT_EQ(list.GetVisuals().size(), 3u);
+
+    list.RemoveVisual(&first);
+    ASSERT_EQ(list.GetVisuals().size(), 2u);
+    EXPECT_EQ(list.GetVisuals()[0], &third);
+    EXPECT_EQ(list.GetVisuals()[1], &second);
+
+    // removing a visual which is not in the list does nothing
+    list.RemoveVisual(&first);
+    EXPECT_EQ(list.GetVisuals().size(), 2u);
+
+    list.RemoveVisual(&second);
+    list.RemoveVisual(&third);
+    EXPECT_TRUE(list.GetVisuals().empty());
+}
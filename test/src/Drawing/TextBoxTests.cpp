@@ -280,3 +280,50 @@ TEST_F(TextBoxTest, ComprehensivePasswordTest)
 
     // std::cout << "=== COMPREHENSIVE TEST COMPLETE ===" << std::endl;
 }
+
+// Test that edits patch the visible text
+TEST_F(TextBoxTest, InsertAndRemovePatchTheVisibleText)
+{
+    textBox->SetText("Hello");
+    textBox->Insert(5, " World");
+    EXPECT_EQ(textBox->GetText(), "Hello World");
+
+    textBox->Insert(0, '>');
+    textBox->Remove(1, 6);
+    EXPECT_EQ(textBox->GetText(), ">World");
+
+    // removing past the end stops at the end
+    textBox->Remove(3, 100);
+    EXPECT_EQ(textBox->GetText(), ">Wo");
+
+    textBox->SetIsPassword(true);
+    textBox->Insert(3, "rd");
+    textBox->Remove(0, 1);
+    EXPECT_EQ(textBox->GetText(), "****");
+    EXPECT_EQ(textBox->GetPassword(), "Word");
+
+    textBox->Erase();
+    EXPECT_TRUE(textBox->GetPassword().empty());
+}
+
+// Test typing after the text was erased, e.g. after a failed login
+TEST_F(TextBoxTest, TypingAfterEraseStartsEmpty)
+{
+    textBox->SetIsPassword(true);
+    textBox->SetText("secret");
+    textBox->Erase();
+
+    EXPECT_TRUE(textBox->GetText().empty());
+    EXPECT_TRUE(textBox->GetPassword().empty());
+
+    textBox->Insert(0, 'n');
+    textBox->Insert(1, "ew");
+    EXPECT_EQ(textBox->GetText(), "***");
+    EXPECT_EQ(textBox->GetPassword(), "new");
+
+    textBox->SetIsPassword(false);
+    textBox->Erase();
+    textBox->Insert(0, "plain");
+    EXPECT_EQ(textBox->GetText(), "plain");
+    EXPECT_EQ(textBox->GetPassword(), "plain");
+}
@@ -0,0 +1,166 @@
+#include <gtest/gtest.h>
+#include <Drawing/TextBuffer.h>
+
+#include <algorithm>
+#include <random>
+
+using namespace xit::Drawing;
+
+namespace
+{
+    size_t LineStart(const std::string &text, size_t line)
+    {
+        size_t index = 0;
+
+        for (size_t i = 0; i < line; i++)
+        {
+            index = text.find('\n', index);
+            if (index == std::string::npos)
+                return text.length();
+            index++;
+        }
+
+        return index;
+    }
+
+    void ExpectEqual(const TextBuffer &buffer, const std::string &text)
+    {
+        ASSERT_EQ(buffer.GetLength(), text.length());
+        ASSERT_EQ(buffer.ToString(), text);
+
+        size_t lines = (size_t)std::count(text.begin(), text.end(), '\n') + 1;
+        ASSERT_EQ(buffer.GetLineCount(), lines);
+
+        for (size_t line = 0; line <= lines; line++)
+            ASSERT_EQ(buffer.GetLineStart(line), LineStart(text, line)) << "line " << line;
+
+        for (size_t i = 0; i < text.length(); i++)
+        {
+            ASSERT_EQ(buffer.At(i), text[i]) << "index " << i;
+            ASSERT_EQ(buffer.GetLine(i), (size_t)std::count(text.begin(), text.begin() + (std::ptrdiff_t)i, '\n')) << "index " << i;
+        }
+    }
+}
+
+TEST(TextBufferTest, InsertAndRemove)
+{
+    TextBuffer buffer;
+    EXPECT_TRUE(buffer.IsEmpty());
+    EXPECT_EQ(buffer.GetLineCount(), 1u);
+
+    buffer.Insert(0, "Hello World");
+    buffer.Insert(5, ",");
+    buffer.Insert(100, "!");
+    ExpectEqual(buffer, "Hello, World!");
+
+    buffer.Remove(5, 1);
+    buffer.Remove(11, 100);
+    ExpectEqual(buffer, "Hello World");
+
+    EXPECT_EQ(buffer.GetText(6, 5), "World");
+    EXPECT_EQ(buffer.GetText(6, 100), "World");
+    EXPECT_EQ(buffer.GetText(100, 5), "");
+}
+
+TEST(TextBufferTest, TypingExtendsTheLastPiece)
+{
+    TextBuffer buffer;
+
+    std::string text;
+    for (char c : std::string("typed\nline by line\n"))
+    {
+        buffer.Insert(buffer.GetLength(), std::string(1, c));
+        text += c;
+    }
+
+    ExpectEqual(buffer, text);
+}
+
+TEST(TextBufferTest, LinesAreIndexed)
+{
+    TextBuffer buffer;
+    buffer.Insert(0, "first\nsecond\n\nfourth");
+    buffer.Insert(6, "new\n");
+
+    ExpectEqual(buffer, "first\nnew\nsecond\n\nfourth");
+    EXPECT_EQ(buffer.GetLineCount(), 5u);
+    EXPECT_EQ(buffer.GetLineStart(4), 18u);
+    EXPECT_EQ(buffer.GetLineStart(5), buffer.GetLength());
+    EXPECT_EQ(buffer.Count('\n'), 4u);
+}
+
+TEST(TextBufferTest, CountsCharacters)
+{
+    TextBuffer buffer;
+    buffer.Insert(0, "a;b;c");
+
+    EXPECT_EQ(buffer.Count(';'), 2u);
+    EXPECT_TRUE(buffer.ContainsAny("x;"));
+
+    buffer.Remove(1, 3);
+    EXPECT_EQ(buffer.Count(';'), 0u);
+    EXPECT_FALSE(buffer.ContainsAny("x;"));
+}
+
+TEST(TextBufferTest, EraseRemovesEverything)
+{
+    TextBuffer buffer;
+    buffer.Insert(0, "secret\n");
+    buffer.Remove(0, 3);
+    buffer.Erase();
+
+    ExpectEqual(buffer, "");
+    EXPECT_EQ(buffer.Count('s'), 0u);
+
+    buffer.Insert(0, "again");
+    ExpectEqual(buffer, "again");
+}
+
+TEST(TextBufferTest, EqualsComparesThePieces)
+{
+    TextBuffer buffer;
+    buffer.Insert(0, "held");
+    buffer.Insert(2, "llo wor");
+
+    EXPECT_TRUE(buffer.Equals("hello world"));
+    EXPECT_FALSE(buffer.Equals("hello worle"));
+    EXPECT_FALSE(buffer.Equals("hello"));
+    EXPECT_TRUE(TextBuffer().Equals(""));
+}
+
+TEST(TextBufferTest, RandomEditsMatchAString)
+{
+    std::mt19937 random(42);
+    TextBuffer buffer;
+    std::string text;
+
+    const std::string alphabet = "ab\ncd\n";
+
+    for (int edit = 0; edit < 2000; edit++)
+    {
+        size_t index = random() % (text.length() + 1);
+
+        if (random() % 3 != 0 || text.empty())
+        {
+            std::string inserted;
+            size_t length = 1 + random() % 8;
+            for (size_t i = 0; i < length; i++)
+                inserted += alphabet[random() % alphabet.length()];
+
+            buffer.Insert(index, inserted);
+            text.insert(index, inserted);
+        }
+        else
+        {
+            size_t count = 1 + random() % 10;
+            buffer.Remove(index, count);
+            if (index < text.length())
+                text.erase(index, count);
+        }
+
+        if (edit % 100 == 0)
+            ExpectEqual(buffer, text);
+    }
+
+    ExpectEqual(buffer, text);
+}
@@ -197,3 +197,25 @@ TEST(VisualTest, MeasureHeight_ZeroMarginPaddingBorder)
     // GetActualHeight() should still be 0 since Update() wasn't called
     ASSERT_EQ(visual.GetActualHeight(), 0);
 }
+
+TEST(VisualTest, IsOutsideClipBounds)
+{
+    Visual visual;
+    visual.UpdateLayout(Rectangle(100, 100, 50, 20));
+
+    // nothing is skipped without clip bounds
+    EXPECT_FALSE(visual.IsOutsideClipBounds());
+
+    Visual::SetClipBounds(Rectangle(0, 0, 100, 100));
+    EXPECT_TRUE(visual.IsOutsideClipBounds());
+
+    Visual::SetClipBounds(Rectangle(140, 110, 100, 100));
+    EXPECT_FALSE(visual.IsOutsideClipBounds());
+
+    // rotated visuals may reach out of their bounds
+    Visual::SetClipBounds(Rectangle(0, 0, 100, 100));
+    visual.SetRotation(glm::vec3(0.0f, 0.0f, 45.0f));
+    EXPECT_FALSE(visual.IsOutsideClipBounds());
+
+    Visual::ResetClipBounds();
+}
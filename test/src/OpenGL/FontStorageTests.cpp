@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+#include <type_traits>
+#include <OpenGL/Text/FontStorage.h>
+#include <Drawing/UIDefaults.h>
+
+using namespace xit::OpenGL;
+
+// a missing font file fails before anything needs an OpenGL context
+static const std::string MissingFont = "FontStorageTests/missing.ttf";
+
+TEST(FontStorageTest, ResolvePointsAtTheSameCharacterList)
+{
+    FontHandle first = FontStorage::Resolve(MissingFont, 12);
+    FontHandle second = FontStorage::Resolve(MissingFont, 12);
+    FontHandle otherSize = FontStorage::Resolve(MissingFont, 14);
+
+    ASSERT_TRUE(first.IsResolved());
+    EXPECT_EQ(&first.GetCharacterList(), &second.GetCharacterList());
+    EXPECT_NE(&first.GetCharacterList(), &otherSize.GetCharacterList());
+    EXPECT_EQ(&first.GetCharacterList(), &FontStorage::FindOrCreate(MissingFont, 12));
+}
+
+TEST(FontStorageTest, FailedFontIsNotLoadedAgain)
+{
+    FontHandle font = FontStorage::Resolve(MissingFont, 16);
+
+    EXPECT_FALSE(font.IsInitialized());
+    EXPECT_EQ(font.GetCharacterList().GetLoadState(), FontLoadState::Failed);
+
+    // the state is kept, resolving again does not retry the font file
+    EXPECT_EQ(FontStorage::Resolve(MissingFont, 16).GetCharacterList().GetLoadState(), FontLoadState::Failed);
+
+    Size size(10, 10);
+    font.Measure("text", size);
+    EXPECT_EQ(size.GetWidth(), 0);
+    EXPECT_EQ(size.GetHeight(), 0);
+}
+
+TEST(FontStorageTest, ClearInvalidatesHandles)
+{
+    FontHandle font = FontStorage::Resolve(MissingFont, 18);
+    EXPECT_TRUE(FontStorage::IsCurrent(font));
+    EXPECT_FALSE(FontStorage::IsCurrent(FontHandle()));
+
+    FontStorage::Clear();
+    EXPECT_FALSE(FontStorage::IsCurrent(font));
+    EXPECT_TRUE(FontStorage::IsCurrent(FontStorage::Resolve(MissingFont, 18)));
+}
+
+TEST(FontFaceTest, MissingFileIsNotOpened)
+{
+    FontFace face;
+
+    EXPECT_FALSE(face.Open(nullptr, MissingFont));
+    EXPECT_FALSE(face.IsOpen());
+    EXPECT_EQ(face.CreateSize(12), nullptr);
+}
+
+TEST(FontFaceTest, SizesShareTheFace)
+{
+    FT_Library library;
+    ASSERT_EQ(FT_Init_FreeType(&library), FT_Err_Ok);
+
+    {
+        FontFace face;
+        if (!face.Open(library, UIDefaults::DefaultFont))
+        {
+            FT_Done_FreeType(library);
+            GTEST_SKIP() << "the default font is not in the working directory";
+        }
+
+        FT_Size small = face.CreateSize(12);
+        FT_Size large = face.CreateSize(24);
+
+        ASSERT_NE(small, nullptr);
+        ASSERT_NE(large, nullptr);
+        EXPECT_EQ(small->face, face.GetFace());
+        EXPECT_EQ(large->face, face.GetFace());
+        EXPECT_LT(small->metrics.y_ppem, large->metrics.y_ppem);
+    }
+
+    FT_Done_FreeType(library);
+}
+
+TEST(CharacterListTest, LookupsDoNotInsertGlyphs)
+{
+    FontHandle font = FontStorage::Resolve(MissingFont, 20);
+    const CharacterList &characters = font.GetCharacterList();
+
+    for (char c : std::string("a\xe9\n"))
+    {
+        EXPECT_EQ(characters.Find(c), nullptr);
+        EXPECT_EQ(characters.GetAdvance(c), 0);
+        EXPECT_TRUE(characters.NeedsLoad(c));
+        EXPECT_EQ(characters.GetGlyphState(c), GlyphState::NotLoaded);
+    }
+}
+
+TEST(CharacterListTest, OwnsItsAtlas)
+{
+    // a copy would delete the texture of the original when it is destroyed
+    static_assert(!std::is_copy_constructible_v<GlyphAtlas> && !std::is_copy_assignable_v<GlyphAtlas>);
+    static_assert(!std::is_copy_constructible_v<CharacterList> && !std::is_copy_assignable_v<CharacterList>);
+
+    // an atlas without glyphs has no texture, destroying it does not need a context
+    GlyphAtlas atlas;
+    EXPECT_EQ(atlas.GetTextureId(), 0u);
+}
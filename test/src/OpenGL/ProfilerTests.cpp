@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+#include <OpenGL/Profiler.h>
+
+#include <sstream>
+#include <thread>
+
+using namespace xit::OpenGL;
+
+TEST(ProfilerTest, CountersBelongToTheFrame)
+{
+    Profiler::Clear();
+
+    Profiler::BeginFrame();
+    Profiler::Count(ProfileCounter::DrawCalls);
+    Profiler::Count(ProfileCounter::DrawCalls);
+    Profiler::Count(ProfileCounter::TextureUploadBytes, 1024);
+    Profiler::EndFrame();
+
+    ProfileFrame frame = Profiler::GetLastFrame();
+    EXPECT_EQ(Profiler::GetFrameCount(), 1u);
+    EXPECT_EQ(frame.Get(ProfileCounter::DrawCalls), 2u);
+    EXPECT_EQ(frame.Get(ProfileCounter::TextureUploadBytes), 1024u);
+
+    // the next frame starts at zero
+    Profiler::BeginFrame();
+    Profiler::EndFrame();
+    EXPECT_EQ(Profiler::GetLastFrame().Get(ProfileCounter::DrawCalls), 0u);
+}
+
+TEST(ProfilerTest, ZonesAreOnlyRecordedWhileEnabled)
+{
+    Profiler::Clear();
+
+    {
+        PROFILE_ZONE("Disabled");
+    }
+
+    Profiler::SetIsEnabled(true);
+    {
+        PROFILE_ZONE("Enabled");
+    }
+    Profiler::SetIsEnabled(false);
+
+    std::ostringstream trace;
+    Profiler::WriteChromeTrace(trace);
+
+    EXPECT_EQ(trace.str().find("\"Disabled\""), std::string::npos);
+    EXPECT_NE(trace.str().find("{\"name\":\"Enabled\",\"ph\":\"X\""), std::string::npos);
+}
+
+TEST(ProfilerTest, ZonesOfOtherThreadsAreKept)
+{
+    Profiler::Clear();
+    Profiler::SetIsEnabled(true);
+
+    std::thread worker([]
+                       { PROFILE_ZONE("Worker"); });
+    worker.join();
+
+    Profiler::SetIsEnabled(false);
+
+    std::ostringstream trace;
+    Profiler::WriteChromeTrace(trace);
+
+    EXPECT_NE(trace.str().find("\"Worker\""), std::string::npos);
+}
+
+TEST(ProfilerTest, TraceHoldsTheFrameCounters)
+{
+    Profiler::Clear();
+
+    Profiler::BeginFrame();
+    Profiler::Count(ProfileCounter::GlyphsDrawn, 42);
+    Profiler::EndFrame();
+
+    std::ostringstream trace;
+    Profiler::WriteChromeTrace(trace);
+
+    const std::string &json = trace.str();
+    EXPECT_EQ(json.rfind("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", 0), 0u);
+    EXPECT_NE(json.find("\"ph\":\"C\""), std::string::npos);
+    EXPECT_NE(json.find("\"GlyphsDrawn\":42"), std::string::npos);
+    EXPECT_EQ(json.back(), '}');
+}
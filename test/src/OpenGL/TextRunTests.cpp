@@ -0,0 +1,160 @@
+#include <gtest/gtest.h>
+#include <OpenGL/Text/TextRun.h>
+
+using namespace xit::OpenGL;
+
+namespace
+{
+    // every character is 10 wide, 'i' is 4
+    std::array<int, CharacterList::GlyphCount> CreateAdvances()
+    {
+        std::array<int, CharacterList::GlyphCount> advances;
+        advances.fill(10);
+        advances['i'] = 4;
+        advances['\n'] = 0;
+        return advances;
+    }
+}
+
+TEST(TextRunTest, CaretPositionsArePrefixSums)
+{
+    TextRun run;
+    run.Build("aib", CreateAdvances());
+
+    EXPECT_EQ(run.GetLength(), 3u);
+    EXPECT_EQ(run.GetX(0), 0);
+    EXPECT_EQ(run.GetX(1), 10);
+    EXPECT_EQ(run.GetX(2), 14);
+    EXPECT_EQ(run.GetX(3), 24);
+    EXPECT_EQ(run.GetX(100), 24);
+    EXPECT_EQ(run.GetWidth(), 24);
+    EXPECT_EQ(run.GetWidth(1, 2), 14);
+}
+
+TEST(TextRunTest, HitTestFindsTheClosestCaretPosition)
+{
+    TextRun run;
+    run.Build("aib", CreateAdvances());
+
+    EXPECT_EQ(run.GetIndex(-5), 0u);
+    EXPECT_EQ(run.GetIndex(0), 0u);
+    EXPECT_EQ(run.GetIndex(4), 0u);
+    EXPECT_EQ(run.GetIndex(6), 1u);
+    EXPECT_EQ(run.GetIndex(12), 1u); // a tie goes to the lower index
+    EXPECT_EQ(run.GetIndex(13), 2u);
+    EXPECT_EQ(run.GetIndex(30), 3u);
+}
+
+TEST(TextRunTest, LinesStartAtZero)
+{
+    TextRun run;
+    run.Build("ab\nici\n", CreateAdvances());
+
+    EXPECT_EQ(run.GetLineCount(), 3u);
+    EXPECT_EQ(run.GetLine(1), 0u);
+    EXPECT_EQ(run.GetLine(2), 0u);
+    EXPECT_EQ(run.GetLine(3), 1u);
+    EXPECT_EQ(run.GetLine(7), 2u);
+
+    EXPECT_EQ(run.GetX(2), 20);
+    EXPECT_EQ(run.GetX(3), 0);
+    EXPECT_EQ(run.GetX(6), 18);
+    EXPECT_EQ(run.GetX(7), 0);
+    EXPECT_EQ(run.GetWidth(), 20);
+
+    // the widest line of the range
+    EXPECT_EQ(run.GetWidth(1, 4), 14);
+
+    EXPECT_EQ(run.GetIndex(100, 0), 2u);
+    EXPECT_EQ(run.GetIndex(5, 1), 4u);
+    EXPECT_EQ(run.GetIndex(100, 1), 6u);
+    EXPECT_EQ(run.GetIndex(100, 2), 7u);
+}
+
+TEST(TextRunTest, InvalidateRebuildsWithTheSameFont)
+{
+    FontHandle font;
+    TextRun run;
+    EXPECT_FALSE(run.IsValid(font));
+
+    run.Update(font, "text");
+    EXPECT_TRUE(run.IsValid(font));
+    EXPECT_EQ(run.GetLength(), 4u);
+
+    // an unchanged run is not built again
+    run.Update(font, "longer text");
+    EXPECT_EQ(run.GetLength(), 4u);
+
+    run.Invalidate();
+    run.Update(font, "longer text");
+    EXPECT_EQ(run.GetLength(), 11u);
+}
+
+TEST(TextRunTest, WidthFollowsTheWidestLine)
+{
+    std::array<int, CharacterList::GlyphCount> advances = CreateAdvances();
+
+    // two lines of the same width, shrinking one keeps the width of the other
+    std::string text = "ab\nab\na";
+    TextRun run;
+    run.Build(text, advances);
+    EXPECT_EQ(run.GetWidth(), 20);
+
+    text.erase(0, 1);
+    run.Edit(text, 0, 1, 0, advances);
+    EXPECT_EQ(run.GetWidth(), 20);
+
+    // shrinking the last widest line finds the widest of the others
+    text.erase(2, 1);
+    run.Edit(text, 2, 1, 0, advances);
+    EXPECT_EQ(text, "b\nb\na");
+    EXPECT_EQ(run.GetWidth(), 10);
+
+    // a longer line becomes the widest
+    text.insert(4, "aaa");
+    run.Edit(text, 4, 0, 3, advances);
+    EXPECT_EQ(run.GetWidth(), 40);
+}
+
+TEST(TextRunTest, EditMatchesARebuild)
+{
+    std::array<int, CharacterList::GlyphCount> advances = CreateAdvances();
+    const char alphabet[] = "ai\nb";
+
+    std::string text = "ab\nici\n";
+    TextRun run;
+    run.Build(text, advances);
+
+    unsigned int seed = 7;
+    auto next = [&seed]()
+    {
+        seed = seed * 1103515245u + 12345u;
+        return (seed >> 16) & 0x7fff;
+    };
+
+    for (int edit = 0; edit < 500; edit++)
+    {
+        size_t index = next() % (text.length() + 1);
+        size_t removedLength = std::min((size_t)(next() % 4), text.length() - index);
+
+        std::string inserted;
+        for (size_t i = next() % 4; i > 0; i--)
+            inserted += alphabet[next() % 4];
+
+        text.replace(index, removedLength, inserted);
+        run.Edit(text, index, removedLength, inserted.length(), advances);
+
+        TextRun expected;
+        expected.Build(text, advances);
+
+        ASSERT_EQ(run.GetLength(), expected.GetLength());
+        ASSERT_EQ(run.GetLineCount(), expected.GetLineCount());
+        ASSERT_EQ(run.GetWidth(), expected.GetWidth());
+
+        for (size_t i = 0; i <= text.length(); i++)
+        {
+            ASSERT_EQ(run.GetX(i), expected.GetX(i)) << "edit " << edit << ", index " << i;
+            ASSERT_EQ(run.GetLine(i), expected.GetLine(i)) << "edit " << edit << ", index " << i;
+        }
+    }
+}
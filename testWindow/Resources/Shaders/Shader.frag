@@ -1,54 +1,60 @@
 #version 330 core
 
 // Uniform variables (input from the application)
-uniform vec4 iCornerRadius;     // Radius of the corners (x: top-left, y: top-right, z: bottom-right, w: bottom-left)
-uniform vec4 iBorderThickness;  // Thickness of the border (x: left, y: bottom, z: right, w: top)
-uniform vec2 iLocation;         // Location of the rectangle
-uniform vec3 iRotation;         // Rotation of the rectangle
-uniform vec2 iSize;             // Size of the rectangle
 uniform vec2 iResolution;       // Resolution of the screen
 uniform float iTime;            // Time in seconds
-uniform float iIsTexture;       // Flag to indicate if a texture is used (0: no, 1: yes)
-uniform float iTextureChannels; // Number of channels in the texture
+uniform vec2 iOrigin;           // Position of the render target in the window, see Graphics::SetTargetOrigin
 
-uniform sampler2D text;         // Texture sampler
+uniform sampler2D textures[8];  // Texture samplers, slot n is bound to texture unit n
 
-// Input from the vertex shader
-in vec4 BackgroundColor;        // Background color of the rectangle
-in vec4 BorderColor;            // Border color of the rectangle
+// Input from the vertex shader (per instance, see QuadInstance)
 in vec2 TexCoord;               // Texture coordinates
+flat in vec4 BackgroundColor;   // Background color of the rectangle
+flat in vec4 BorderColor;       // Border color of the rectangle
+flat in vec4 CornerRadius;      // Radius of the corners (x: top-left, y: top-right, z: bottom-right, w: bottom-left)
+flat in vec4 BorderThickness;   // Thickness of the border (x: left, y: bottom, z: right, w: top)
+flat in vec2 Location;          // Location of the rectangle
+flat in vec2 Size;              // Size of the rectangle
+flat in int TextureSlot;        // Texture slot (-1: no texture)
+flat in float TextureChannels;  // Number of channels in the texture
+flat in float TexturePremultiplied; // 1 if the colors of the texture are multiplied with their alpha (render layers)
 
 // Output color
 out vec4 fragColor;             // Final fragment color
 
 // Function declarations
 vec4 borderedRectangle(void);   // Function to draw a bordered rectangle
+vec4 sampleTexture(vec2 uv);    // Function to sample the texture of the rectangle
 
 // Global variables
 vec2 halfSize;                  // Half of the size of the rectangle
 vec2 center;                    // Center of the rectangle
 float x, y;                     // Fragment coordinates relative to the rectangle
+vec2 fragCoord;                 // Fragment coordinates in the window
 
 void main(void)
 {
-    vec2 st = gl_FragCoord.xy / iResolution; // Normalized screen coordinates
+    // a render layer covers only a part of the window
+    fragCoord = gl_FragCoord.xy + iOrigin;
+
+    vec2 st = fragCoord / iResolution; // Normalized screen coordinates
 
     // Calculate half the size of the rectangle
-    halfSize = (iSize * 0.5);
+    halfSize = (Size * 0.5);
 
     // Calculate the center of the rectangle
-    center = halfSize + iLocation;
+    center = halfSize + Location;
 
     // Adjust the center for OpenGL's coordinate system (flip the y-axis)
     center = vec2(center.x, iResolution.y - center.y);
 
     // Calculate the fragment's x-coordinate relative to the rectangle's location
-    x = gl_FragCoord.x - iLocation.x;
+    x = fragCoord.x - Location.x;
 
     // Calculate the fragment's y-coordinate relative to the rectangle's location, adjusted for OpenGL's coordinate system
-    y = gl_FragCoord.y - (iResolution.y - iLocation.y - iSize.y);
+    y = fragCoord.y - (iResolution.y - Location.y - Size.y);
 
-    if (iIsTexture == 0)
+    if (TextureSlot < 0)
     {
         // Rotate the fragment coordinates around the center of the rectangle
         // float angle = iRotation.x;
@@ -82,14 +88,37 @@ void main(void)
         // return;
 
         // Use texture
-        if (iTextureChannels == 1)
+        if (TextureChannels == 1)
         {
-            fragColor = vec4(texture(text, TexCoord).r); // Use red channel for single-channel textures
+            fragColor = vec4(sampleTexture(TexCoord).r); // Use red channel for single-channel textures
         }
         else
         {
-            fragColor = texture(text, TexCoord);        // Use the full texture
+            fragColor = sampleTexture(TexCoord);        // Use the full texture
         }
+
+        // the blending multiplies with alpha again
+        if (TexturePremultiplied > 0.0 && fragColor.a > 0.0)
+        {
+            fragColor.rgb /= fragColor.a;
+        }
+    }
+}
+
+// Function to sample the texture of the current slot
+// GLSL 3.30 only allows constant indices into sampler arrays
+vec4 sampleTexture(vec2 uv)
+{
+    switch (TextureSlot)
+    {
+        case 0: return texture(textures[0], uv);
+        case 1: return texture(textures[1], uv);
+        case 2: return texture(textures[2], uv);
+        case 3: return texture(textures[3], uv);
+        case 4: return texture(textures[4], uv);
+        case 5: return texture(textures[5], uv);
+        case 6: return texture(textures[6], uv);
+        default: return texture(textures[7], uv);
     }
 }
 
@@ -104,21 +133,21 @@ float getRadius(float x, float y)
 {
     // x, y, z, w = topLeft, bottomLeft, topRight, bottomRight
     return x < halfSize.x
-            ? (y > halfSize.y ? iCornerRadius.x : iCornerRadius.w)
-            : (y > halfSize.y ? iCornerRadius.y : iCornerRadius.z);
+            ? (y > halfSize.y ? CornerRadius.x : CornerRadius.w)
+            : (y > halfSize.y ? CornerRadius.y : CornerRadius.z);
 } 
 
 // Function to get the border thickness for a specific side
 float getBorderThickness(float x, float y, float radius)
 {
-    return x < max(radius, iBorderThickness.x)
-        ? iBorderThickness.x
-        : ((iSize.x - x) < max(radius, iBorderThickness.z)
-            ? iBorderThickness.z
-            : (y<max(radius, iBorderThickness.w)
-                ? iBorderThickness.w
-                : ((iSize.y - y) < max(radius, iBorderThickness.y)
-                    ? iBorderThickness.y
+    return x < max(radius, BorderThickness.x)
+        ? BorderThickness.x
+        : ((Size.x - x) < max(radius, BorderThickness.z)
+            ? BorderThickness.z
+            : (y<max(radius, BorderThickness.w)
+                ? BorderThickness.w
+                : ((Size.y - y) < max(radius, BorderThickness.y)
+                    ? BorderThickness.y
                     : 0.0)));
 }
     
@@ -129,7 +158,7 @@ vec4 borderedRectangle(void)
     vec4 toColor;
 
     float radius = getRadius(x, y);
-    float distance = roundedBoxSDF(gl_FragCoord.xy - center, halfSize, radius);
+    float distance = roundedBoxSDF(fragCoord - center, halfSize, radius);
     float borderThickness = getBorderThickness(x, y, radius);
 
     float minBlend = 0.0, maxBlend = 1.0;
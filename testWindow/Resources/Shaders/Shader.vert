@@ -3,23 +3,44 @@
 uniform mat4 projection;
 //uniform mat4 model;
 
-uniform vec4 iCornerRadius;
-uniform vec4 iBorderThickness;
+// Per vertex: corner of the unit quad (0..1)
+layout(location = 0) in vec2 iCorner;
 
-layout(location = 0) in vec3 iPosition;
-layout(location = 1) in vec2 iTexCoord;
-layout(location = 2) in vec4 iBackgroundColor;
-layout(location = 3) in vec4 iBorderColor;
+// Per instance (see QuadInstance)
+layout(location = 1) in vec4 iRect;            // renderX, renderY, width, height (bottom left origin)
+layout(location = 2) in vec4 iLocation;        // left, top (top left origin), z, rotation
+layout(location = 3) in vec4 iCornerRadius;    // top left, top right, bottom right, bottom left
+layout(location = 4) in vec4 iBorderThickness; // left, top, right, bottom
+layout(location = 5) in vec4 iBackgroundColor;
+layout(location = 6) in vec4 iBorderColor;
+layout(location = 7) in vec4 iTexture;         // texture slot (-1 = none), texture channels, premultiplied alpha (1 = yes)
+layout(location = 8) in vec4 iTextureRect;     // texture coordinates of the image inside the texture (left, top, right, bottom)
 
-out vec4 BackgroundColor;
-out vec4 BorderColor;
 out vec2 TexCoord;
+flat out vec4 BackgroundColor;
+flat out vec4 BorderColor;
+flat out vec4 CornerRadius;
+flat out vec4 BorderThickness;
+flat out vec2 Location;
+flat out vec2 Size;
+flat out int TextureSlot;
+flat out float TextureChannels;
+flat out float TexturePremultiplied;
 
 void main(void)
 {
     BackgroundColor = iBackgroundColor;
     BorderColor = iBorderColor;
-    TexCoord = iTexCoord;
+    CornerRadius = iCornerRadius;
+    BorderThickness = iBorderThickness;
+    Location = iLocation.xy;
+    Size = iRect.zw;
+    TextureSlot = int(iTexture.x);
+    TextureChannels = iTexture.y;
+    TexturePremultiplied = iTexture.z;
 
-    gl_Position = projection * vec4(iPosition, 1.0);
-}
\ No newline at end of file
+    // texture v runs from the top (0) to the bottom (1), images in an atlas page only use a part of it
+    TexCoord = mix(iTextureRect.xy, iTextureRect.zw, vec2(iCorner.x, 1.0 - iCorner.y));
+
+    gl_Position = projection * vec4(iRect.xy + iCorner * iRect.zw, iLocation.z, 1.0);
+}
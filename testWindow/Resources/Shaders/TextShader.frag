@@ -1,14 +1,15 @@
 #version 330 core
 
 uniform sampler2D text;
-uniform vec4 textColor;
 
 in vec2 TexCoord;
+flat in vec4 TextColor;
 
 out vec4 fragColor;
 
 void main()
 {
-    vec4 sampled = vec4(1.0, 1.0, 1.0, texture(text, TexCoord).r);
-    fragColor = textColor * sampled;
-}
+    // TexCoord is in atlas pixels, the atlas may have grown since the glyph was queued
+    vec4 sampled = vec4(1.0, 1.0, 1.0, texture(text, TexCoord / vec2(textureSize(text, 0))).r);
+    fragColor = TextColor * sampled;
+}
\ No newline at end of file
@@ -3,13 +3,23 @@
 
 uniform mat4 projection;
 
-layout(location = 0) in vec3 iPosition;
-layout(location = 1) in vec2 iTexCoord;
+// Per vertex: corner of the unit quad (0..1)
+layout(location = 0) in vec2 iCorner;
+
+// Per instance (see GlyphInstance)
+layout(location = 1) in vec4 iRect;      // left, bottom, width, height
+layout(location = 2) in vec4 iAtlasRect; // left, top, width, height of the glyph in the atlas in pixels
+layout(location = 3) in vec4 iColor;
+layout(location = 4) in float iZ;
 
 out vec2 TexCoord;
+flat out vec4 TextColor;
 
 void main()
 {
-    gl_Position = projection * vec4(iPosition, 1.0);
-    TexCoord = iTexCoord;
-}
+    gl_Position = projection * vec4(iRect.xy + iCorner * iRect.zw, iZ, 1.0);
+
+    // atlas rows run from the top of the glyph (0) to the bottom
+    TexCoord = iAtlasRect.xy + vec2(iCorner.x, 1.0 - iCorner.y) * iAtlasRect.zw;
+    TextColor = iColor;
+}
\ No newline at end of file